@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocations made through global operator new since startup. The
+// benchmark binary replaces operator new in allocation_counter.cpp to count
+// them; it lives in its own translation unit so the replacement is never
+// inlined into callers.
+uint64_t allocationCount();
@@ -0,0 +1,111 @@
+#include "generators.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+
+namespace {
+
+constexpr float kSpacing = 10.0f;
+
+// Turns positions and index pairs into the editor vectors
+GeneratedGraph finish(const std::vector<Vec2>& positions,
+                      const std::vector<std::pair<int, int>>& pairs,
+                      std::mt19937& rng) {
+    GeneratedGraph graph;
+    for (const auto& p : positions) {
+        if (rng() % 10 == 0) graph.destinationNodes.push_back(Node{p, true});
+        else graph.roadNodes.push_back(Node{p, false});
+    }
+    graph.edges.reserve(pairs.size());
+    for (const auto& pair : pairs) {
+        graph.edges.push_back(Edge{positions[pair.first], positions[pair.second]});
+    }
+    graph.destinationNodes.push_back(Node{Vec2{-1000.0f, -1000.0f}, true});
+    graph.isolatedDestination = static_cast<int>(graph.destinationNodes.size()) - 1;
+    return graph;
+}
+
+} // namespace
+
+GeneratedGraph makeGridGraph(int width, int height, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> jitter(-0.2f * kSpacing, 0.2f * kSpacing);
+    std::vector<Vec2> positions;
+    positions.reserve(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            positions.push_back(Vec2{x * kSpacing + jitter(rng), y * kSpacing + jitter(rng)});
+
+    std::vector<std::pair<int, int>> pairs;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int i = y * width + x;
+            if (x + 1 < width) pairs.emplace_back(i, i + 1);
+            if (y + 1 < height) pairs.emplace_back(i, i + width);
+        }
+    }
+    return finish(positions, pairs, rng);
+}
+
+GeneratedGraph makeRandomGeometricGraph(int nodeCount, float averageDegree, unsigned seed) {
+    std::mt19937 rng(seed);
+    const float side = std::sqrt(static_cast<float>(nodeCount)) * kSpacing;
+    const float radius = std::sqrt(averageDegree * side * side / (3.14159265f * nodeCount));
+    std::uniform_real_distribution<float> coordinate(0.0f, side);
+    std::vector<Vec2> positions(nodeCount);
+    for (auto& p : positions) p = Vec2{coordinate(rng), coordinate(rng)};
+
+    // Bucket points into radius sized cells so only neighbouring cells are compared
+    const int cells = std::max(1, static_cast<int>(side / radius));
+    auto cellOf = [&](float v) { return std::min(cells - 1, static_cast<int>(v / side * cells)); };
+    std::vector<std::vector<int>> buckets(static_cast<size_t>(cells) * cells);
+    for (int i = 0; i < nodeCount; ++i)
+        buckets[cellOf(positions[i].y) * cells + cellOf(positions[i].x)].push_back(i);
+
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < nodeCount; ++i) {
+        int cx = cellOf(positions[i].x), cy = cellOf(positions[i].y);
+        for (int y = std::max(0, cy - 1); y <= std::min(cells - 1, cy + 1); ++y) {
+            for (int x = std::max(0, cx - 1); x <= std::min(cells - 1, cx + 1); ++x) {
+                for (int j : buckets[y * cells + x]) {
+                    if (j > i && euclidean(positions[i], positions[j]) <= radius) pairs.emplace_back(i, j);
+                }
+            }
+        }
+    }
+    return finish(positions, pairs, rng);
+}
+
+GeneratedGraph makeRoadNetwork(int nodeCount, unsigned seed) {
+    std::mt19937 rng(seed);
+    const int width = std::max(2, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(nodeCount)))));
+    const int height = std::max(2, (nodeCount + width - 1) / width);
+    std::uniform_real_distribution<float> jitter(-0.35f * kSpacing, 0.35f * kSpacing);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+    std::vector<Vec2> positions;
+    positions.reserve(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            positions.push_back(Vec2{x * kSpacing + jitter(rng), y * kSpacing + jitter(rng)});
+
+    std::vector<std::pair<int, int>> pairs;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int a = y * width + x;
+            if (x + 1 < width && chance(rng) < 0.85f) pairs.emplace_back(a, a + 1);
+            if (y + 1 < height && chance(rng) < 0.85f) pairs.emplace_back(a, a + width);
+            if (x + 1 < width && y + 1 < height && chance(rng) < 0.35f) {
+                int b = a + 1, c = a + width, d = a + width + 1;
+                // The shorter diagonal is the Delaunay edge of the cell
+                if (euclidean(positions[a], positions[d]) < euclidean(positions[b], positions[c]))
+                    pairs.emplace_back(a, d);
+                else
+                    pairs.emplace_back(b, c);
+            }
+        }
+    }
+    return finish(positions, pairs, rng);
+}
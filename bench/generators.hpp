@@ -0,0 +1,27 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <vector>
+
+// Synthetic graphs in the editor model for benchmarking. Roughly one node in
+// ten is a destination. Every generator also appends one isolated
+// destination (id isolatedDestination in the built graph) so unreachable
+// queries can be measured.
+struct GeneratedGraph {
+    std::vector<Node> destinationNodes;
+    std::vector<Node> roadNodes;
+    std::vector<Edge> edges;
+    int isolatedDestination = -1;
+};
+
+// width x height lattice with 4-neighbour edges and slightly jittered positions
+GeneratedGraph makeGridGraph(int width, int height, unsigned seed = 1);
+
+// nodeCount points uniform in a square, joined when closer than the radius
+// that gives the requested average degree
+GeneratedGraph makeRandomGeometricGraph(int nodeCount, float averageDegree = 6.0f, unsigned seed = 1);
+
+// Planar road-like network: a jittered lattice triangulated along the
+// shorter diagonal of each cell (close to its Delaunay triangulation), then
+// thinned by dropping a share of the diagonals and lattice edges.
+GeneratedGraph makeRoadNetwork(int nodeCount, unsigned seed = 1);
@@ -0,0 +1,785 @@
+// Google Benchmark suite for the path finding core.
+//
+// Every benchmark takes (graph kind, node count) arguments; kind 0 is a grid,
+// 1 a random geometric graph and 2 a planar road-like network (see
+// generators.hpp). Results are written to pathfinder_bench.json unless
+// --benchmark_out is given.
+//
+// Query and build benchmarks report heap allocations per query as the
+// "allocs" counter (see allocation_counter.hpp).
+
+#include "allocation_counter.hpp"
+#include "generators.hpp"
+#include "pathfinder/alt.hpp"
+#include "pathfinder/alternatives.hpp"
+#include "pathfinder/arc_flags.hpp"
+#include "pathfinder/batch.hpp"
+#include "pathfinder/cch.hpp"
+#include "pathfinder/delta_stepping.hpp"
+#include "pathfinder/graph.hpp"
+#include "pathfinder/hub_labels.hpp"
+#include "pathfinder/k_shortest.hpp"
+#include "pathfinder/matrix.hpp"
+#include "pathfinder/overlay.hpp"
+#include "pathfinder/reorder.hpp"
+#include "pathfinder/storage.hpp"
+#include "pathfinder/time_dependent.hpp"
+#include "pathfinder/turns.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// Heap allocations made since construction, reported per query
+class AllocationCount {
+public:
+    void report(benchmark::State& state, double queriesPerIteration = 1) const {
+        double allocations = static_cast<double>(allocationCount() - start);
+        state.counters["allocs"] = benchmark::Counter(allocations / queriesPerIteration,
+                                                      benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    uint64_t start = allocationCount();
+};
+
+const char* kKindNames[] = {"grid", "geometric", "road"};
+
+struct Fixture {
+    GeneratedGraph generated;
+    Graph graph;
+    std::vector<std::pair<int, int>> nearPairs; // target about 32 settled nodes away
+    std::vector<std::pair<int, int>> farPairs;  // target is the farthest reachable node
+    std::vector<std::pair<int, int>> randomPairs;
+};
+
+GeneratedGraph generate(int kind, int size) {
+    switch (kind) {
+        case 0: {
+            int side = static_cast<int>(std::sqrt(static_cast<double>(size)));
+            return makeGridGraph(side, side);
+        }
+        case 1: return makeRandomGeometricGraph(size);
+        default: return makeRoadNetwork(size);
+    }
+}
+
+// Graphs and query sets are generated once per (kind, size) and shared
+const Fixture& fixture(int kind, int size) {
+    static std::map<std::pair<int, int>, std::unique_ptr<Fixture>> cache;
+    auto& slot = cache[{kind, size}];
+    if (slot) return *slot;
+
+    slot = std::make_unique<Fixture>();
+    Fixture& f = *slot;
+    f.generated = generate(kind, size);
+    f.graph = buildGraph(f.generated.destinationNodes, f.generated.roadNodes, f.generated.edges);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, f.graph.nodeCount() - 1);
+    SearchContext context;
+    while (f.nearPairs.size() < 64) {
+        int source = pick(rng);
+        shortestPathTree(f.graph, source, context);
+        std::vector<int> reached(context.touched.begin(), context.touched.end());
+        if (reached.size() < 64) continue; // small component
+        auto byDistance = [&](int a, int b) { return context.dist[a] < context.dist[b]; };
+        std::nth_element(reached.begin(), reached.begin() + 32, reached.end(), byDistance);
+        f.nearPairs.emplace_back(source, reached[32]);
+        f.farPairs.emplace_back(source, *std::max_element(reached.begin(), reached.end(), byDistance));
+    }
+    for (int i = 0; i < 1024; ++i) f.randomPairs.emplace_back(pick(rng), pick(rng));
+    return f;
+}
+
+void setLabel(benchmark::State& state, const Fixture& f) {
+    state.SetLabel(std::string(kKindNames[state.range(0)]) + " n=" + std::to_string(f.graph.nodeCount()));
+}
+
+void BM_BuildGraph(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    AllocationCount allocations;
+    for (auto _ : state) {
+        Graph graph = buildGraph(f.generated.destinationNodes, f.generated.roadNodes, f.generated.edges);
+        benchmark::DoNotOptimize(graph.firstEdge.data());
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(state.iterations() * f.graph.nodeCount());
+    setLabel(state, f);
+}
+
+// search(source, target, context) defaults to shortestPath on f.graph
+template <typename Search>
+void runPairs(benchmark::State& state, const Fixture& f, const std::vector<std::pair<int, int>>& pairs,
+              Search search) {
+    SearchContext context;
+    size_t i = 0;
+    long long settled = 0;
+    AllocationCount allocations;
+    for (auto _ : state) {
+        const auto& q = pairs[i++ % pairs.size()];
+        PathResult result = search(q.first, q.second, context);
+        settled += result.stats.settled;
+        benchmark::DoNotOptimize(result.distance);
+    }
+    allocations.report(state);
+    state.counters["settled"] = benchmark::Counter(static_cast<double>(settled), benchmark::Counter::kAvgIterations);
+    setLabel(state, f);
+}
+
+void runPairs(benchmark::State& state, const Fixture& f, const std::vector<std::pair<int, int>>& pairs) {
+    runPairs(state, f, pairs, [&f](int source, int target, SearchContext& context) {
+        return shortestPath(f.graph, source, target, context);
+    });
+}
+
+void BM_QueryNear(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.nearPairs);
+}
+
+void BM_QueryFar(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.farPairs);
+}
+
+// Static baseline for the other *QueryRandom benchmarks
+void BM_QueryRandom(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.randomPairs);
+}
+
+void BM_QueryUnreachable(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::vector<std::pair<int, int>> pairs;
+    for (const auto& q : f.nearPairs) pairs.emplace_back(q.first, f.generated.isolatedDestination);
+    runPairs(state, f, pairs);
+}
+
+// findShortestPath as the editor calls it, rebuilding the graph per query
+void BM_LegacyQueryNear(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    size_t i = 0;
+    AllocationCount allocations;
+    for (auto _ : state) {
+        const auto& q = f.nearPairs[i++ % f.nearPairs.size()];
+        auto path = findShortestPath(f.graph.positions[q.first], f.graph.positions[q.second],
+                                     f.generated.destinationNodes, f.generated.roadNodes, f.generated.edges);
+        benchmark::DoNotOptimize(path.data());
+    }
+    allocations.report(state);
+    setLabel(state, f);
+}
+
+void BM_BatchQueries(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    SearchContext context;
+    AllocationCount allocations;
+    for (auto _ : state) {
+        for (const auto& q : f.randomPairs) {
+            PathResult result = shortestPath(f.graph, q.first, q.second, context);
+            benchmark::DoNotOptimize(result.distance);
+        }
+    }
+    allocations.report(state, static_cast<double>(f.randomPairs.size()));
+    state.SetItemsProcessed(state.iterations() * f.randomPairs.size());
+    setLabel(state, f);
+}
+
+// BM_BatchQueries on a work-stealing pool; third argument: worker threads
+void BM_BatchQueriesParallel(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    ThreadPool pool(static_cast<unsigned>(state.range(2)));
+    BatchQueryRunner runner(f.graph, pool);
+    AllocationCount allocations;
+    for (auto _ : state) {
+        std::vector<PathResult> results = runner.run(f.randomPairs, false);
+        benchmark::DoNotOptimize(results.data());
+    }
+    allocations.report(state, static_cast<double>(f.randomPairs.size()));
+    state.SetItemsProcessed(state.iterations() * f.randomPairs.size());
+    setLabel(state, f);
+}
+
+// Random point-to-point queries after renumbering; third argument: NodeOrder.
+// arc_span is the mean id distance between neighbours, a proxy for the cache
+// lines a search touches.
+void BM_QueryOrdered(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    auto order = static_cast<NodeOrder>(state.range(2));
+    ReorderedGraph reordered = reorderGraph(f.graph, order);
+    std::vector<std::pair<int, int>> pairs;
+    for (const auto& q : f.randomPairs) pairs.emplace_back(reordered.toInternal[q.first], reordered.toInternal[q.second]);
+
+    SearchContext context;
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& q = pairs[i++ % pairs.size()];
+        PathResult result = shortestPath(reordered.graph, q.first, q.second, context);
+        benchmark::DoNotOptimize(result.distance);
+    }
+    state.counters["arc_span"] = meanArcSpan(reordered.graph);
+    state.SetLabel(std::string(kKindNames[state.range(0)]) + " n=" + std::to_string(f.graph.nodeCount()) + " " +
+                   nodeOrderName(order));
+}
+
+// 16 landmarks; third argument: LandmarkStrategy. Items are landmarks.
+void BM_BuildLandmarks(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    auto strategy = static_cast<LandmarkStrategy>(state.range(2));
+    ThreadPool pool;
+    LandmarkIndex index;
+    for (auto _ : state) {
+        index = buildLandmarkIndex(f.graph, 16, strategy, pool);
+        benchmark::DoNotOptimize(index.fromLandmark.data());
+    }
+    state.SetItemsProcessed(state.iterations() * index.count());
+    state.counters["index_MiB"] = index.memoryBytes() / (1024.0 * 1024.0);
+    state.SetLabel(std::string(kKindNames[state.range(0)]) + " n=" + std::to_string(f.graph.nodeCount()) + " " +
+                   (strategy == LandmarkStrategy::Avoid ? "avoid" : "farthest"));
+}
+
+// Landmark indexes are built once per (kind, size) and shared
+const LandmarkIndex& landmarkIndex(int kind, int size) {
+    static std::map<std::pair<int, int>, std::unique_ptr<LandmarkIndex>> cache;
+    auto& slot = cache[{kind, size}];
+    if (!slot) {
+        ThreadPool pool;
+        slot = std::make_unique<LandmarkIndex>(
+            buildLandmarkIndex(fixture(kind, size).graph, 16, LandmarkStrategy::Avoid, pool));
+    }
+    return *slot;
+}
+
+// 16 landmarks; compare with BM_QueryFar and the input order of
+// BM_QueryOrdered. "settled" shows how much of the search the bounds prune.
+void BM_AltQueryFar(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const LandmarkIndex& index = landmarkIndex(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext& context) {
+        return altShortestPath(f.graph, index, source, target, context);
+    });
+}
+
+void BM_AltQueryRandom(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const LandmarkIndex& index = landmarkIndex(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.randomPairs, [&](int source, int target, SearchContext& context) {
+        return altShortestPath(f.graph, index, source, target, context);
+    });
+}
+
+void BM_BuildHubLabels(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    HubLabels labels;
+    for (auto _ : state) {
+        labels = buildHubLabels(f.graph);
+        benchmark::DoNotOptimize(labels.outLabels.data());
+    }
+    state.counters["label_size"] = labels.averageLabelSize();
+    state.counters["labels_MiB"] = labels.memoryBytes() / (1024.0 * 1024.0);
+    setLabel(state, f);
+}
+
+// Hub labels are built once per (kind, size) and shared
+const HubLabels& hubLabels(int kind, int size) {
+    static std::map<std::pair<int, int>, std::unique_ptr<HubLabels>> cache;
+    auto& slot = cache[{kind, size}];
+    if (!slot) slot = std::make_unique<HubLabels>(buildHubLabels(fixture(kind, size).graph));
+    return *slot;
+}
+
+// Distance only, over random pairs so labels come from memory rather than cache
+void BM_HubDistance(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const HubLabels& labels = hubLabels(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& q = f.randomPairs[i++ % f.randomPairs.size()];
+        benchmark::DoNotOptimize(hubDistance(labels, q.first, q.second));
+    }
+    state.counters["label_size"] = labels.averageLabelSize();
+    setLabel(state, f);
+}
+
+void BM_HubPath(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const HubLabels& labels = hubLabels(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.randomPairs,
+             [&](int source, int target, SearchContext&) { return hubShortestPath(labels, source, target); });
+}
+
+void BM_BuildCchTopology(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    CchTopology topology;
+    for (auto _ : state) {
+        topology = buildCchTopology(f.graph);
+        benchmark::DoNotOptimize(topology.upHead.data());
+    }
+    state.counters["arcs_per_node"] = static_cast<double>(topology.arcCount()) / f.graph.nodeCount();
+    setLabel(state, f);
+}
+
+// What a weight change costs; third argument: worker threads
+void BM_CustomizeCch(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    ThreadPool pool(static_cast<unsigned>(state.range(2)));
+    CchTopology topology = buildCchTopology(f.graph);
+    for (auto _ : state) {
+        CchMetric metric = customizeCch(topology, f.graph, pool);
+        benchmark::DoNotOptimize(metric.upward.data());
+    }
+    state.SetItemsProcessed(state.iterations() * topology.arcCount());
+    setLabel(state, f);
+}
+
+struct CustomizedCch {
+    CchTopology topology;
+    CchMetric metric;
+};
+
+// Hierarchies are built and customized once per (kind, size) and shared
+const CustomizedCch& customizedCch(int kind, int size) {
+    static std::map<std::pair<int, int>, std::unique_ptr<CustomizedCch>> cache;
+    auto& slot = cache[{kind, size}];
+    if (!slot) {
+        const Graph& graph = fixture(kind, size).graph;
+        ThreadPool pool;
+        slot = std::make_unique<CustomizedCch>();
+        slot->topology = buildCchTopology(graph);
+        slot->metric = customizeCch(slot->topology, graph, pool);
+    }
+    return *slot;
+}
+
+// "settled" counts elimination tree ancestors scanned
+void BM_CchQueryFar(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const CustomizedCch& cch = customizedCch(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    CchQueryContext cchContext;
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext&) {
+        return cchShortestPath(cch.topology, cch.metric, source, target, cchContext);
+    });
+}
+
+void BM_CchQueryRandom(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const CustomizedCch& cch = customizedCch(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    CchQueryContext cchContext;
+    runPairs(state, f, f.randomPairs, [&](int source, int target, SearchContext&) {
+        return cchShortestPath(cch.topology, cch.metric, source, target, cchContext);
+    });
+}
+
+void BM_BuildOverlay(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    ThreadPool pool;
+    OverlayGraph overlay;
+    for (auto _ : state) {
+        overlay = buildOverlay(f.graph, pool);
+        benchmark::DoNotOptimize(overlay.levels.data());
+    }
+    state.counters["overlay_MiB"] = overlay.memoryBytes() / (1024.0 * 1024.0);
+    setLabel(state, f);
+}
+
+// One edit: the arcs around a random node get longer, alternately by 50% and
+// back, and only the cells holding them are customized again. "cells" counts
+// them over all levels.
+void BM_UpdateOverlay(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    ThreadPool pool;
+    Graph graph = f.graph;
+    OverlayGraph overlay = buildOverlay(graph, pool);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> pick(0, graph.nodeCount() - 1);
+    long long cells = 0, edits = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        graph.weight = f.graph.weight;
+        if (edits++ % 2 == 0) {
+            int u = pick(rng);
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                graph.weight[e] *= 1.5f;
+                int v = graph.target[e];
+                for (int back = graph.firstEdge[v]; back < graph.firstEdge[v + 1]; ++back) {
+                    if (graph.target[back] == u) graph.weight[back] *= 1.5f;
+                }
+            }
+        }
+        state.ResumeTiming();
+        cells += updateOverlay(overlay, graph, pool);
+    }
+    state.counters["cells"] = benchmark::Counter(static_cast<double>(cells), benchmark::Counter::kAvgIterations);
+    setLabel(state, f);
+}
+
+// Overlays are built once per (kind, size) and shared
+const OverlayGraph& overlayGraph(int kind, int size) {
+    static std::map<std::pair<int, int>, std::unique_ptr<OverlayGraph>> cache;
+    auto& slot = cache[{kind, size}];
+    if (!slot) {
+        ThreadPool pool;
+        slot = std::make_unique<OverlayGraph>(buildOverlay(fixture(kind, size).graph, pool));
+    }
+    return *slot;
+}
+
+void BM_OverlayQueryFar(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const OverlayGraph& overlay = overlayGraph(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext& context) {
+        return overlayShortestPath(f.graph, overlay, source, target, context);
+    });
+}
+
+void BM_OverlayQueryRandom(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const OverlayGraph& overlay = overlayGraph(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.randomPairs, [&](int source, int target, SearchContext& context) {
+        return overlayShortestPath(f.graph, overlay, source, target, context);
+    });
+}
+
+// 32 regions; "flag_density" is the average number of regions an arc leads to
+void BM_BuildArcFlags(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    ThreadPool pool;
+    ArcFlags flags;
+    for (auto _ : state) {
+        flags = buildArcFlags(f.graph, 32, pool);
+        benchmark::DoNotOptimize(flags.flags.data());
+    }
+    long long bits = 0;
+    for (uint64_t arc : flags.flags) bits += static_cast<long long>(std::bitset<64>(arc).count());
+    state.counters["flag_density"] = static_cast<double>(bits) / std::max<size_t>(flags.flags.size(), 1);
+    state.counters["flags_MiB"] = flags.memoryBytes() / (1024.0 * 1024.0);
+    setLabel(state, f);
+}
+
+// Arc flags are built once per (kind, size) and shared
+const ArcFlags& arcFlags(int kind, int size) {
+    static std::map<std::pair<int, int>, std::unique_ptr<ArcFlags>> cache;
+    auto& slot = cache[{kind, size}];
+    if (!slot) {
+        ThreadPool pool;
+        slot = std::make_unique<ArcFlags>(buildArcFlags(fixture(kind, size).graph, 32, pool));
+    }
+    return *slot;
+}
+
+void BM_ArcFlagsQueryFar(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const ArcFlags& flags = arcFlags(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext& context) {
+        return arcFlagsShortestPath(f.graph, flags, source, target, context);
+    });
+}
+
+void BM_ArcFlagsQueryRandom(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const ArcFlags& flags = arcFlags(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.randomPairs, [&](int source, int target, SearchContext& context) {
+        return arcFlagsShortestPath(f.graph, flags, source, target, context);
+    });
+}
+
+// Landmark bounds and arc flags together; compare with BM_AltQueryFar
+void BM_AltArcFlagsQueryFar(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const LandmarkIndex& index = landmarkIndex(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const ArcFlags& flags = arcFlags(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext& context) {
+        return altShortestPath(f.graph, index, source, target, context, nullptr, &flags);
+    });
+}
+
+// Default weekday profiles, departing in the morning peak; compare with
+// BM_QueryFar and BM_QueryRandom for the cost of evaluating travel times
+const float kRushHour = 8 * 3600.0f;
+
+void BM_TimeDependentQueryFar(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    static const TravelTimeProfiles profiles = defaultTravelTimeProfiles();
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext& context) {
+        return timeDependentShortestPath(f.graph, profiles, source, target, kRushHour, context);
+    });
+}
+
+void BM_TimeDependentQueryRandom(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    static const TravelTimeProfiles profiles = defaultTravelTimeProfiles();
+    runPairs(state, f, f.randomPairs, [&](int source, int target, SearchContext& context) {
+        return timeDependentShortestPath(f.graph, profiles, source, target, kRushHour, context);
+    });
+}
+
+// Every fourth arc with its own profile, its class's scaled by one of four
+// amounts; compare with BM_TimeDependentQueryRandom for the per-arc lookup
+void BM_TimeDependentArcProfilesQueryRandom(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    static std::map<std::pair<int, int>, std::unique_ptr<TravelTimeProfiles>> cache;
+    auto& profiles = cache[{static_cast<int>(state.range(0)), static_cast<int>(state.range(1))}];
+    if (!profiles) {
+        profiles = std::make_unique<TravelTimeProfiles>(defaultTravelTimeProfiles());
+        const int count = profiles->breakpointCount();
+        std::vector<ArcProfile> arcs;
+        for (int u = 0; u < f.graph.nodeCount(); ++u) {
+            for (int e = f.graph.firstEdge[u]; e < f.graph.firstEdge[u + 1]; ++e) {
+                if (e % 4 != 0) continue;
+                ArcProfile arc{u, f.graph.target[e], {}};
+                const int row = profiles->profileOf(f.graph, e);
+                for (int i = 0; i < count; ++i)
+                    arc.factors.push_back((1.1f + 0.1f * (e / 4 % 4)) * profiles->factors[row * count + i]);
+                arcs.push_back(std::move(arc));
+            }
+        }
+        setArcProfiles(*profiles, f.graph, arcs);
+    }
+    runPairs(state, f, f.randomPairs, [&](int source, int target, SearchContext& context) {
+        return timeDependentShortestPath(f.graph, *profiles, source, target, kRushHour, context);
+    });
+}
+
+// 16 landmarks on the free-flow lower bounds; compare with BM_AltQueryFar
+void BM_TimeDependentAltQueryFar(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    static const TravelTimeProfiles profiles = defaultTravelTimeProfiles();
+    static std::map<std::pair<int, int>, std::unique_ptr<LandmarkIndex>> cache;
+    auto& index = cache[{static_cast<int>(state.range(0)), static_cast<int>(state.range(1))}];
+    if (!index) {
+        ThreadPool pool;
+        index = std::make_unique<LandmarkIndex>(
+            buildLandmarkIndex(lowerBoundGraph(f.graph, profiles), 16, LandmarkStrategy::Avoid, pool));
+    }
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext& context) {
+        return timeDependentShortestPath(f.graph, profiles, source, target, kRushHour, context, index.get());
+    });
+}
+
+// Up to three routes from one bidirectional search; compare with
+// BM_QueryFar. routes is the average number found.
+void BM_AlternativesFar(benchmark::State& state) {
+    const int kind = static_cast<int>(state.range(0)), size = static_cast<int>(state.range(1));
+    const Fixture& f = fixture(kind, size);
+    static std::map<std::pair<int, int>, std::unique_ptr<Graph>> cache;
+    auto& reversed = cache[{kind, size}];
+    if (!reversed) reversed = std::make_unique<Graph>(reverseGraph(f.graph));
+    AlternativeSearch search;
+    long long routes = 0;
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext&) {
+        std::vector<PathResult> found = alternativeRoutes(f.graph, *reversed, source, target, search);
+        routes += static_cast<long long>(found.size());
+        return found.empty() ? PathResult() : std::move(found[0]);
+    });
+    state.counters["routes"] = benchmark::Counter(static_cast<double>(routes), benchmark::Counter::kAvgIterations);
+}
+
+// Third argument: K. Spurs run on a pool of hardware concurrency; settled
+// counts every search of a query, the tree towards the target included.
+void BM_KShortestPaths(benchmark::State& state) {
+    const int kind = static_cast<int>(state.range(0)), size = static_cast<int>(state.range(1));
+    const Fixture& f = fixture(kind, size);
+    static std::map<std::pair<int, int>, std::unique_ptr<Graph>> cache;
+    auto& reversed = cache[{kind, size}];
+    if (!reversed) reversed = std::make_unique<Graph>(reverseGraph(f.graph));
+    ThreadPool pool;
+    KShortestSearch search;
+    long long paths = 0;
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext&) {
+        std::vector<PathResult> found =
+            kShortestPaths(f.graph, *reversed, source, target, static_cast<int>(state.range(2)), search, pool);
+        paths += static_cast<long long>(found.size());
+        return found.empty() ? PathResult() : std::move(found[0]);
+    });
+    state.counters["paths"] = benchmark::Counter(static_cast<double>(paths), benchmark::Counter::kAvgIterations);
+}
+
+// Third argument: 0 searches arcs with no turn data, 1 forbids U-turns and
+// one turn in twenty. Compare with BM_QueryFar for the edge-based penalty;
+// turn_kb is the turn store next to the graph's own arrays.
+void BM_TurnQueryFar(benchmark::State& state) {
+    const int kind = static_cast<int>(state.range(0)), size = static_cast<int>(state.range(1));
+    const Fixture& f = fixture(kind, size);
+    static std::map<std::tuple<int, int, int>, std::unique_ptr<TurnCosts>> cache;
+    auto& costs = cache[{kind, size, static_cast<int>(state.range(2))}];
+    if (!costs) {
+        std::vector<Turn> turns;
+        if (state.range(2) == 1) {
+            std::mt19937 rng(7);
+            std::bernoulli_distribution forbid(0.05);
+            for (int via = 0; via < f.graph.nodeCount(); ++via) {
+                for (int in = f.graph.firstEdge[via]; in < f.graph.firstEdge[via + 1]; ++in) {
+                    for (int out = f.graph.firstEdge[via]; out < f.graph.firstEdge[via + 1]; ++out) {
+                        if (in == out || !forbid(rng)) continue;
+                        turns.push_back(Turn{f.graph.positions[f.graph.target[in]], f.graph.positions[via],
+                                             f.graph.positions[f.graph.target[out]]});
+                    }
+                }
+            }
+        }
+        costs = std::make_unique<TurnCosts>(buildTurnCosts(f.graph, turns, state.range(2) == 1 ? kInfinity : 0.0f));
+    }
+    runPairs(state, f, f.farPairs, [&](int source, int target, SearchContext& context) {
+        return turnAwareShortestPath(f.graph, *costs, source, target, context);
+    });
+    state.counters["turn_kb"] = static_cast<double>(costs->memoryBytes()) / 1024;
+}
+
+// Sequential one-to-all baseline for BM_DeltaStepping
+void BM_ShortestPathTree(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    SearchContext context;
+    size_t i = 0;
+    for (auto _ : state) {
+        shortestPathTree(f.graph, f.nearPairs[i++ % f.nearPairs.size()].first, context);
+        benchmark::DoNotOptimize(context.dist.data());
+    }
+    state.SetItemsProcessed(state.iterations() * f.graph.nodeCount());
+    setLabel(state, f);
+}
+
+// Third argument: worker threads
+void BM_DeltaStepping(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    ThreadPool pool(static_cast<unsigned>(state.range(2)));
+    DeltaSteppingIndex index = buildDeltaSteppingIndex(f.graph);
+    DeltaSteppingResult result;
+    size_t i = 0;
+    for (auto _ : state) {
+        deltaSteppingTree(f.graph, index, f.nearPairs[i++ % f.nearPairs.size()].first, pool, result);
+        benchmark::DoNotOptimize(result.dist.data());
+    }
+    state.SetItemsProcessed(state.iterations() * f.graph.nodeCount());
+    setLabel(state, f);
+}
+
+void BM_DistanceMatrix(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::vector<int> ids;
+    for (int i = 0; i < std::min(64, f.graph.destinationCount); ++i) ids.push_back(i);
+    for (auto _ : state) {
+        DistanceMatrix matrix = computeDistanceMatrix(f.graph, ids, ids, 1);
+        benchmark::DoNotOptimize(matrix.values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * ids.size() * ids.size());
+    setLabel(state, f);
+}
+
+std::string tempJsonPath() {
+    return (std::filesystem::temp_directory_path() / "pathfinder_bench_nodes.json").string();
+}
+
+void BM_SaveNodesJson(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::string path = tempJsonPath();
+    for (auto _ : state) {
+        saveToFile(f.generated.destinationNodes, f.generated.roadNodes, f.generated.edges, path);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+    setLabel(state, f);
+}
+
+void BM_LoadNodesJson(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::string path = tempJsonPath();
+    saveToFile(f.generated.destinationNodes, f.generated.roadNodes, f.generated.edges, path);
+    for (auto _ : state) {
+        std::vector<Node> destinationNodes, roadNodes;
+        std::vector<Edge> edges;
+        loadFromFile(destinationNodes, roadNodes, edges, path);
+        benchmark::DoNotOptimize(edges.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+    setLabel(state, f);
+}
+
+const std::vector<int64_t> kKinds = {0, 1, 2};
+const std::vector<int64_t> kSizes = {1 << 10, 1 << 14, 1 << 17};
+const std::vector<int64_t> kSmallSizes = {1 << 10, 1 << 14};
+const std::vector<int64_t> kLargeSizes = {1 << 17, 1 << 20};
+const std::vector<int64_t> kThreadCounts = {1, 2, 4, 8, 16, 32, 64};
+const std::vector<int64_t> kOrders = {static_cast<int64_t>(NodeOrder::Input), static_cast<int64_t>(NodeOrder::Hilbert),
+                                      static_cast<int64_t>(NodeOrder::Bfs), static_cast<int64_t>(NodeOrder::Rcm)};
+const std::vector<int64_t> kTurnModes = {0, 1};
+const std::vector<int64_t> kPathCounts = {10, 100};
+const std::vector<int64_t> kLandmarkStrategies = {static_cast<int64_t>(LandmarkStrategy::Farthest),
+                                                  static_cast<int64_t>(LandmarkStrategy::Avoid)};
+
+} // namespace
+
+BENCHMARK(BM_BuildGraph)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_QueryNear)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_QueryFar)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_QueryRandom)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_QueryUnreachable)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LegacyQueryNear)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BatchQueries)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BatchQueriesParallel)->ArgsProduct({kKinds, kSmallSizes, kThreadCounts})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_QueryOrdered)->ArgsProduct({kKinds, kLargeSizes, kOrders})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildLandmarks)->ArgsProduct({kKinds, kSizes, kLandmarkStrategies})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AltQueryFar)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AltQueryRandom)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildHubLabels)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HubDistance)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_HubPath)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildCchTopology)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CustomizeCch)->ArgsProduct({kKinds, kSizes, kThreadCounts})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CchQueryFar)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CchQueryRandom)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildOverlay)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UpdateOverlay)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OverlayQueryFar)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_OverlayQueryRandom)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildArcFlags)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ArcFlagsQueryFar)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ArcFlagsQueryRandom)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AltArcFlagsQueryFar)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TimeDependentQueryFar)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TimeDependentQueryRandom)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TimeDependentArcProfilesQueryRandom)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TimeDependentAltQueryFar)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TurnQueryFar)->ArgsProduct({kKinds, kSizes, kTurnModes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AlternativesFar)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_KShortestPaths)->ArgsProduct({kKinds, kSizes, kPathCounts})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ShortestPathTree)->ArgsProduct({kKinds, kLargeSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DeltaStepping)->ArgsProduct({kKinds, kLargeSizes, kThreadCounts})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_DistanceMatrix)->ArgsProduct({kKinds, kSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SaveNodesJson)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadNodesJson)->ArgsProduct({kKinds, kSmallSizes})->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) {
+    // Default to a JSON results file so runs can be tracked over time
+    std::vector<char*> args(argv, argv + argc);
+    std::string outArg = "--benchmark_out=pathfinder_bench.json";
+    std::string formatArg = "--benchmark_out_format=json";
+    bool hasOut = std::any_of(args.begin() + 1, args.end(), [](const char* a) {
+        return std::string(a).rfind("--benchmark_out=", 0) == 0;
+    });
+    if (!hasOut) {
+        args.push_back(outArg.data());
+        args.push_back(formatArg.data());
+    }
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+struct ArcFlags;
+
+// ALT: A* search with landmark lower bounds. For every node v and landmark L
+// the index stores d(L, v) and d(v, L); by the triangle inequality
+//   d(v, t) >= max(d(L, t) - d(L, v), d(v, L) - d(t, L))
+// which, maximised over a few landmarks, steers the search towards the
+// target far better than straight-line distance when roads detour.
+
+enum class LandmarkStrategy {
+    Farthest, // each new landmark is the node farthest from those chosen so far
+    Avoid     // grows a tree from a random root and descends into the branch
+              // the current landmarks bound worst (Goldberg and Werneck)
+};
+
+// "farthest" or "avoid"
+bool parseLandmarkStrategy(const std::string& text, LandmarkStrategy& strategy);
+
+struct LandmarkIndex {
+    std::vector<int> landmarks;
+    // Node-major, so one node's bounds share a cache line:
+    // fromLandmark[v * count() + i] = d(landmarks[i], v), kInfinity if unreachable
+    std::vector<float> fromLandmark;
+    std::vector<float> toLandmark; // d(v, landmarks[i]), same layout
+
+    int count() const { return static_cast<int>(landmarks.size()); }
+    size_t memoryBytes() const { return (fromLandmark.size() + toLandmark.size()) * sizeof(float); }
+};
+
+// Landmarks searched per query: the ones giving the best bound between the
+// query's endpoints
+constexpr int kActiveLandmarks = 4;
+constexpr int kMaxLandmarks = 64;
+
+// Picks up to count landmarks (at most kMaxLandmarks; seeded, so
+// deterministic) and computes their distances with 2 * count one-to-all
+// searches spread over the pool. cancel is checked between those searches;
+// once it is true the build stops and returns an index without landmarks.
+LandmarkIndex buildLandmarkIndex(const Graph& graph, int count, LandmarkStrategy strategy, ThreadPool& pool,
+                                 unsigned seed = 1, const std::atomic<bool>* cancel = nullptr);
+
+// Recomputes the distances of the existing landmarks after an edit that kept
+// node ids. Bounds from the old distances stay valid, just looser, while
+// weights only increase (including removed edges), so this can be deferred
+// until then; new edges, shorter weights and renumbered nodes need it before
+// the next query. Returns false, leaving index as it was, when stopped
+// through cancel as for buildLandmarkIndex.
+bool updateLandmarkDistances(const Graph& graph, LandmarkIndex& index, ThreadPool& pool,
+                             const std::atomic<bool>* cancel = nullptr);
+
+// Lower bound on d(v, target) for A*, from the kActiveLandmarks landmarks
+// that bound source -> target best
+class LandmarkPotential {
+public:
+    LandmarkPotential(const LandmarkIndex& index, int source, int target);
+
+    float operator()(int v) const {
+        float best = 0;
+        for (int j = 0; j < activeCount_; ++j) best = std::max(best, boundVia(active_[j], v));
+        return best;
+    }
+
+private:
+    // Bound through landmark i; terms with an unreachable side say nothing
+    float boundVia(int i, int v) const {
+        float best = 0;
+        float lt = from_[static_cast<size_t>(target_) * k_ + i], lv = from_[static_cast<size_t>(v) * k_ + i];
+        if (lt != kInfinity && lv != kInfinity) best = std::max(best, lt - lv);
+        float vl = to_[static_cast<size_t>(v) * k_ + i], tl = to_[static_cast<size_t>(target_) * k_ + i];
+        if (vl != kInfinity && tl != kInfinity) best = std::max(best, vl - tl);
+        return best;
+    }
+
+    const float* from_;
+    const float* to_;
+    int k_;
+    int target_;
+    int active_[kActiveLandmarks];
+    int activeCount_ = 0;
+};
+
+// Point-to-point A* with landmark bounds. index must belong to graph (same
+// node ids). With control, cancellation and progress behave as for
+// shortestPath. With flags (see arc_flags.hpp), only arcs flagged for
+// target's region are relaxed.
+PathResult altShortestPath(const Graph& graph, const LandmarkIndex& index, int source, int target,
+                           SearchContext& context, const SearchControl* control = nullptr,
+                           const ArcFlags* flags = nullptr);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <cstdint>
+#include <vector>
+
+// Alternative routes by the plateau method. One bidirectional Dijkstra grows
+// a forward tree from the source and a backward tree from the target, each
+// past the meeting point up to the stretch bound. Wherever the two trees run
+// along the same arcs they form a plateau, and the route through a plateau
+// (source to its start in the forward tree, along it, then on to the target
+// in the backward tree) is a candidate that is a shortest path over the
+// whole plateau. Candidates are taken from the trees, so no search runs
+// beyond the first one.
+//
+// A route is admissible when
+//   - its cost is at most maxStretch times the shortest (bounded stretch),
+//   - it shares at most maxSharing of the shortest cost with the routes
+//     ranked above it (limited sharing),
+//   - its plateau covers at least minPlateau of the shortest cost, so
+//     detours up to that length are themselves shortest paths (local
+//     optimality, approximated by the plateau rather than tested), and
+//   - it visits no node twice.
+
+struct AlternativeOptions {
+    int maxRoutes = 3;          // including the shortest
+    float maxStretch = 1.25f;
+    float maxSharing = 0.8f;
+    float minPlateau = 0.2f;
+};
+
+// Scratch state for both searches and the ranking, reused between queries
+// like SearchContext
+struct AlternativeSearch {
+    // A maximal run of arcs both trees share, from start to end in the
+    // forward direction; every node on it has the same cost through it
+    struct Plateau {
+        int start;
+        int end;
+        float cost;
+    };
+
+    SearchContext forward;
+    SearchContext backward;
+    std::vector<int> forwardOrder; // nodes in the order the forward search settled them
+    std::vector<int> plateau;      // node -> index into plateaus while ranking, else -1
+    std::vector<Plateau> plateaus;
+    std::vector<int> path;         // route being checked, and its arc costs
+    std::vector<float> legs;
+    std::vector<uint64_t> taken;   // arcs of the routes accepted so far, sorted
+    std::vector<int> visited;      // path, sorted to find repeated nodes
+};
+
+// Shortest route first, then admissible alternatives ranked by cost minus
+// plateau length; empty if target is unreachable. reversed is
+// reverseGraph(graph). Every route carries the stats of the whole search.
+// With control, both sides of the search check it as shortestPath does,
+// progress seeing the forward side; once cancelled the result is a single
+// route with cancelled set and no path.
+std::vector<PathResult> alternativeRoutes(const Graph& graph, const Graph& reversed, int source, int target,
+                                          AlternativeSearch& search, const AlternativeOptions& options = {},
+                                          const SearchControl* control = nullptr);
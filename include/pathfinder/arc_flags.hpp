@@ -0,0 +1,42 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/thread_pool.hpp"
+#include <cstdint>
+#include <vector>
+
+// Arc flags: the map is split into regions, and every arc carries one bit
+// per region telling whether it starts a shortest path into that region. A
+// query towards a node of region r only relaxes arcs with bit r set, so it
+// stays on the corridor leading there and leaves side roads unexplored.
+//
+// An arc gets bit r when it lies inside r or on the shortest path tree
+// towards one of r's boundary nodes (nodes of r entered by an arc from
+// outside). The trees come from one backward search per boundary node.
+// Flags hold for the weights they were built with; after an edit they
+// need rebuilding.
+
+constexpr int kMaxRegions = 64;
+
+struct ArcFlags {
+    std::vector<int> region;     // node -> region
+    std::vector<uint64_t> flags; // arc -> bit r set when the arc may lead into region r
+    int regionCount = 0;
+    uint64_t fingerprint = 0;    // topologyFingerprint of the graph they were built on
+
+    bool allows(int arc, int targetRegion) const { return (flags[arc] >> targetRegion) & 1; }
+    size_t memoryBytes() const { return region.size() * sizeof(int) + flags.size() * sizeof(uint64_t); }
+};
+
+// Node -> region for regionCount (1 to kMaxRegions) k-d cells of similar
+// node count: each split is at the median of the longer side of the
+// bounding box, with the regions dealt out in proportion to the halves
+std::vector<int> kdRegions(const Graph& graph, int regionCount);
+
+// Regions from kdRegions; the backward searches are spread over the pool
+ArcFlags buildArcFlags(const Graph& graph, int regionCount, ThreadPool& pool);
+
+// Point-to-point Dijkstra relaxing only arcs flagged for target's region.
+// flags must belong to graph.
+PathResult arcFlagsShortestPath(const Graph& graph, const ArcFlags& flags, int source, int target,
+                                SearchContext& context);
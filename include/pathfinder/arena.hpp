@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator for temporaries that all die together, such as the maps of
+// one search or the scratch arrays of one graph build. Use it through
+// std::pmr containers. Deallocation is a no-op; reset() makes everything
+// reusable at once. Blocks are kept across resets, and if a round needed
+// more than one block they are merged into one that fits it, so repeated
+// rounds of similar size stop allocating entirely. Not thread-safe; keep one
+// per thread.
+class Arena : public std::pmr::memory_resource {
+public:
+    explicit Arena(size_t initialBytes = 64 * 1024);
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Invalidates everything allocated since the last reset
+    void reset();
+
+    size_t bytesUsed() const { return used + static_cast<size_t>(cursor - blockStart); }
+    size_t capacity() const;
+    size_t upstreamAllocations() const { return blocksAllocated; } // blocks taken from operator new so far
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    void addBlock(size_t size);
+
+    std::vector<Block> blocks;
+    size_t used = 0; // bytes in the blocks before the current one
+    char* blockStart = nullptr;
+    char* cursor = nullptr;
+    char* end = nullptr;
+    size_t blocksAllocated = 0;
+};
+
+// Resets an arena when the scope ends
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : arena(arena) {}
+    ~ArenaScope() { arena.reset(); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& arena;
+};
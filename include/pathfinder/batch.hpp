@@ -0,0 +1,30 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/thread_pool.hpp"
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Answers one query using the given scratch context
+using QueryEngine = std::function<PathResult(int source, int target, SearchContext& context)>;
+
+// Answers many independent point-to-point queries over one read-only graph.
+// Queries are cut into small slices that the pool's workers take and steal;
+// each worker keeps its own SearchContext across slices and calls.
+class BatchQueryRunner {
+public:
+    // Without an engine, queries run shortestPath on graph
+    BatchQueryRunner(const Graph& graph, ThreadPool& pool, QueryEngine engine = nullptr);
+
+    // results[i] answers queries[i] (source, target). Without wantPaths only
+    // distances and stats are filled in. Ids must be valid node ids. Not to
+    // be called from a worker of the same pool.
+    std::vector<PathResult> run(const std::vector<std::pair<int, int>>& queries, bool wantPaths = true);
+
+private:
+    const Graph& graph;
+    ThreadPool& pool;
+    QueryEngine engine;
+    std::vector<SearchContext> contexts; // one per pool worker
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/thread_pool.hpp"
+#include <vector>
+
+// Customizable contraction hierarchy (Dibbelt, Strasser and Wagner). The
+// preprocessing only looks at the topology: nodes are ordered by nested
+// dissection over their positions and contracted in that order without
+// witness searches, so the shortcuts are right for any weights.
+// Customization then fills in the shortcut weights for one set of arc
+// weights, bottom-up over lower triangles; it is the only step to repeat
+// when weights change.
+
+struct CchTopology {
+    std::vector<int> order; // rank -> node, in contraction order
+    std::vector<int> rank;  // node -> rank
+
+    // Arcs between ranks, stored once from the lower end: those of rank r are
+    // [upFirst[r], upFirst[r + 1]), sorted by upHead
+    std::vector<int> upFirst, upHead, upTail;
+    // Arcs whose higher end is rank r, for enumerating lower triangles
+    std::vector<int> downFirst, downArc;
+    // Elimination tree: the lowest rank above r that r has an arc to, -1 at
+    // roots. Every arc leads from a rank to one of its ancestors.
+    std::vector<int> parent;
+    // Ranks grouped so that each group only reads arcs of earlier groups
+    std::vector<int> levelFirst, byLevel;
+
+    // Input arc e -> 2 * arc, plus 1 when it runs from the higher rank to the
+    // lower; -1 for self loops
+    std::vector<int> inputArc;
+    uint64_t fingerprint = 0; // topologyFingerprint of the graph it was built on
+
+    int nodeCount() const { return static_cast<int>(order.size()); }
+    int arcCount() const { return static_cast<int>(upHead.size()); }
+};
+
+// Weights of the topology's arcs in both directions
+struct CchMetric {
+    std::vector<float> upward;   // lower rank -> higher rank
+    std::vector<float> downward; // higher rank -> lower rank
+};
+
+// Nodes in contraction order: each half of a median split over positions is
+// ordered first, then the nodes separating them. Splits along both axes and
+// both diagonals are tried and the one with the smallest separator is kept.
+std::vector<int> nestedDissectionOrder(const Graph& graph);
+
+CchTopology buildCchTopology(const Graph& graph);
+
+// Whether graph has the arcs topology was built from, whatever their weights
+bool sameTopology(const CchTopology& topology, const Graph& graph);
+
+// Shortcut weights for graph's arc weights; graph must have the same
+// topology. Ranks of one level are spread over the pool.
+CchMetric customizeCch(const CchTopology& topology, const Graph& graph, ThreadPool& pool);
+
+// Scratch state for cchShortestPath, reused between queries
+struct CchQueryContext {
+    std::vector<float> forward, backward; // by rank
+    std::vector<int> forwardArc, backwardArc;
+
+    void prepare(int nodeCount);
+};
+
+// Point-to-point query: scans the elimination tree ancestors of source with
+// upward weights and those of target with downward weights, then unpacks the
+// shortcuts on the best meeting point. stats.settled counts ancestors
+// scanned, stats.relaxed arcs.
+PathResult cchShortestPath(const CchTopology& topology, const CchMetric& metric, int source, int target,
+                           CchQueryContext& context);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/thread_pool.hpp"
+#include <vector>
+
+// Parallel one-to-all shortest paths by delta-stepping (Meyer & Sanders).
+//
+// Tentative distances are kept in buckets of width delta. All nodes of the
+// lowest non-empty bucket are expanded in parallel over their light edges
+// (weight <= delta) until the bucket stays empty, then their heavy edges are
+// relaxed once. A small delta approaches Dijkstra (little parallelism, no
+// wasted work), a large one approaches Bellman-Ford.
+
+// Arcs of a Graph reordered so each node's light arcs come first
+struct DeltaSteppingIndex {
+    float delta = 0;
+    std::vector<int> lightEnd; // per node, end of its light arcs in target/weight
+    std::vector<int> target;
+    std::vector<float> weight;
+};
+
+// scale times the median arc length; 0 if the graph has no arcs
+float suggestDelta(const Graph& graph, float scale = 2.0f);
+
+// delta <= 0 uses suggestDelta(graph)
+DeltaSteppingIndex buildDeltaSteppingIndex(const Graph& graph, float delta = 0);
+
+struct DeltaSteppingResult {
+    std::vector<float> dist; // kInfinity where unreachable
+    std::vector<int> prev;   // shortest path tree, -1 at the source and unreached nodes
+    QueryStats stats;        // heap counters count bucket insertions and removals
+};
+
+// Large phases are split over the pool's workers while the calling thread
+// waits; small ones, and all of them with a one-thread pool, run inline. The
+// pool must not be running other work: phases end with pool.wait().
+void deltaSteppingTree(const Graph& graph, const DeltaSteppingIndex& index, int source,
+                       ThreadPool& pool, DeltaSteppingResult& result);
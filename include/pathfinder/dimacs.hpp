@@ -0,0 +1,27 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <string>
+#include <vector>
+
+// Reader for the 9th DIMACS implementation challenge formats
+// (http://www.diag.uniroma1.it/challenge9/format.shtml).
+//
+// Every DIMACS vertex becomes a destination node, so vertex id i maps to
+// destinationNodes[i - 1] and to graph node id i - 1. Vertices may share
+// coordinates, so arcs name their ends by id (build with the IdArc overload
+// of buildGraph) and keep the .gr lengths as their weight. Of parallel arcs
+// only the shortest is kept.
+bool loadDimacsGraph(const std::string& grPath,
+                     const std::string& coPath,
+                     std::vector<Node>& destinationNodes,
+                     std::vector<IdArc>& arcs);
+
+struct DimacsQueries {
+    bool singleSource = false;           // .ss file: sources only
+    std::vector<int> sources;            // 0-based node ids
+    std::vector<std::pair<int, int>> pairs; // .p2p file: 0-based (source, target)
+};
+
+// Reads a .ss or .p2p query file; the kind is taken from its problem line.
+bool loadDimacsQueries(const std::string& path, DimacsQueries& queries);
@@ -0,0 +1,10 @@
+#pragma once
+
+// Functions are exported from a shared pathfinder_core on Windows through
+// WINDOWS_EXPORT_ALL_SYMBOLS, but global variables still need dllimport on
+// the consuming side.
+#if defined(_WIN32) && defined(PATHFINDER_CORE_SHARED) && !defined(PATHFINDER_CORE_BUILDING)
+#define PATHFINDER_CORE_DATA __declspec(dllimport)
+#else
+#define PATHFINDER_CORE_DATA
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "pathfinder/vec2.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <limits>
+#include <string>
+
+struct Node {
+    Vec2 position;
+    bool isDestination;
+};
+
+float euclidean(const Vec2& a, const Vec2& b);
+
+// Road classes, from slowest to fastest. An edge without its own speed
+// travels at its class's default speed.
+enum class RoadClass : uint8_t { Track, Street, Main, Motorway };
+
+constexpr int kRoadClassCount = 4;
+
+const char* roadClassName(RoadClass roadClass);          // "track", "street", ...
+bool parseRoadClass(const std::string& text, RoadClass& roadClass);
+float defaultSpeed(RoadClass roadClass);                 // 1 for Street
+
+// Edge between two node positions. Without attributes it costs its length,
+// as before they existed.
+struct Edge {
+    Vec2 from;
+    Vec2 to;
+    float weight = -1.0f;                // cost as given; negative derives it from length and speed
+    float speed = 0.0f;                  // 0 for the class default
+    RoadClass roadClass = RoadClass::Street;
+    bool oneWay = false;                 // only traversable from -> to
+};
+
+// Cost of traversing edge: its weight when set, otherwise its euclidean
+// length over its speed
+float edgeWeight(const Edge& edge);
+
+// Work done by a single search
+struct QueryStats {
+    int settled = 0;
+    int relaxed = 0;    // edges scanned from settled nodes
+    int heapPushes = 0;
+    int heapPops = 0;   // stale entries included
+};
+
+// Position based query used by the editor; rebuilds the graph on every call.
+// distance, when given, receives the path's cost (kInfinity if unreachable).
+std::vector<Vec2> findShortestPath(
+    const Vec2& start,
+    const Vec2& goal,
+    const std::vector<Node>& destinationNodes,
+    const std::vector<Node>& roadNodes,
+    const std::vector<Edge>& edges,
+    QueryStats* stats = nullptr,
+    float* distance = nullptr
+);
+
+// Compressed adjacency built once from the editor vectors. Node ids follow
+// the editor order: destinations first, then roads. Every edge becomes an arc
+// weighted by edgeWeight, plus the reverse arc unless it is one-way.
+struct Graph {
+    std::vector<Vec2> positions;
+    std::vector<int> firstEdge; // nodeCount() + 1 offsets into target/weight
+    std::vector<int> target;
+    std::vector<float> weight;
+    std::vector<uint8_t> arcClass; // arc -> RoadClass of its edge, for time-dependent travel times
+    int destinationCount = 0;
+
+    int nodeCount() const { return static_cast<int>(positions.size()); }
+};
+
+Graph buildGraph(const std::vector<Node>& destinationNodes,
+                 const std::vector<Node>& roadNodes,
+                 const std::vector<Edge>& edges);
+
+// Arc between node ids, for inputs whose nodes are known by id rather than
+// by position (DIMACS vertices may share coordinates)
+struct IdArc {
+    int from;
+    int to;
+    float weight;
+};
+
+// Same node numbering, but every arc is taken as given: one direction, road
+// class Street. Arcs naming an unknown id are dropped.
+Graph buildGraph(const std::vector<Node>& destinationNodes,
+                 const std::vector<Node>& roadNodes,
+                 const std::vector<IdArc>& arcs);
+
+// Same nodes with every arc turned around, for searches towards a node
+Graph reverseGraph(const Graph& graph);
+
+// Hash of the node count and arcs, leaving out weights: preprocessing that
+// only depends on which nodes are connected stays valid while it matches
+uint64_t topologyFingerprint(const Graph& graph);
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+// Scratch state reused between searches. Only the entries touched by the
+// previous query are reset, so repeated queries do not pay O(nodes) each.
+struct SearchContext {
+    std::vector<float> dist;
+    std::vector<int> prev;
+    std::vector<float> potential; // A* lower bound to the target, 0 for plain Dijkstra
+    std::vector<int> touched;
+    std::vector<std::pair<float, int>> heap; // (dist + potential, node), stale entries left in place
+    QueryStats stats;
+
+    void prepare(int nodeCount);
+    void reset();
+};
+
+struct PathResult {
+    float distance = kInfinity;
+    std::vector<int> path; // node ids from source to target, empty if unreachable
+    QueryStats stats;
+    bool cancelled = false; // stopped through SearchControl before it finished
+};
+
+// Distance and node path to target as a search left them in context, with
+// its stats
+PathResult collectPath(int target, const SearchContext& context);
+
+// Point-to-point Dijkstra over a prebuilt graph.
+PathResult shortestPath(const Graph& graph, int source, int target, SearchContext& context);
+
+// Lets another thread stop a long search and watch it progress. Both are
+// checked every kProgressInterval settled nodes.
+struct SearchControl {
+    const std::atomic<bool>* cancel = nullptr;
+    std::function<void(const SearchContext&)> progress; // runs on the searching thread
+};
+
+constexpr int kProgressInterval = 2048;
+
+// As above, but returns early with cancelled set once *control.cancel is true.
+PathResult shortestPath(const Graph& graph, int source, int target, SearchContext& context,
+                        const SearchControl& control);
+
+// One-to-all Dijkstra; distances are left in context.dist until the next search.
+void shortestPathTree(const Graph& graph, int source, SearchContext& context);
+
+// One-to-many Dijkstra: stops as soon as the targetCount distinct nodes marked
+// in isTarget are settled. Distances are left in context.dist.
+void shortestPathsToTargets(const Graph& graph, int source, const std::vector<char>& isTarget,
+                            int targetCount, SearchContext& context);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// One published, never modified graph
+struct GraphVersion {
+    uint64_t number = 0;
+    Graph graph;
+};
+
+// Read-copy-update holder for the graph that queries run on. Readers pin the
+// current version without taking a lock; a writer builds a complete new Graph
+// and swaps it in with one atomic store. Replaced versions are freed once
+// every reader that could still see them has let go (epoch-based
+// reclamation), so an edit never waits for queries and queries never wait
+// for an edit.
+class GraphStore {
+public:
+    explicit GraphStore(Graph initial = Graph());
+    ~GraphStore(); // no Reader may outlive the store
+
+    GraphStore(const GraphStore&) = delete;
+    GraphStore& operator=(const GraphStore&) = delete;
+
+    // Keeps one version alive while it exists. Short-lived by design: a
+    // pinned reader holds back the reclamation of every version retired
+    // after it pinned.
+    class Reader {
+    public:
+        Reader(Reader&& other) noexcept;
+        Reader& operator=(Reader&&) = delete;
+        Reader(const Reader&) = delete;
+        ~Reader();
+
+        const Graph& graph() const { return version->graph; }
+        uint64_t number() const { return version->number; }
+
+    private:
+        friend class GraphStore;
+        Reader(std::atomic<uint64_t>* slot, const GraphVersion* version) : slot(slot), version(version) {}
+
+        std::atomic<uint64_t>* slot;
+        const GraphVersion* version;
+    };
+
+    // Lock-free; spins only if more than kReaderSlots readers are pinned at once
+    Reader read() const;
+
+    // Makes graph the current version and returns its number. Writers are
+    // serialised among themselves, never against readers.
+    uint64_t publish(Graph graph);
+
+    uint64_t currentNumber() const;
+
+    // Replaced versions still waiting for their readers
+    size_t retiredCount() const;
+
+    static constexpr int kReaderSlots = 256;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0}; // 0 when free, else the epoch its reader pinned
+    };
+
+    void reclaim();
+
+    std::atomic<const GraphVersion*> current;
+    std::atomic<uint64_t> epoch{1};
+    mutable Slot slots[kReaderSlots];
+
+    mutable std::mutex writerMutex;
+    std::vector<std::pair<uint64_t, const GraphVersion*>> retired; // (epoch retired in, version)
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hub labels: every node keeps a few (hub, distance) pairs such that any
+// shortest path s -> t passes through a hub that is in both the out-label of
+// s and the in-label of t. A distance query is then one merge of two short
+// sorted arrays, with no search at all.
+//
+// Labels are computed by pruned landmark labelling: hubs are taken in
+// contraction order, most important first, and each hub's searches stop at
+// nodes whose distance the hubs before it already cover.
+
+struct HubLabel {
+    int hub;        // rank in HubLabels::order; kLabelEnd closes every label
+    float distance; // d(node, hub) in out-labels, d(hub, node) in in-labels
+};
+
+constexpr int kLabelEnd = INT_MAX;
+
+struct HubLabels {
+    std::vector<int> order;    // rank -> node, most important first
+    uint64_t fingerprint = 0;  // graphFingerprint of the graph they were built on
+
+    // Node v's label is entries [start[v], start[v + 1]), sorted by hub and
+    // ending with a kLabelEnd entry
+    std::vector<int> outStart, inStart;
+    std::vector<HubLabel> outLabels, inLabels;
+    // Next node towards the hub (out) or previous node from it (in), one per
+    // entry; empty when the labels were built or loaded without paths
+    std::vector<int> outParent, inParent;
+
+    int nodeCount() const { return static_cast<int>(order.size()); }
+    bool hasParents() const { return !outParent.empty(); }
+    // Hubs per label, not counting the end markers
+    double averageLabelSize() const;
+    size_t memoryBytes() const;
+};
+
+// Nodes in contraction hierarchy order, most important first: repeatedly
+// contracts the node whose removal needs the fewest shortcuts for the arcs
+// it takes away (checked with bounded witness searches), so the nodes left
+// at the end are the ones many shortest paths cross.
+std::vector<int> contractionOrder(const Graph& graph);
+
+HubLabels buildHubLabels(const Graph& graph, bool withParents = true);
+// With hubs taken in the given order (a permutation of the nodes, most
+// important first)
+HubLabels buildHubLabels(const Graph& graph, const std::vector<int>& order, bool withParents);
+
+// Hash of the graph's arcs and weights, to tell whether labels belong to it
+uint64_t graphFingerprint(const Graph& graph);
+
+// d(source, target), kInfinity if unreachable; both ids must be below
+// labels.nodeCount(). Not recorded in the query metrics: at this rate the
+// shared counters would cost more than the query.
+float hubDistance(const HubLabels& labels, int source, int target);
+
+// Distance and, when the labels have parents, the node path. stats.relaxed
+// counts the label entries scanned.
+PathResult hubShortestPath(const HubLabels& labels, int source, int target);
+
+// Little endian, with hubs and parents varint coded:
+//   "PFHL" | u32 version (1) | u32 nodes | u32 flags (1: parents) |
+//   u64 fingerprint | varint order[nodes] |
+//   out-labels then in-labels, per node:
+//     varint size | varint hub gaps[size] | f32 distances[size] |
+//     varint zigzag(parent - node)[size] when flagged
+// Hubs of a label are increasing, so their gaps are small; parents are
+// neighbours, so after a locality ordering (see reorder.hpp) they are close.
+bool saveHubLabels(const HubLabels& labels, const std::string& path);
+bool loadHubLabels(HubLabels& labels, const std::string& path);
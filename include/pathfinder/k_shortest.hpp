@@ -0,0 +1,42 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/thread_pool.hpp"
+#include <vector>
+
+// K shortest loopless paths (Yen). Every accepted path P spawns one spur
+// search per node i past the point where P left its parent: the shortest
+// path that follows P up to i, then avoids P's earlier nodes and every arc
+// out of i taken by an accepted path with that same prefix.
+//
+// Three things keep this affordable for K in the hundreds:
+//   - One shortest path tree towards the target, grown once per query,
+//     gives every spur search an exact A* potential, and answers the spur
+//     outright when the tree path from i avoids everything blocked.
+//   - Spurs are queued at a lower bound (the prefix cost, then the cheapest
+//     arc out of i still allowed and the tree from there) and only searched
+//     once they reach the front of the queue, so most of them never run.
+//   - The spurs at the front are searched together, one per pool worker.
+
+// Scratch state reused between queries, like SearchContext
+struct KShortestSearch {
+    struct Spur {
+        SearchContext context;
+        std::vector<char> blocked; // nodes of the prefix, set during one search
+    };
+
+    SearchContext tree;         // distances to the target over the reversed graph
+    std::vector<Spur> spurs;    // one per pool worker
+    std::vector<int> position;  // node -> index on the path being accepted, else -1
+};
+
+// Up to k loopless paths from source to target by increasing cost; fewer if
+// there are not that many, none if target is unreachable. reversed is
+// reverseGraph(graph). Runs spur searches on pool, so it must not be called
+// from one of pool's own tasks. Every path carries the stats of all searches.
+// With control, cancellation is checked between batches of spur searches
+// (progress is not reported); once cancelled the result is a single path
+// with cancelled set and no nodes.
+std::vector<PathResult> kShortestPaths(const Graph& graph, const Graph& reversed, int source, int target, int k,
+                                       KShortestSearch& search, ThreadPool& pool,
+                                       const SearchControl* control = nullptr);
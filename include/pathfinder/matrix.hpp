@@ -0,0 +1,33 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <string>
+#include <vector>
+
+// Row-major table of shortest path distances from each source (row) to each
+// target (column); kInfinity where a target is unreachable.
+struct DistanceMatrix {
+    std::vector<int> sources;
+    std::vector<int> targets;
+    std::vector<float> values;
+
+    float at(size_t row, size_t column) const { return values[row * targets.size() + column]; }
+};
+
+// One pruned Dijkstra per source, each stopping once all targets are settled.
+// Rows are spread over threadCount threads (0 = hardware concurrency), each
+// with its own search context.
+DistanceMatrix computeDistanceMatrix(const Graph& graph,
+                                     const std::vector<int>& sources,
+                                     const std::vector<int>& targets,
+                                     unsigned threadCount = 0);
+
+// CSV with a header row of target ids and a leading column of source ids;
+// unreachable entries are left empty.
+bool writeMatrixCsv(const DistanceMatrix& matrix, const std::string& path);
+
+// Little endian binary layout:
+//   "PFDM" | u32 version (1) | u32 rows | u32 columns |
+//   u32 sources[rows] | u32 targets[columns] | f32 values[rows * columns]
+// Unreachable entries are stored as +infinity.
+bool writeMatrixBinary(const DistanceMatrix& matrix, const std::string& path);
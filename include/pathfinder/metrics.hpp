@@ -0,0 +1,128 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Process-wide counters, gauges and latency histograms, exported in the
+// Prometheus text exposition format. Recording is lock-free; only creating a
+// series and exporting take the registry mutex, so callers look a series up
+// once and keep the reference.
+
+using MetricsClock = std::chrono::steady_clock;
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { count.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> count{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { current.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { current.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> current{0};
+};
+
+// Log-linear histogram in the style of HdrHistogram: values below 128 ns get
+// their own bucket, above that every power of two is split into 64 linear
+// sub-buckets, so a quantile is reported within 1/64 of the recorded value.
+// Covers 1 ns to about 78 hours; larger values land in the last bucket.
+class LatencyHistogram {
+public:
+    void record(uint64_t nanoseconds);
+    void record(MetricsClock::duration elapsed);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sumNanoseconds() const { return sum.load(std::memory_order_relaxed); }
+    uint64_t maxNanoseconds() const { return maximum.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the q-th quantile, in nanoseconds
+    uint64_t quantile(double q) const;
+
+    static int bucketIndex(uint64_t nanoseconds);
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    static constexpr int kLinearBuckets = 128;
+    static constexpr int kSubBuckets = 64;
+    static constexpr int kMaxExponent = 48;
+    static constexpr int kBucketCount = kLinearBuckets + (kMaxExponent - 7) * kSubBuckets;
+
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maximum{0};
+};
+
+class MetricsRegistry {
+public:
+    // Returns the series for name and labels (e.g. "query=\"legacy\""),
+    // creating it on first use. A name must always be used with one type.
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    LatencyHistogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // Histograms are exported as summaries (p50/p90/p99/p99.9, _sum, _count)
+    // plus a _max gauge; durations are in seconds.
+    std::string prometheusText() const;
+
+    // Replaces path atomically so a scraper never reads a partial file; "-"
+    // writes to stdout.
+    bool writePrometheusFile(const std::string& path) const;
+
+private:
+    enum class Kind { Counter, Gauge, Histogram };
+
+    struct Series {
+        std::string labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<LatencyHistogram> histogram;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Kind kind;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    Series& series(Kind kind, const std::string& name, const std::string& help, const std::string& labels);
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Family>> families;
+};
+
+MetricsRegistry& metrics();
+
+// The series every query engine feeds, labelled query="<kind>"
+struct QueryMetrics {
+    LatencyHistogram& latency;
+    Counter& queries;
+    Counter& unreachable;
+    Counter& settled;
+    Counter& relaxed;
+    Counter& heapPushes;
+    Counter& heapPops;
+
+    void record(MetricsClock::duration elapsed, const QueryStats& stats, bool reachable);
+};
+
+// Registered once per kind; keep the reference (e.g. in a function static)
+QueryMetrics& queryMetrics(const std::string& kind);
+
+// The PATHFINDER_METRICS environment variable, or an empty string
+std::string metricsOutputFromEnvironment();
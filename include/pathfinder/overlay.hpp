@@ -0,0 +1,59 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/thread_pool.hpp"
+#include <vector>
+
+// Multi-level overlay graph (customizable route planning, Delling et al.).
+// Nodes are split into nested cells by recursive bisection over their
+// positions. For every cell of every level the overlay keeps a clique over
+// the cell's boundary nodes, weighted by shortest distances inside the cell.
+// A query only follows input arcs in the finest cells of its endpoints and
+// crosses everything else over the coarsest cliques that contain neither.
+//
+// The partition depends only on the topology. After weights change, only the
+// cliques of cells containing a changed arc (and the cells above them) are
+// recomputed, which is what keeps it usable while a graph is being edited.
+
+struct OverlayLevel {
+    std::vector<int> cell; // node -> cell
+    // Nodes with an arc to or from another cell of this level, grouped by
+    // cell: those of cell c are [boundaryFirst[c], boundaryFirst[c + 1])
+    std::vector<int> boundaryFirst, boundary;
+    std::vector<int> slot; // node -> index within its cell's boundary, -1 inside
+    // Cell c's k x k distance matrix starts at cliqueFirst[c]: entry i * k + j
+    // is the distance from boundary node i to j without leaving the cell
+    std::vector<size_t> cliqueFirst;
+    std::vector<float> clique;
+
+    int cellCount() const { return static_cast<int>(boundaryFirst.size()) - 1; }
+};
+
+struct OverlayGraph {
+    std::vector<OverlayLevel> levels; // finest first; each cell lies inside one cell of the next
+    uint64_t fingerprint = 0;         // topologyFingerprint of the graph it was built on
+    std::vector<float> weight;        // arc weights the cliques hold distances for
+
+    size_t memoryBytes() const;
+};
+
+// Largest cell per level, finest first
+inline const std::vector<int> kDefaultCellSizes = {256, 4096, 65536};
+
+// Partitions the graph (cellSizes increasing) and computes every clique, the
+// cells of one level spread over the pool
+OverlayGraph buildOverlay(const Graph& graph, ThreadPool& pool,
+                          const std::vector<int>& cellSizes = kDefaultCellSizes);
+
+// Whether overlay was built on graph's topology, whatever its weights
+bool overlayFits(const OverlayGraph& overlay, const Graph& graph);
+
+// Recomputes the cliques of cells whose arcs changed weight since the overlay
+// was last customized, bottom-up; overlay must fit graph. Returns how many
+// cells were recomputed over all levels.
+int updateOverlay(OverlayGraph& overlay, const Graph& graph, ThreadPool& pool);
+
+// Point-to-point Dijkstra over the overlay. stats.settled counts nodes of the
+// input graph and of cliques alike.
+PathResult overlayShortestPath(const Graph& graph, const OverlayGraph& overlay, int source, int target,
+                               SearchContext& context);
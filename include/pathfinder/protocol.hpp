@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary protocol spoken by pathfinder_server. Every message is a frame:
+//
+//   u32 payload length | payload
+//
+// Request payload:  u32 id | u8 type | body
+//   Route:  u32 source | u32 target | u8 flags (kWantPath)
+//   Info:   (empty)
+//   Metrics: (empty)
+// Response payload: u32 id | u8 type | u8 status | body
+//   Route:  f32 distance | u32 settled | u32 path length | u32 path[length]
+//   Info:   u32 node count | u32 destination count
+//   Metrics: u32 length | Prometheus text exposition (see pathfinder/metrics.hpp)
+//
+// Integers and floats are little endian. Node ids are graph node ids
+// (destinations first, then roads). Clients may pipeline requests; responses
+// carry the request id and can arrive out of order.
+
+enum class MessageType : uint8_t {
+    Route = 1,
+    Info = 2,
+    Metrics = 3,
+};
+
+enum class Status : uint8_t {
+    Ok = 0,
+    Unreachable = 1,
+    BadRequest = 2,
+};
+
+constexpr uint8_t kWantPath = 1;
+constexpr size_t kFrameHeaderSize = 4;
+constexpr uint32_t kMaxPayloadSize = 1u << 24;
+constexpr size_t kInvalidFrame = static_cast<size_t>(-1);
+
+struct Request {
+    uint32_t id = 0;
+    MessageType type = MessageType::Route;
+    uint32_t source = 0;
+    uint32_t target = 0;
+    uint8_t flags = 0;
+};
+
+struct Response {
+    uint32_t id = 0;
+    MessageType type = MessageType::Route;
+    Status status = Status::Ok;
+    float distance = 0;
+    uint32_t settled = 0;
+    std::vector<uint32_t> path;
+    uint32_t nodeCount = 0;
+    uint32_t destinationCount = 0;
+    std::string text; // Metrics
+};
+
+// Size of the complete frame (header included) at the front of data, 0 if
+// more bytes are needed, or kInvalidFrame if the length is out of range.
+size_t completeFrameSize(const uint8_t* data, size_t size);
+
+// Append a full frame to out.
+void appendRequest(std::vector<uint8_t>& out, const Request& request);
+void appendResponse(std::vector<uint8_t>& out, const Response& response);
+
+// Decode a frame payload (without its length header).
+bool parseRequest(const uint8_t* payload, size_t size, Request& request);
+bool parseResponse(const uint8_t* payload, size_t size, Response& response);
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "pathfinder/graph_store.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// What a query looks for besides the shortest path
+enum class QueryRoutes {
+    Shortest,
+    Alternatives, // up to three meaningfully different routes (see alternatives.hpp)
+    KShortest     // the kEditorPaths shortest loopless paths (see k_shortest.hpp)
+};
+
+constexpr int kEditorPaths = 5;
+
+// Handle to one query running on a QueryWorker, polled from the UI thread
+class QueryTicket {
+public:
+    // Finished, or stopped by cancel()
+    bool ready() const { return done.load(std::memory_order_acquire); }
+    bool cancelled() const { return cancelRequested.load(std::memory_order_relaxed); }
+    void cancel() { cancelRequested.store(true, std::memory_order_relaxed); }
+
+    // Valid once ready(); result().cancelled tells a stopped search apart
+    const PathResult& result() const { return answer; }
+    std::chrono::steady_clock::duration elapsed() const { return duration; }
+
+    // Positions of result().path, and the graph version it was found in.
+    // Node ids are only meaningful within that version.
+    const std::vector<Vec2>& pathPoints() const { return points; }
+    // Positions of the further routes found, ranked after pathPoints()
+    const std::vector<std::vector<Vec2>>& alternativePoints() const { return alternatives; }
+    uint64_t graphNumber() const { return number; }
+
+    // Positions of the nodes on the search frontier, refreshed while the
+    // query runs when frontier streaming was requested
+    std::vector<Vec2> frontier() const;
+
+private:
+    friend class QueryWorker;
+
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<bool> done{false};
+    PathResult answer;
+    std::vector<Vec2> points;
+    std::vector<std::vector<Vec2>> alternatives;
+    uint64_t number = 0;
+    std::chrono::steady_clock::duration duration{};
+    mutable std::mutex frontierMutex;
+    std::vector<Vec2> frontierPoints;
+};
+
+// One background thread answering point-to-point queries for an interactive
+// caller. A new submission cancels the query in flight, so only the latest
+// request is ever worked on. Queries run ALT (see alt.hpp); the first query
+// on a new graph version recomputes the landmarks before it starts, and
+// cancelling it stops that recomputation too.
+class QueryWorker {
+public:
+    explicit QueryWorker(const GraphStore& store);
+    ~QueryWorker();
+
+    QueryWorker(const QueryWorker&) = delete;
+    QueryWorker& operator=(const QueryWorker&) = delete;
+
+    // Searches the graph version current at the time of the call, so ids
+    // picked against it stay valid even if a newer version is published
+    // before the search starts. Out of range ids find no path.
+    std::shared_ptr<QueryTicket> submit(int source, int target, bool streamFrontier = false,
+                                        QueryRoutes routes = QueryRoutes::Shortest);
+
+    // Cancels the queued and the running query, if any
+    void cancel();
+
+private:
+    struct Job {
+        std::unique_ptr<GraphStore::Reader> graph;
+        int source = 0;
+        int target = 0;
+        bool streamFrontier = false;
+        QueryRoutes routes = QueryRoutes::Shortest;
+        std::shared_ptr<QueryTicket> ticket;
+    };
+
+    void run();
+
+    const GraphStore& store;
+    std::mutex mutex;
+    std::condition_variable wake;
+    Job next;                              // ticket is null when nothing is queued
+    std::shared_ptr<QueryTicket> running;
+    bool stopping = false;
+    std::thread thread;
+};
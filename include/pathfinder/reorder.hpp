@@ -0,0 +1,38 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <string>
+#include <vector>
+
+// Node numberings for memory locality. buildGraph numbers nodes in editor
+// order, so neighbours can sit anywhere in the node arrays; renumbering so
+// that nearby nodes get nearby ids keeps a search's working set in fewer
+// cache lines.
+enum class NodeOrder {
+    Input,   // editor order, unchanged
+    Hilbert, // along a Hilbert curve over the node positions
+    Bfs,     // breadth-first from the lowest id of each component
+    Rcm      // reverse Cuthill-McKee, which minimises the adjacency bandwidth
+};
+
+// "input", "hilbert", "bfs" or "rcm"
+bool parseNodeOrder(const std::string& text, NodeOrder& order);
+const char* nodeOrderName(NodeOrder order);
+
+// A graph renumbered for locality, with the maps between its ids and the
+// ids buildGraph gave the same nodes. Destinations are no longer the first
+// ids: destination d is toInternal[d], and destinationCount keeps its
+// editor meaning.
+struct ReorderedGraph {
+    Graph graph;
+    std::vector<int> toInternal; // editor id -> id in graph
+    std::vector<int> toEditor;   // id in graph -> editor id
+};
+
+// newId[v] for every node of graph, a permutation of 0..nodeCount()-1
+std::vector<int> computeNodeOrder(const Graph& graph, NodeOrder order);
+
+ReorderedGraph reorderGraph(const Graph& graph, NodeOrder order);
+
+// Mean |u - v| over all arcs; lower means neighbours are closer in memory
+double meanArcSpan(const Graph& graph);
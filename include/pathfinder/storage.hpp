@@ -0,0 +1,37 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/turns.hpp"
+#include <string>
+#include <vector>
+
+// nodes.json holds the editor state: destination and road positions, and
+// edges as pairs of positions. An edge with attributes carries a third
+// element, an object with any of "weight", "speed", "class" (track, street,
+// main or motorway) and "oneway"; files without it load as before. Optional
+// "turns" hold [from, via, to] positions plus a cost, or no cost for a
+// forbidden turn.
+void saveToFile(const std::vector<Node>& destinationNodes,
+                const std::vector<Node>& roadNodes,
+                const std::vector<Edge>& edges,
+                const std::string& path = "nodes.json");
+
+void saveToFile(const std::vector<Node>& destinationNodes,
+                const std::vector<Node>& roadNodes,
+                const std::vector<Edge>& edges,
+                const std::vector<Turn>& turns,
+                const std::string& path = "nodes.json");
+
+// Appends the nodes and edges stored in path. Returns false if the file
+// cannot be opened or parsed; a missing file leaves the vectors untouched.
+bool loadFromFile(std::vector<Node>& destinationNodes,
+                  std::vector<Node>& roadNodes,
+                  std::vector<Edge>& edges,
+                  const std::string& path = "nodes.json");
+
+// Also appends the turns stored in path
+bool loadFromFile(std::vector<Node>& destinationNodes,
+                  std::vector<Node>& roadNodes,
+                  std::vector<Edge>& edges,
+                  std::vector<Turn>& turns,
+                  const std::string& path = "nodes.json");
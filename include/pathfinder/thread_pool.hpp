@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. A worker runs its own
+// newest task first and, when it runs dry, steals the oldest task of another
+// worker, so uneven tasks balance without a single contended queue. Tasks
+// submitted from outside the pool are dealt round-robin; tasks submitted by a
+// worker go to its own deque.
+class ThreadPool {
+public:
+    // threadCount 0 picks std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Blocks until every submitted task has finished
+    void wait();
+
+    // Counts queues, which are all in place before the first worker starts
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+    // Index of the calling worker within its pool, or -1 off the pool
+    static int workerIndex();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popOwn(unsigned index, std::function<void()>& task);
+    bool steal(unsigned thief, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};  // tasks waiting in the deques
+    std::atomic<size_t> pending{0}; // tasks submitted and not yet finished
+    std::atomic<unsigned> nextQueue{0};
+    std::mutex sleepMutex;
+    std::condition_variable taskReady;
+    std::condition_variable idle;
+    bool stopping = false;
+};
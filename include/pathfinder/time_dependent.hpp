@@ -0,0 +1,92 @@
+#pragma once
+
+#include "pathfinder/alt.hpp"
+#include "pathfinder/graph.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Time-dependent travel times. An arc departed at time t takes
+//   weight * factor(profile, t)
+// where a profile is a piecewise-linear, periodic factor over one breakpoint
+// grid shared by all profiles. Every road class has a profile, which its
+// arcs follow unless they are given one of their own (setArcProfiles); arcs
+// with equal factors share one. The store is the grid, a row of factors per
+// profile and, once some arc has its own, a 16-bit profile per arc. A search
+// looks up the breakpoint segment once per settled node rather than per arc.
+//
+// Searches are exact when every arc is FIFO: leaving later never arrives
+// earlier, i.e. weight * slope >= -1 on every segment (see checkFifo).
+
+struct TravelTimeProfiles {
+    float period = 86400.0f;    // factors repeat after this much time
+    std::vector<float> times;   // breakpoints, increasing within [0, period)
+    // factors[p * times.size() + i]: factor of profile p at times[i], linear
+    // in between and wrapping from the last breakpoint to the first. The
+    // first kRoadClassCount profiles are the road classes'.
+    std::vector<float> factors;
+    // Profile of every arc of the graph given to setArcProfiles; empty while
+    // all arcs follow their road class
+    std::vector<uint16_t> arcProfile;
+
+    int breakpointCount() const { return static_cast<int>(times.size()); }
+    int profileCount() const {
+        return times.empty() ? kRoadClassCount : static_cast<int>(factors.size() / times.size());
+    }
+    int profileOf(const Graph& graph, int arc) const {
+        if (!arcProfile.empty()) return arcProfile[arc];
+        return graph.arcClass.empty() ? static_cast<int>(RoadClass::Street) : graph.arcClass[arc];
+    }
+    float factor(int profile, float time) const;
+    float factor(RoadClass roadClass, float time) const { return factor(static_cast<int>(roadClass), time); }
+    float minimumFactor(int profile) const;
+    float minimumFactor(RoadClass roadClass) const { return minimumFactor(static_cast<int>(roadClass)); }
+    size_t memoryBytes() const {
+        return (times.size() + factors.size()) * sizeof(float) + arcProfile.size() * sizeof(uint16_t);
+    }
+};
+
+// Factors of one arc, named by its end nodes; an entry covers one direction
+struct ArcProfile {
+    int from;
+    int to;
+    std::vector<float> factors; // one per breakpoint
+};
+
+// A weekday over 24 hours in seconds: morning and evening peaks, strongest on
+// motorways and main roads, none on tracks
+TravelTimeProfiles defaultTravelTimeProfiles();
+
+// JSON object with "times" (seconds), optional "period" and one factor array
+// per class name ("track", "street", "main", "motorway"); missing classes
+// keep a factor of 1. An optional "arcs" array of {"from", "to", "factors"}
+// objects is returned in arcs, ids as written, for setArcProfiles; without
+// arcs such a file is refused. Returns false with a message on errors.
+bool loadTravelTimeProfiles(const std::string& path, TravelTimeProfiles& profiles,
+                            std::vector<ArcProfile>* arcs = nullptr);
+
+// Gives the arcs from -> to of graph (its node ids) the factors of their
+// entry, later entries winning; other arcs keep their road class's profile.
+// Returns false with a message when an entry matches no arc, has the wrong
+// number of factors or more than 65536 profiles would be needed.
+bool setArcProfiles(TravelTimeProfiles& profiles, const Graph& graph, const std::vector<ArcProfile>& arcs);
+
+// "8:30", "08:30:15" or whole seconds ("30600"), within one day: hours
+// below 24, minutes and seconds two digits below 60. Anything else is
+// rejected rather than wrapped.
+bool parseTimeOfDay(const std::string& text, float& seconds);
+
+// Whether every arc of graph is FIFO under profiles; reports the first
+// profile that is not
+bool checkFifo(const Graph& graph, const TravelTimeProfiles& profiles);
+
+// Same arcs, each weighted by its smallest travel time over the period.
+// Landmarks built on it give valid A* bounds for time-dependent queries.
+Graph lowerBoundGraph(const Graph& graph, const TravelTimeProfiles& profiles);
+
+// Earliest arrival from source leaving at departure. distance is the travel
+// time, and the path the route taken. With landmarks (built on
+// lowerBoundGraph of graph) the search is A* over their bounds.
+PathResult timeDependentShortestPath(const Graph& graph, const TravelTimeProfiles& profiles, int source,
+                                     int target, float departure, SearchContext& context,
+                                     const LandmarkIndex* landmarks = nullptr);
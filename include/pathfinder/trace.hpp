@@ -0,0 +1,79 @@
+#pragma once
+
+#include "pathfinder/export.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Timeline tracing in the Chrome trace-event format; the output opens in
+// Perfetto (ui.perfetto.dev) and chrome://tracing.
+//
+// TRACE_SCOPE("name") records a complete event from the statement to the end
+// of the enclosing scope. Each thread writes into its own fixed-size ring
+// buffer without locks, keeping its most recent events. Names and
+// categories must be string literals. While tracing is stopped a scope costs
+// one relaxed load and a predictable branch.
+
+using TraceClock = std::chrono::steady_clock;
+
+extern PATHFINDER_CORE_DATA std::atomic<bool> gTraceEnabled;
+
+inline bool isTracing() { return gTraceEnabled.load(std::memory_order_relaxed); }
+
+void startTracing();
+void stopTracing();
+
+// The PATHFINDER_TRACE environment variable, or an empty string
+std::string traceOutputFromEnvironment();
+
+// Labels the calling thread in the exported timeline
+void setTraceThreadName(const std::string& name);
+
+// Records a finished span on the calling thread's buffer
+void recordTraceEvent(const char* name, const char* category,
+                      TraceClock::time_point start, TraceClock::time_point end);
+
+// Writes every buffered event recorded since the last startTracing() as
+// Chrome trace JSON. Threads still tracing may overwrite events being
+// copied, so stop tracing first for an exact snapshot.
+bool writeTrace(const std::string& path);
+
+// Traces from construction to destruction, then writes the timeline to path.
+// An empty path disables the session.
+class TraceSession {
+public:
+    explicit TraceSession(std::string path);
+    ~TraceSession();
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+private:
+    std::string path;
+};
+
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category) : name(name), category(category) {
+        if (isTracing()) start = TraceClock::now();
+    }
+
+    ~TraceScope() {
+        if (start != TraceClock::time_point()) recordTraceEvent(name, category, start, TraceClock::now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    TraceClock::time_point start{};
+};
+
+#define PATHFINDER_TRACE_CONCAT_(a, b) a##b
+#define PATHFINDER_TRACE_CONCAT(a, b) PATHFINDER_TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE_CATEGORY(category, name) \
+    TraceScope PATHFINDER_TRACE_CONCAT(traceScope_, __LINE__)(name, category)
+#define TRACE_SCOPE(name) TRACE_SCOPE_CATEGORY("pathfinder", name)
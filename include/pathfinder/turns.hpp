@@ -0,0 +1,45 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <vector>
+
+// Turn costs and restrictions. A node-based search forgets how it reached a
+// node, so it cannot price the turn it takes there. The edge-based search
+// below works on the line graph instead, whose states are arcs and whose
+// transitions are turns, but it never builds it: the turns out of an arc
+// are read off the node graph and the few costed turns stored per node.
+
+// Turning at via from the edge (from, via) onto the edge (via, to), with
+// nodes given by position like Edge
+struct Turn {
+    Vec2 from;
+    Vec2 via;
+    Vec2 to;
+    float cost = kInfinity; // kInfinity forbids the turn
+};
+
+struct TurnCosts {
+    struct Entry {
+        int fromArc; // into the node
+        int toArc;   // out of it
+        float cost;
+    };
+    // Turns at node v are entries[firstEntry[v], firstEntry[v + 1]), sorted
+    // by (fromArc, toArc). Turns not listed cost nothing.
+    std::vector<int> firstEntry;
+    std::vector<Entry> entries;
+    float uTurnCost = 0.0f; // for turning back onto the edge just taken; kInfinity forbids
+
+    size_t memoryBytes() const { return firstEntry.size() * sizeof(int) + entries.size() * sizeof(Entry); }
+};
+
+// Resolves turns against graph's arcs (all of them, if edges are parallel).
+// Turns naming no existing pair of arcs are skipped; when several name the
+// same pair the highest cost applies.
+TurnCosts buildTurnCosts(const Graph& graph, const std::vector<Turn>& turns, float uTurnCost = 0.0f);
+
+// Point-to-point Dijkstra over arcs, adding the cost of every turn taken.
+// context is sized by arcs rather than nodes, so sharing one with
+// node-based searches makes both reallocate; stats count arcs.
+PathResult turnAwareShortestPath(const Graph& graph, const TurnCosts& turns, int source, int target,
+                                 SearchContext& context);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Plain 2D point so the core does not depend on SFML; the editor converts
+// to and from sf::Vector2f at the drawing boundary.
+struct Vec2 {
+    float x = 0;
+    float y = 0;
+};
+
+inline bool operator==(const Vec2& a, const Vec2& b) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=(const Vec2& a, const Vec2& b) { return !(a == b); }
+inline Vec2 operator+(const Vec2& a, const Vec2& b) { return {a.x + b.x, a.y + b.y}; }
+inline Vec2 operator-(const Vec2& a, const Vec2& b) { return {a.x - b.x, a.y - b.y}; }
+inline Vec2 operator*(const Vec2& a, float s) { return {a.x * s, a.y * s}; }
+
+// Hash function for Vec2
+namespace std {
+    template<>
+    struct hash<Vec2> {
+        size_t operator()(const Vec2& v) const {
+            // Combine hashes of x and y components
+            size_t h1 = hash<float>()(v.x);
+            size_t h2 = hash<float>()(v.y);
+            return h1 ^ (h2 << 1);
+        }
+    };
+}
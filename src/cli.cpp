@@ -0,0 +1,445 @@
+// Headless query mode: loads nodes.json and answers shortest path queries,
+// or computes a distance matrix, without opening a window.
+//
+//   pathfinder_cli [--graph nodes.json] [--json] [--query FROM TO]... [--file PATH] [--stdin] [--threads N]
+//   pathfinder_cli [--graph nodes.json] --matrix all|A,B,... [--matrix-out PATH] [--threads N]
+//
+// Engines and the other options are listed by printUsage() and described in
+// README.md ("Headless queries").
+
+#include "pathfinder/alt.hpp"
+#include "pathfinder/alternatives.hpp"
+#include "pathfinder/arc_flags.hpp"
+#include "pathfinder/batch.hpp"
+#include "pathfinder/cch.hpp"
+#include "pathfinder/graph.hpp"
+#include "pathfinder/hub_labels.hpp"
+#include "pathfinder/k_shortest.hpp"
+#include "pathfinder/matrix.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/overlay.hpp"
+#include "pathfinder/reorder.hpp"
+#include "pathfinder/storage.hpp"
+#include "pathfinder/time_dependent.hpp"
+#include "pathfinder/trace.hpp"
+#include "pathfinder/turns.hpp"
+
+#include "json.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Query {
+    std::string from;
+    std::string to;
+};
+
+// Resolves an endpoint to a graph node id, or -1 if it does not name a node.
+int resolveEndpoint(const std::string& text, const Graph& graph) {
+    if (text.empty()) return -1;
+    bool isNodeId = text[0] == 'n';
+    std::string digits = isNodeId ? text.substr(1) : text;
+    if (digits.empty() || digits.size() > 9 || digits.find_first_not_of("0123456789") != std::string::npos) return -1;
+    long long value = std::stoll(digits);
+    long long limit = isNodeId ? graph.nodeCount() : graph.destinationCount;
+    return value < limit ? static_cast<int>(value) : -1;
+}
+
+bool readQueries(std::istream& in, const std::string& source, std::vector<Query>& queries) {
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        Query q;
+        if (!(words >> q.from)) continue; // blank or comment
+        std::string extra;
+        if (!(words >> q.to) || (words >> extra)) {
+            std::cerr << source << ":" << lineNumber << ": expected \"FROM TO\"\n";
+            return false;
+        }
+        queries.push_back(q);
+    }
+    return true;
+}
+
+// Expands "all" or "A,B,..." into node ids; false on an unknown endpoint.
+bool resolveMatrixEndpoints(const std::string& spec, const Graph& graph, std::vector<int>& ids) {
+    if (spec == "all") {
+        for (int i = 0; i < graph.destinationCount; ++i) ids.push_back(i);
+        return true;
+    }
+    std::istringstream items(spec);
+    for (std::string item; std::getline(items, item, ',');) {
+        int id = resolveEndpoint(item, graph);
+        if (id < 0) {
+            std::cerr << "Unknown endpoint \"" << item << "\" in --matrix\n";
+            return false;
+        }
+        ids.push_back(id);
+    }
+    return true;
+}
+
+// With labels, every entry is one label merge instead of part of a search
+int runMatrix(const Graph& graph, const std::string& spec, const std::string& outPath, unsigned threads,
+              const ReorderedGraph* reordered, const HubLabels* labels) {
+    std::vector<int> ids;
+    if (!resolveMatrixEndpoints(spec, graph, ids)) return 1;
+    std::vector<int> internal = ids;
+    if (reordered) {
+        for (int& id : internal) id = reordered->toInternal[id];
+    }
+    DistanceMatrix matrix;
+    if (labels) {
+        matrix.values.resize(ids.size() * ids.size());
+        for (size_t row = 0; row < ids.size(); ++row) {
+            for (size_t column = 0; column < ids.size(); ++column)
+                matrix.values[row * ids.size() + column] = hubDistance(*labels, internal[row], internal[column]);
+        }
+    } else {
+        matrix = computeDistanceMatrix(reordered ? reordered->graph : graph, internal, internal, threads);
+    }
+    matrix.sources = matrix.targets = ids;
+
+    bool binary = outPath.size() > 4 && outPath.compare(outPath.size() - 4, 4, ".bin") == 0;
+    bool ok = binary ? writeMatrixBinary(matrix, outPath) : writeMatrixCsv(matrix, outPath);
+    if (!ok) {
+        std::cerr << "Cannot write " << outPath << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Loads labels from loadPath when given, otherwise builds them (and saves
+// them to savePath when given)
+bool prepareHubLabels(const Graph& graph, const std::string& loadPath, const std::string& savePath,
+                      HubLabels& labels) {
+    if (!loadPath.empty()) {
+        if (!loadHubLabels(labels, loadPath)) return false;
+        if (labels.nodeCount() != graph.nodeCount() || labels.fingerprint != graphFingerprint(graph)) {
+            std::cerr << "Hub labels in " << loadPath << " were built for a different graph or --order\n";
+            return false;
+        }
+        return true;
+    }
+    labels = buildHubLabels(graph);
+    if (!savePath.empty() && !saveHubLabels(labels, savePath)) {
+        std::cerr << "Cannot write " << savePath << "\n";
+        return false;
+    }
+    return true;
+}
+
+int finish(int status, const std::string& metricsPath) {
+    if (!metricsPath.empty() && !metrics().writePrometheusFile(metricsPath)) {
+        std::cerr << "Cannot write metrics to " << metricsPath << "\n";
+        return status ? status : 1;
+    }
+    return status;
+}
+
+void printUsage() {
+    std::cerr << "usage: pathfinder_cli [--graph nodes.json] [--json] [--query FROM TO]..."
+                 " [--file PATH] [--stdin] [--threads N]\n"
+                 "       pathfinder_cli [--graph nodes.json] --matrix all|A,B,..."
+                 " [--matrix-out PATH] [--threads N]\n"
+                 "       both accept --order hilbert|bfs|rcm, --trace PATH and --metrics PATH\n"
+                 "       both accept --engine dijkstra|hub, --hub-labels PATH and --save-hub-labels PATH;\n"
+                 "       path queries also accept --engine alt|cch|overlay, --landmarks N and\n"
+                 "       --landmark-strategy farthest|avoid; dijkstra and alt accept --arc-flags N,\n"
+                 "       or --depart HH:MM with --profiles PATH for time-dependent travel times;\n"
+                 "       plain dijkstra also accepts --u-turn-cost X, --alternatives N\n"
+                 "       or --k-shortest K\n"
+                 "FROM/TO: destination index (3) or node id (n12)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string graphPath = "nodes.json";
+    bool json = false;
+    bool useStdin = false;
+    std::vector<Query> queries;
+    std::vector<std::string> files;
+    std::string matrixSpec;
+    std::string matrixOut = "-";
+    unsigned threads = 0;
+    NodeOrder order = NodeOrder::Input;
+    std::string engine = "dijkstra";
+    int landmarkCount = 16;
+    LandmarkStrategy landmarkStrategy = LandmarkStrategy::Avoid;
+    int regionCount = 0;
+    float departure = -1;
+    std::string profilesPath;
+    float uTurnCost = 0;
+    int alternativeCount = 0;
+    int pathCount = 0;
+    std::string hubLabelsPath, saveHubLabelsPath;
+    std::string tracePath = traceOutputFromEnvironment();
+    std::string metricsPath = metricsOutputFromEnvironment();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--graph" && i + 1 < argc) graphPath = argv[++i];
+        else if (arg == "--json") json = true;
+        else if (arg == "--query" && i + 2 < argc) {
+            queries.push_back(Query{argv[i + 1], argv[i + 2]});
+            i += 2;
+        }
+        else if (arg == "--file" && i + 1 < argc) files.push_back(argv[++i]);
+        else if (arg == "--stdin" || arg == "-") useStdin = true;
+        else if (arg == "--matrix" && i + 1 < argc) matrixSpec = argv[++i];
+        else if (arg == "--matrix-out" && i + 1 < argc) matrixOut = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--order" && i + 1 < argc && parseNodeOrder(argv[i + 1], order)) ++i;
+        else if (arg == "--engine" && i + 1 < argc) engine = argv[++i];
+        else if (arg == "--landmarks" && i + 1 < argc) landmarkCount = std::atoi(argv[++i]);
+        else if (arg == "--landmark-strategy" && i + 1 < argc && parseLandmarkStrategy(argv[i + 1], landmarkStrategy))
+            ++i;
+        else if (arg == "--arc-flags" && i + 1 < argc) regionCount = std::atoi(argv[++i]);
+        else if (arg == "--depart" && i + 1 < argc && parseTimeOfDay(argv[i + 1], departure)) ++i;
+        else if (arg == "--profiles" && i + 1 < argc) profilesPath = argv[++i];
+        else if (arg == "--u-turn-cost" && i + 1 < argc) uTurnCost = std::strtof(argv[++i], nullptr);
+        else if (arg == "--alternatives" && i + 1 < argc) alternativeCount = std::atoi(argv[++i]);
+        else if (arg == "--k-shortest" && i + 1 < argc) pathCount = std::atoi(argv[++i]);
+        else if (arg == "--hub-labels" && i + 1 < argc) hubLabelsPath = argv[++i];
+        else if (arg == "--save-hub-labels" && i + 1 < argc) saveHubLabelsPath = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg == "--metrics" && i + 1 < argc) metricsPath = argv[++i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if ((engine != "dijkstra" && engine != "alt" && engine != "hub" && engine != "cch" &&
+         engine != "overlay") ||
+        ((regionCount > 0 || departure >= 0) && engine != "dijkstra" && engine != "alt") ||
+        (regionCount > 0 && departure >= 0) || (!profilesPath.empty() && departure < 0) ||
+        (uTurnCost != 0 && (engine != "dijkstra" || regionCount > 0 || departure >= 0 || !matrixSpec.empty())) ||
+        ((alternativeCount > 0 || pathCount > 0) && (engine != "dijkstra" || regionCount > 0 || departure >= 0 ||
+                                                     uTurnCost != 0 || !matrixSpec.empty())) ||
+        (alternativeCount > 0 && pathCount > 0)) {
+        printUsage();
+        return 1;
+    }
+    if (queries.empty() && files.empty() && matrixSpec.empty()) useStdin = true;
+    TraceSession trace(tracePath);
+    setTraceThreadName("main");
+
+    for (const auto& file : files) {
+        std::ifstream in(file);
+        if (!in) {
+            std::cerr << "Cannot open " << file << "\n";
+            return 1;
+        }
+        if (!readQueries(in, file, queries)) return 1;
+    }
+    if (useStdin && !readQueries(std::cin, "<stdin>", queries)) return 1;
+
+    std::vector<Node> destinationNodes, roadNodes;
+    std::vector<Edge> edges;
+    std::vector<Turn> turns;
+    if (!loadFromFile(destinationNodes, roadNodes, edges, turns, graphPath)) {
+        std::cerr << "Cannot load graph " << graphPath << "\n";
+        return 1;
+    }
+    Graph graph = buildGraph(destinationNodes, roadNodes, edges);
+    // Endpoints resolve against graph; searches run on the renumbered copy
+    std::unique_ptr<ReorderedGraph> reordered;
+    if (order != NodeOrder::Input) reordered = std::make_unique<ReorderedGraph>(reorderGraph(graph, order));
+    const Graph& searchGraph = reordered ? reordered->graph : graph;
+    HubLabels labels;
+    if (engine == "hub" && !prepareHubLabels(searchGraph, hubLabelsPath, saveHubLabelsPath, labels)) return 1;
+    const bool edgeBased = engine == "dijkstra" && regionCount == 0 && departure < 0 && alternativeCount == 0 &&
+                           pathCount == 0 && matrixSpec.empty();
+    if (!turns.empty() && !edgeBased) {
+        std::cerr << "Only path queries of plain --engine dijkstra honour the " << turns.size() << " turns in "
+                  << graphPath << "\n";
+    }
+    if (!matrixSpec.empty()) {
+        return finish(runMatrix(graph, matrixSpec, matrixOut, threads, reordered.get(),
+                                engine == "hub" ? &labels : nullptr), metricsPath);
+    }
+
+    // Resolve everything first so the searches can run as one batch
+    std::vector<std::pair<int, int>> batch;
+    std::vector<int> slot(queries.size(), -1);
+    int failures = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        int source = resolveEndpoint(queries[i].from, graph);
+        int target = resolveEndpoint(queries[i].to, graph);
+        if (source < 0 || target < 0) continue;
+        slot[i] = static_cast<int>(batch.size());
+        if (reordered) batch.emplace_back(reordered->toInternal[source], reordered->toInternal[target]);
+        else batch.emplace_back(source, target);
+    }
+    ThreadPool pool(threads);
+    QueryEngine run;
+    LandmarkIndex landmarks;
+    CchTopology hierarchy;
+    CchMetric hierarchyMetric;
+    OverlayGraph overlay;
+    ArcFlags arcFlags;
+    TurnCosts turnCosts;
+    if (regionCount > 0) arcFlags = buildArcFlags(searchGraph, regionCount, pool);
+    TravelTimeProfiles profiles = defaultTravelTimeProfiles();
+    if (departure >= 0) {
+        if (!profilesPath.empty()) {
+            // Arcs are named by node ids, which the search graph may have renumbered
+            std::vector<ArcProfile> arcProfiles;
+            if (!loadTravelTimeProfiles(profilesPath, profiles, &arcProfiles)) return 1;
+            for (ArcProfile& arc : arcProfiles) {
+                if (!reordered || arc.from < 0 || arc.from >= graph.nodeCount() || arc.to < 0 ||
+                    arc.to >= graph.nodeCount())
+                    continue;
+                arc.from = reordered->toInternal[arc.from];
+                arc.to = reordered->toInternal[arc.to];
+            }
+            if (!arcProfiles.empty() && !setArcProfiles(profiles, searchGraph, arcProfiles)) return 1;
+        }
+        if (!checkFifo(searchGraph, profiles)) std::cerr << "Travel times may not be the earliest arrivals\n";
+        if (engine == "alt") {
+            landmarks = buildLandmarkIndex(lowerBoundGraph(searchGraph, profiles), landmarkCount, landmarkStrategy,
+                                           pool);
+        }
+        run = [&](int source, int target, SearchContext& context) {
+            return timeDependentShortestPath(searchGraph, profiles, source, target, departure, context,
+                                             engine == "alt" ? &landmarks : nullptr);
+        };
+    } else if (engine == "alt") {
+        landmarks = buildLandmarkIndex(searchGraph, landmarkCount, landmarkStrategy, pool);
+        run = [&](int source, int target, SearchContext& context) {
+            return altShortestPath(searchGraph, landmarks, source, target, context, nullptr,
+                                   regionCount > 0 ? &arcFlags : nullptr);
+        };
+    } else if (edgeBased && (!turns.empty() || uTurnCost != 0)) {
+        turnCosts = buildTurnCosts(searchGraph, turns, uTurnCost);
+        run = [&](int source, int target, SearchContext& context) {
+            return turnAwareShortestPath(searchGraph, turnCosts, source, target, context);
+        };
+    } else if (engine == "dijkstra" && regionCount > 0) {
+        run = [&](int source, int target, SearchContext& context) {
+            return arcFlagsShortestPath(searchGraph, arcFlags, source, target, context);
+        };
+    } else if (engine == "hub") {
+        run = [&](int source, int target, SearchContext&) { return hubShortestPath(labels, source, target); };
+    } else if (engine == "cch") {
+        hierarchy = buildCchTopology(searchGraph);
+        hierarchyMetric = customizeCch(hierarchy, searchGraph, pool);
+        run = [&](int source, int target, SearchContext&) {
+            thread_local CchQueryContext cchContext;
+            return cchShortestPath(hierarchy, hierarchyMetric, source, target, cchContext);
+        };
+    } else if (engine == "overlay") {
+        overlay = buildOverlay(searchGraph, pool);
+        run = [&](int source, int target, SearchContext& context) {
+            return overlayShortestPath(searchGraph, overlay, source, target, context);
+        };
+    }
+    // Further routes per batch entry, after its answer
+    std::vector<std::vector<PathResult>> further(batch.size());
+    std::vector<PathResult> answers;
+    if (pathCount > 0) {
+        // Each query's spurs already spread over the pool
+        Graph reversed = reverseGraph(searchGraph);
+        KShortestSearch search;
+        answers.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            std::vector<PathResult> paths =
+                kShortestPaths(searchGraph, reversed, batch[i].first, batch[i].second, pathCount, search, pool);
+            if (paths.empty()) continue;
+            answers[i] = std::move(paths[0]);
+            further[i].assign(std::make_move_iterator(paths.begin() + 1), std::make_move_iterator(paths.end()));
+        }
+    } else if (alternativeCount > 0) {
+        Graph reversed = reverseGraph(searchGraph);
+        AlternativeOptions options;
+        options.maxRoutes = alternativeCount;
+        std::vector<AlternativeSearch> searches(pool.size());
+        answers.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            pool.submit([&, i] {
+                AlternativeSearch& search = searches[ThreadPool::workerIndex()];
+                std::vector<PathResult> routes =
+                    alternativeRoutes(searchGraph, reversed, batch[i].first, batch[i].second, search, options);
+                if (routes.empty()) return;
+                answers[i] = std::move(routes[0]);
+                further[i].assign(std::make_move_iterator(routes.begin() + 1),
+                                       std::make_move_iterator(routes.end()));
+            });
+        }
+        pool.wait();
+    } else {
+        answers = BatchQueryRunner(searchGraph, pool, run).run(batch);
+    }
+    if (reordered) {
+        for (PathResult& answer : answers) {
+            for (int& v : answer.path) v = reordered->toEditor[v];
+        }
+        for (auto& routes : further) {
+            for (PathResult& route : routes) {
+                for (int& v : route.path) v = reordered->toEditor[v];
+            }
+        }
+    }
+
+    nlohmann::json results = nlohmann::json::array();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const Query& q = queries[i];
+        if (slot[i] < 0) {
+            std::cerr << "Unknown endpoint in query \"" << q.from << " " << q.to << "\"\n";
+            ++failures;
+            continue;
+        }
+        const PathResult& result = answers[slot[i]];
+        const auto& others = further[slot[i]];
+        bool reachable = result.distance != kInfinity;
+
+        if (json) {
+            auto routeJson = [&](const PathResult& route) {
+                nlohmann::json entry;
+                entry["distance"] = route.distance != kInfinity ? nlohmann::json(route.distance) : nlohmann::json(nullptr);
+                entry["path"] = nlohmann::json::array();
+                entry["points"] = nlohmann::json::array();
+                for (int v : route.path) {
+                    entry["path"].push_back(v);
+                    entry["points"].push_back({graph.positions[v].x, graph.positions[v].y});
+                }
+                return entry;
+            };
+            nlohmann::json entry = routeJson(result);
+            entry["from"] = q.from;
+            entry["to"] = q.to;
+            if (alternativeCount > 0 || pathCount > 0) {
+                const char* key = pathCount > 0 ? "next_paths" : "alternatives";
+                entry[key] = nlohmann::json::array();
+                for (const PathResult& route : others) entry[key].push_back(routeJson(route));
+            }
+            results.push_back(entry);
+        } else if (reachable) {
+            std::printf("%s -> %s: %.3f via", q.from.c_str(), q.to.c_str(), result.distance);
+            for (int v : result.path) std::printf(" n%d", v);
+            std::printf("\n");
+            for (size_t r = 0; r < others.size(); ++r) {
+                if (pathCount > 0) std::printf("  path %zu: %.3f via", r + 2, others[r].distance);
+                else std::printf("  alternative %zu: %.3f via", r + 1, others[r].distance);
+                for (int v : others[r].path) std::printf(" n%d", v);
+                std::printf("\n");
+            }
+        } else {
+            std::printf("%s -> %s: unreachable\n", q.from.c_str(), q.to.c_str());
+        }
+    }
+    if (json) std::cout << results.dump(2) << "\n";
+    return finish(failures ? 2 : 0, metricsPath);
+}
@@ -0,0 +1,308 @@
+#include "pathfinder/alt.hpp"
+#include "pathfinder/arc_flags.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <utility>
+
+namespace {
+
+bool stopRequested(const std::atomic<bool>* cancel) {
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+// d(source, v) for every node, kInfinity where unreachable
+std::vector<float> distancesFrom(const Graph& graph, int source, SearchContext& context) {
+    shortestPathTree(graph, source, context);
+    std::vector<float> column(graph.nodeCount(), kInfinity);
+    for (int v : context.touched) column[v] = context.dist[v];
+    return column;
+}
+
+// A random node of the component with the most nodes (as reached by
+// following arcs), so landmarks are not wasted on isolated nodes
+int randomNodeInLargestComponent(const Graph& graph, std::mt19937& rng) {
+    const int n = graph.nodeCount();
+    std::vector<int> component(n, -1);
+    std::vector<int> queue;
+    int bestStart = 0;
+    size_t bestSize = 0;
+    std::vector<int> bestMembers;
+    for (int start = 0; start < n; ++start) {
+        if (component[start] != -1) continue;
+        queue.assign(1, start);
+        component[start] = start;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int u = queue[head];
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                int v = graph.target[e];
+                if (component[v] == -1) {
+                    component[v] = start;
+                    queue.push_back(v);
+                }
+            }
+        }
+        if (queue.size() > bestSize) {
+            bestSize = queue.size();
+            bestStart = start;
+            bestMembers.swap(queue);
+        }
+    }
+    if (bestMembers.empty()) return bestStart;
+    return bestMembers[std::uniform_int_distribution<size_t>(0, bestMembers.size() - 1)(rng)];
+}
+
+// Index of the largest finite value, or -1 if none is above zero
+int farthestNode(const std::vector<float>& distance) {
+    int best = -1;
+    float bestDistance = 0;
+    for (int v = 0; v < static_cast<int>(distance.size()); ++v) {
+        if (distance[v] != kInfinity && distance[v] > bestDistance) {
+            bestDistance = distance[v];
+            best = v;
+        }
+    }
+    return best;
+}
+
+// Leaf of a shortest path tree from a random root, reached by starting at
+// the landmark-free subtree whose nodes the chosen landmarks bound worst and
+// descending into its worst child; -1 if no such subtree is left. Only
+// forward distances are used: d(L, v) - d(L, r) <= d(r, v) holds on directed
+// graphs too.
+int avoidCandidate(const Graph& graph, const std::vector<std::vector<float>>& columns,
+                   const std::vector<char>& isLandmark, std::mt19937& rng, SearchContext& context) {
+    const int n = graph.nodeCount();
+    // Roots come from the part of the graph the first landmark reaches
+    const std::vector<float>& reach = columns.front();
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    int root = -1;
+    for (int attempt = 0; attempt < 64 && root < 0; ++attempt) {
+        int candidate = pick(rng);
+        if (reach[candidate] != kInfinity) root = candidate;
+    }
+    if (root < 0) return -1;
+
+    shortestPathTree(graph, root, context);
+    const std::vector<int>& nodes = context.touched;
+
+    // Children lists of the search tree, then a parent-before-child order
+    std::vector<int> childCount(n + 1, 0);
+    for (int v : nodes) {
+        if (context.prev[v] != -1) ++childCount[context.prev[v] + 1];
+    }
+    for (int i = 0; i < n; ++i) childCount[i + 1] += childCount[i];
+    std::vector<int> children(nodes.size());
+    std::vector<int> fill(childCount.begin(), childCount.end() - 1);
+    for (int v : nodes) {
+        if (context.prev[v] != -1) children[fill[context.prev[v]]++] = v;
+    }
+    std::vector<int> order{root};
+    for (size_t head = 0; head < order.size(); ++head) {
+        int u = order[head];
+        order.insert(order.end(), children.begin() + childCount[u], children.begin() + childCount[u + 1]);
+    }
+
+    // size(v): how much the current bounds underestimate d(root, .) over v's
+    // subtree, zero for subtrees that contain a landmark
+    std::vector<double> size(n, 0.0);
+    std::vector<char> covered(n, 0);
+    std::vector<int> bestChild(n, -1);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        int v = *it;
+        float lowerBound = 0;
+        for (const auto& column : columns) {
+            if (column[v] != kInfinity && column[root] != kInfinity)
+                lowerBound = std::max(lowerBound, column[v] - column[root]);
+        }
+        size[v] += std::max(0.0f, context.dist[v] - lowerBound);
+        if (isLandmark[v]) covered[v] = 1;
+        if (covered[v]) size[v] = 0;
+        int parent = context.prev[v];
+        if (parent == -1) continue;
+        if (covered[v]) covered[parent] = 1;
+        size[parent] += size[v];
+        if (size[v] > 0 && (bestChild[parent] == -1 || size[v] > size[bestChild[parent]])) bestChild[parent] = v;
+    }
+    int v = *std::max_element(nodes.begin(), nodes.end(), [&](int a, int b) { return size[a] < size[b]; });
+    if (size[v] <= 0) return -1;
+    while (bestChild[v] != -1) v = bestChild[v];
+    return isLandmark[v] ? -1 : v;
+}
+
+// Also leaves d(chosen[i], .) in columns[i], which the index reuses. Stops
+// early, possibly with fewer landmarks, once *cancel is true.
+std::vector<int> selectLandmarks(const Graph& graph, int count, LandmarkStrategy strategy, unsigned seed,
+                                 std::vector<std::vector<float>>& columns, const std::atomic<bool>* cancel) {
+    TRACE_SCOPE_CATEGORY("build", "selectLandmarks");
+    const int n = graph.nodeCount();
+    std::vector<int> chosen;
+    columns.clear();
+    if (n == 0 || count <= 0) return chosen;
+    std::mt19937 rng(seed);
+    SearchContext context;
+
+    // The first landmark is the node farthest from a random one, on the rim
+    int start = randomNodeInLargestComponent(graph, rng);
+    int next = farthestNode(distancesFrom(graph, start, context));
+    if (next < 0) next = start;
+
+    std::vector<float> nearest(n, kInfinity); // distance from the closest landmark
+    std::vector<char> isLandmark(n, 0);
+    while (next >= 0 && static_cast<int>(chosen.size()) < count && !stopRequested(cancel)) {
+        chosen.push_back(next);
+        isLandmark[next] = 1;
+        columns.push_back(distancesFrom(graph, next, context));
+        for (int v = 0; v < n; ++v) nearest[v] = std::min(nearest[v], columns.back()[v]);
+
+        next = -1;
+        if (strategy == LandmarkStrategy::Avoid) next = avoidCandidate(graph, columns, isLandmark, rng, context);
+        if (next < 0) next = farthestNode(nearest);
+    }
+    return chosen;
+}
+
+// Fills the index from columns[0, k) = d(L, .) and columns[k, 2k) = d(., L),
+// first running the searches for the columns that are still empty. One
+// search per task into its own column; interleaving afterwards keeps the
+// workers from writing to shared cache lines. Searches not yet started are
+// skipped once *cancel is true, and index is then left as it was.
+bool fillDistances(const Graph& graph, LandmarkIndex& index, std::vector<std::vector<float>>& columns,
+                   ThreadPool& pool, const std::atomic<bool>* cancel) {
+    const int n = graph.nodeCount();
+    const int k = index.count();
+    columns.resize(2 * k);
+    Graph reversed = reverseGraph(graph);
+    std::vector<SearchContext> contexts(pool.size());
+    for (int job = 0; job < 2 * k; ++job) {
+        if (!columns[job].empty()) continue;
+        pool.submit([&, job] {
+            if (stopRequested(cancel)) return;
+            const Graph& searched = job < k ? graph : reversed;
+            columns[job] = distancesFrom(searched, index.landmarks[job % k], contexts[ThreadPool::workerIndex()]);
+        });
+    }
+    pool.wait();
+    if (stopRequested(cancel)) return false;
+
+    index.fromLandmark.assign(static_cast<size_t>(n) * k, kInfinity);
+    index.toLandmark.assign(static_cast<size_t>(n) * k, kInfinity);
+    for (int v = 0; v < n; ++v) {
+        for (int i = 0; i < k; ++i) {
+            index.fromLandmark[static_cast<size_t>(v) * k + i] = columns[i][v];
+            index.toLandmark[static_cast<size_t>(v) * k + i] = columns[k + i][v];
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool parseLandmarkStrategy(const std::string& text, LandmarkStrategy& strategy) {
+    if (text == "farthest") strategy = LandmarkStrategy::Farthest;
+    else if (text == "avoid") strategy = LandmarkStrategy::Avoid;
+    else return false;
+    return true;
+}
+
+LandmarkPotential::LandmarkPotential(const LandmarkIndex& index, int source, int target)
+    : from_(index.fromLandmark.data()), to_(index.toLandmark.data()), k_(index.count()), target_(target) {
+    // Search with the landmarks that bound this query best
+    std::pair<float, int> ranked[kMaxLandmarks];
+    int rankedCount = std::min(k_, kMaxLandmarks);
+    for (int i = 0; i < rankedCount; ++i) ranked[i] = {boundVia(i, source), i};
+    int keep = std::min(rankedCount, kActiveLandmarks);
+    std::partial_sort(ranked, ranked + keep, ranked + rankedCount, std::greater<std::pair<float, int>>());
+    for (int j = 0; j < keep; ++j) active_[activeCount_++] = ranked[j].second;
+}
+
+LandmarkIndex buildLandmarkIndex(const Graph& graph, int count, LandmarkStrategy strategy, ThreadPool& pool,
+                                 unsigned seed, const std::atomic<bool>* cancel) {
+    TRACE_SCOPE_CATEGORY("build", "buildLandmarkIndex");
+    LandmarkIndex index;
+    std::vector<std::vector<float>> columns;
+    index.landmarks = selectLandmarks(graph, std::min(count, kMaxLandmarks), strategy, seed, columns, cancel);
+    if (!fillDistances(graph, index, columns, pool, cancel)) return LandmarkIndex();
+    return index;
+}
+
+bool updateLandmarkDistances(const Graph& graph, LandmarkIndex& index, ThreadPool& pool,
+                             const std::atomic<bool>* cancel) {
+    TRACE_SCOPE_CATEGORY("build", "updateLandmarkDistances");
+    std::vector<std::vector<float>> columns;
+    return fillDistances(graph, index, columns, pool, cancel);
+}
+
+PathResult altShortestPath(const Graph& graph, const LandmarkIndex& index, int source, int target,
+                           SearchContext& context, const SearchControl* control, const ArcFlags* flags) {
+    TRACE_SCOPE_CATEGORY("query", "altShortestPath");
+    static QueryMetrics& metrics = queryMetrics("alt");
+    auto queryStart = MetricsClock::now();
+    const LandmarkPotential potential(index, source, target);
+
+    const int targetRegion = flags ? flags->region[target] : 0;
+
+    context.prepare(graph.nodeCount());
+    auto& heap = context.heap;
+    auto greater = std::greater<std::pair<float, int>>();
+    context.dist[source] = 0;
+    context.potential[source] = potential(source);
+    context.touched.push_back(source);
+    heap.emplace_back(context.potential[source], source);
+    int settled = 0, relaxed = 0, pushes = 1, pops = 0;
+    int untilCheck = kProgressInterval;
+    bool cancelled = false;
+
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [key, u] = heap.back();
+        heap.pop_back();
+        ++pops;
+        float d = context.dist[u];
+        if (key > d + context.potential[u]) continue;
+        ++settled;
+        if (u == target) break;
+        if (control && --untilCheck <= 0) {
+            untilCheck = kProgressInterval;
+            if (control->cancel && control->cancel->load(std::memory_order_relaxed)) {
+                cancelled = true;
+                break;
+            }
+            if (control->progress) {
+                context.stats = QueryStats{settled, relaxed, pushes, pops};
+                control->progress(context);
+            }
+        }
+        relaxed += graph.firstEdge[u + 1] - graph.firstEdge[u];
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            if (flags && !flags->allows(e, targetRegion)) continue;
+            int v = graph.target[e];
+            float alt = d + graph.weight[e];
+            if (alt < context.dist[v]) {
+                if (context.dist[v] == kInfinity) {
+                    context.touched.push_back(v);
+                    context.potential[v] = potential(v);
+                }
+                context.dist[v] = alt;
+                context.prev[v] = u;
+                heap.emplace_back(alt + context.potential[v], v);
+                std::push_heap(heap.begin(), heap.end(), greater);
+                ++pushes;
+            }
+        }
+    }
+    context.stats = QueryStats{settled, relaxed, pushes, pops};
+
+    if (cancelled) {
+        PathResult result;
+        result.stats = context.stats;
+        result.cancelled = true;
+        return result;
+    }
+    PathResult result = collectPath(target, context);
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
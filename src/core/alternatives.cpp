@@ -0,0 +1,197 @@
+#include "pathfinder/alternatives.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+using Plateau = AlternativeSearch::Plateau;
+
+uint64_t arcKey(int from, int to) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) | static_cast<uint32_t>(to);
+}
+
+} // namespace
+
+std::vector<PathResult> alternativeRoutes(const Graph& graph, const Graph& reversed, int source, int target,
+                                          AlternativeSearch& search, const AlternativeOptions& options,
+                                          const SearchControl* control) {
+    TRACE_SCOPE_CATEGORY("query", "alternativeRoutes");
+    static QueryMetrics& metrics = queryMetrics("alternatives");
+    auto queryStart = MetricsClock::now();
+    const int n = graph.nodeCount();
+    const float stretch = std::max(options.maxStretch, 1.0f);
+    SearchContext& forward = search.forward;
+    SearchContext& backward = search.backward;
+    SearchContext* sides[2] = {&forward, &backward};
+    const Graph* graphs[2] = {&graph, &reversed};
+    auto greater = std::greater<std::pair<float, int>>();
+
+    const int ends[2] = {source, target};
+    for (int side = 0; side < 2; ++side) {
+        SearchContext& context = *sides[side];
+        context.prepare(n);
+        context.dist[ends[side]] = 0;
+        context.touched.push_back(ends[side]);
+        context.heap.emplace_back(0.0f, ends[side]);
+    }
+    search.forwardOrder.clear();
+    if (search.plateau.size() != static_cast<size_t>(n)) search.plateau.assign(n, -1);
+
+    // Each side runs until its next key passes stretch times the best
+    // meeting cost. Nodes below that key are settled, nodes at or above it
+    // may not be.
+    float radius[2] = {kInfinity, kInfinity};
+    bool active[2] = {true, true};
+    float best = kInfinity;
+    int meet = -1;
+    int settled = 0, relaxed = 0, pushes = 2, pops = 0;
+    int untilCheck = kProgressInterval;
+    bool cancelled = false;
+    while (true) {
+        for (int side = 0; side < 2; ++side) {
+            const auto& heap = sides[side]->heap;
+            if (active[side] && (heap.empty() || heap.front().first > stretch * best)) {
+                radius[side] = heap.empty() ? kInfinity : heap.front().first;
+                active[side] = false;
+            }
+        }
+        if (!active[0] && !active[1]) break;
+        // Grow the side whose next node is closer
+        int side = !active[1] || (active[0] && forward.heap.front().first <= backward.heap.front().first) ? 0 : 1;
+        SearchContext& context = *sides[side];
+        const SearchContext& other = *sides[1 - side];
+        auto& heap = context.heap;
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [d, u] = heap.back();
+        heap.pop_back();
+        ++pops;
+        if (d > context.dist[u]) continue;
+        ++settled;
+        // Counted over both sides, which grow in turn
+        if (control && --untilCheck <= 0) {
+            untilCheck = kProgressInterval;
+            if (control->cancel && control->cancel->load(std::memory_order_relaxed)) {
+                cancelled = true;
+                break;
+            }
+            if (control->progress) {
+                forward.stats = QueryStats{settled, relaxed, pushes, pops};
+                control->progress(forward);
+            }
+        }
+        if (side == 0) search.forwardOrder.push_back(u);
+        if (d + other.dist[u] < best) {
+            best = d + other.dist[u];
+            meet = u;
+        }
+        const Graph& g = *graphs[side];
+        for (int e = g.firstEdge[u]; e < g.firstEdge[u + 1]; ++e) {
+            ++relaxed;
+            int v = g.target[e];
+            float alt = d + g.weight[e];
+            if (alt < context.dist[v]) {
+                if (context.dist[v] == kInfinity) context.touched.push_back(v);
+                context.dist[v] = alt;
+                context.prev[v] = u;
+                heap.emplace_back(alt, v);
+                std::push_heap(heap.begin(), heap.end(), greater);
+                ++pushes;
+                if (alt + other.dist[v] < best) {
+                    best = alt + other.dist[v];
+                    meet = v;
+                }
+            }
+        }
+    }
+    const QueryStats stats{settled, relaxed, pushes, pops};
+    forward.stats = backward.stats = stats;
+
+    std::vector<PathResult> routes;
+    if (cancelled) {
+        PathResult route;
+        route.stats = stats;
+        route.cancelled = true;
+        routes.push_back(std::move(route));
+        return routes;
+    }
+    if (meet < 0) {
+        metrics.record(MetricsClock::now() - queryStart, stats, false);
+        return routes;
+    }
+
+    // Plateaus among the nodes both sides settled. In forward order a
+    // node continues its forward parent's plateau when the backward tree
+    // takes the same arc.
+    std::vector<Plateau>& plateaus = search.plateaus;
+    plateaus.clear();
+    for (int v : search.forwardOrder) {
+        if (!(backward.dist[v] < radius[1])) continue;
+        float cost = forward.dist[v] + backward.dist[v];
+        if (cost > stretch * best) continue;
+        int u = forward.prev[v];
+        if (u >= 0 && search.plateau[u] >= 0 && backward.prev[u] == v) {
+            search.plateau[v] = search.plateau[u];
+            plateaus[search.plateau[v]].end = v;
+        } else {
+            search.plateau[v] = static_cast<int>(plateaus.size());
+            plateaus.push_back(Plateau{v, v, cost});
+        }
+    }
+    for (int v : search.forwardOrder) search.plateau[v] = -1;
+    auto length = [&](const Plateau& p) { return forward.dist[p.end] - forward.dist[p.start]; };
+    plateaus.erase(std::remove_if(plateaus.begin(), plateaus.end(), [&](const Plateau& p) {
+        return length(p) < options.minPlateau * best;
+    }), plateaus.end());
+    std::sort(plateaus.begin(), plateaus.end(), [&](const Plateau& a, const Plateau& b) {
+        return a.cost - length(a) < b.cost - length(b);
+    });
+
+    // Source to via in the forward tree, then on to the target in the
+    // backward one; legs[i] is the cost from path[i] to path[i + 1]
+    std::vector<int>& path = search.path;
+    std::vector<float>& legs = search.legs;
+    auto routeVia = [&](int via) {
+        path.clear();
+        legs.clear();
+        for (int v = via; v != -1; v = forward.prev[v]) path.push_back(v);
+        std::reverse(path.begin(), path.end());
+        for (size_t i = 1; i < path.size(); ++i) legs.push_back(forward.dist[path[i]] - forward.dist[path[i - 1]]);
+        for (int v = via; backward.prev[v] != -1; v = backward.prev[v]) {
+            path.push_back(backward.prev[v]);
+            legs.push_back(backward.dist[v] - backward.dist[backward.prev[v]]);
+        }
+    };
+    std::vector<uint64_t>& taken = search.taken;
+    taken.clear();
+    auto accept = [&](float cost) {
+        PathResult route;
+        route.distance = cost;
+        route.path = path;
+        route.stats = stats;
+        routes.push_back(std::move(route));
+        for (size_t i = 1; i < path.size(); ++i) taken.push_back(arcKey(path[i - 1], path[i]));
+        std::sort(taken.begin(), taken.end());
+    };
+
+    routeVia(meet);
+    accept(best);
+    std::vector<int>& visited = search.visited;
+    for (const Plateau& p : plateaus) {
+        if (static_cast<int>(routes.size()) >= options.maxRoutes || best == 0) break;
+        routeVia(p.start);
+        float shared = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            if (std::binary_search(taken.begin(), taken.end(), arcKey(path[i - 1], path[i]))) shared += legs[i - 1];
+        }
+        if (shared > options.maxSharing * best) continue;
+        visited.assign(path.begin(), path.end());
+        std::sort(visited.begin(), visited.end());
+        if (std::adjacent_find(visited.begin(), visited.end()) != visited.end()) continue;
+        accept(p.cost);
+    }
+    metrics.record(MetricsClock::now() - queryStart, stats, true);
+    return routes;
+}
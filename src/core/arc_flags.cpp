@@ -0,0 +1,140 @@
+#include "pathfinder/arc_flags.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+namespace {
+
+// Deals regions [firstRegion, firstRegion + count) out to nodes
+void splitRegions(const Graph& graph, std::vector<int>& nodes, int firstRegion, int count,
+                  std::vector<int>& region) {
+    if (count <= 1 || nodes.size() <= 1) {
+        for (int v : nodes) region[v] = firstRegion;
+        return;
+    }
+    float minX = graph.positions[nodes[0]].x, maxX = minX;
+    float minY = graph.positions[nodes[0]].y, maxY = minY;
+    for (int v : nodes) {
+        minX = std::min(minX, graph.positions[v].x);
+        maxX = std::max(maxX, graph.positions[v].x);
+        minY = std::min(minY, graph.positions[v].y);
+        maxY = std::max(maxY, graph.positions[v].y);
+    }
+    bool alongX = maxX - minX >= maxY - minY;
+    int lowerCount = count / 2;
+    auto middle = nodes.begin() + static_cast<std::ptrdiff_t>(nodes.size() * lowerCount / count);
+    std::nth_element(nodes.begin(), middle, nodes.end(), [&](int a, int b) {
+        return alongX ? graph.positions[a].x < graph.positions[b].x : graph.positions[a].y < graph.positions[b].y;
+    });
+    std::vector<int> upper(middle, nodes.end());
+    nodes.erase(middle, nodes.end());
+    splitRegions(graph, nodes, firstRegion, lowerCount, region);
+    splitRegions(graph, upper, firstRegion + lowerCount, count - lowerCount, region);
+}
+
+} // namespace
+
+std::vector<int> kdRegions(const Graph& graph, int regionCount) {
+    const int n = graph.nodeCount();
+    std::vector<int> region(n, 0);
+    std::vector<int> nodes(n);
+    for (int v = 0; v < n; ++v) nodes[v] = v;
+    splitRegions(graph, nodes, 0, std::clamp(regionCount, 1, kMaxRegions), region);
+    return region;
+}
+
+ArcFlags buildArcFlags(const Graph& graph, int regionCount, ThreadPool& pool) {
+    TRACE_SCOPE_CATEGORY("build", "buildArcFlags");
+    const int n = graph.nodeCount();
+    ArcFlags flags;
+    flags.regionCount = std::clamp(regionCount, 1, kMaxRegions);
+    flags.region = kdRegions(graph, flags.regionCount);
+    flags.fingerprint = topologyFingerprint(graph);
+
+    // Arcs inside a region lead into it; arcs entering one mark a boundary node
+    std::vector<std::atomic<uint64_t>> shared(graph.target.size());
+    std::vector<char> isBoundary(n, 0);
+    for (int u = 0; u < n; ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            int v = graph.target[e];
+            if (flags.region[u] == flags.region[v]) shared[e].store(1ull << flags.region[v], std::memory_order_relaxed);
+            else isBoundary[v] = 1;
+        }
+    }
+
+    // Each boundary node's tree on the reversed graph gives, for every node,
+    // its first arc on a shortest path to the boundary node
+    Graph reversed = reverseGraph(graph);
+    std::vector<SearchContext> contexts(pool.size());
+    for (int b = 0; b < n; ++b) {
+        if (!isBoundary[b]) continue;
+        pool.submit([&, b] {
+            SearchContext& context = contexts[ThreadPool::workerIndex()];
+            shortestPathTree(reversed, b, context);
+            uint64_t bit = 1ull << flags.region[b];
+            for (int u : context.touched) {
+                int v = context.prev[u];
+                if (v < 0) continue;
+                // The arc u -> v the tree took: the one its distance came from
+                for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                    if (graph.target[e] == v && context.dist[v] + graph.weight[e] == context.dist[u]) {
+                        shared[e].fetch_or(bit, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    flags.flags.resize(shared.size());
+    for (size_t e = 0; e < shared.size(); ++e) flags.flags[e] = shared[e].load(std::memory_order_relaxed);
+    return flags;
+}
+
+PathResult arcFlagsShortestPath(const Graph& graph, const ArcFlags& flags, int source, int target,
+                                SearchContext& context) {
+    TRACE_SCOPE_CATEGORY("query", "arcFlagsShortestPath");
+    static QueryMetrics& metrics = queryMetrics("arc_flags");
+    auto queryStart = MetricsClock::now();
+    const int targetRegion = flags.region[target];
+
+    context.prepare(graph.nodeCount());
+    auto& heap = context.heap;
+    auto greater = std::greater<std::pair<float, int>>();
+    context.dist[source] = 0;
+    context.touched.push_back(source);
+    heap.emplace_back(0.0f, source);
+    int settled = 0, relaxed = 0, pushes = 1, pops = 0;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [d, u] = heap.back();
+        heap.pop_back();
+        ++pops;
+        if (d > context.dist[u]) continue;
+        ++settled;
+        if (u == target) break;
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            if (!flags.allows(e, targetRegion)) continue;
+            ++relaxed;
+            int v = graph.target[e];
+            float alt = d + graph.weight[e];
+            if (alt < context.dist[v]) {
+                if (context.dist[v] == kInfinity) context.touched.push_back(v);
+                context.dist[v] = alt;
+                context.prev[v] = u;
+                heap.emplace_back(alt, v);
+                std::push_heap(heap.begin(), heap.end(), greater);
+                ++pushes;
+            }
+        }
+    }
+    context.stats = QueryStats{settled, relaxed, pushes, pops};
+
+    PathResult result = collectPath(target, context);
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
@@ -0,0 +1,54 @@
+#include "pathfinder/arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+Arena::Arena(size_t initialBytes) { addBlock(std::max<size_t>(initialBytes, 256)); }
+
+Arena::~Arena() {
+    for (const Block& block : blocks) ::operator delete(block.data);
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks) total += block.size;
+    return total;
+}
+
+void Arena::reset() {
+    if (blocks.size() > 1) {
+        // The last round outgrew the first block; size one block for the
+        // whole of it so the next round of the same shape fits.
+        size_t total = capacity();
+        for (const Block& block : blocks) ::operator delete(block.data);
+        blocks.clear();
+        addBlock(total);
+    }
+    used = 0;
+    blockStart = cursor = blocks.front().data;
+    end = blockStart + blocks.front().size;
+}
+
+void Arena::addBlock(size_t size) {
+    blocks.push_back({static_cast<char*>(::operator new(size)), size});
+    ++blocksAllocated;
+    used += static_cast<size_t>(cursor - blockStart);
+    blockStart = cursor = blocks.back().data;
+    end = blockStart + size;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    auto aligned = [alignment](char* p) {
+        auto address = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char*>((address + alignment - 1) & ~(uintptr_t(alignment) - 1));
+    };
+    char* p = aligned(cursor);
+    if (p + bytes > end) {
+        // Grow geometrically; the new block always fits this request
+        addBlock(std::max(blocks.back().size * 2, bytes + alignment));
+        p = aligned(cursor);
+    }
+    cursor = p + bytes;
+    return p;
+}
@@ -0,0 +1,33 @@
+#include "pathfinder/batch.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Small enough for stealing to even out slow slices, large enough that task
+// overhead stays negligible next to the searches
+constexpr size_t kSliceSize = 16;
+
+} // namespace
+
+BatchQueryRunner::BatchQueryRunner(const Graph& graph, ThreadPool& pool, QueryEngine engine)
+    : graph(graph), pool(pool), engine(std::move(engine)), contexts(pool.size()) {}
+
+std::vector<PathResult> BatchQueryRunner::run(const std::vector<std::pair<int, int>>& queries, bool wantPaths) {
+    TRACE_SCOPE_CATEGORY("query", "batchQueries");
+    std::vector<PathResult> results(queries.size());
+    for (size_t begin = 0; begin < queries.size(); begin += kSliceSize) {
+        size_t end = std::min(queries.size(), begin + kSliceSize);
+        pool.submit([this, &queries, &results, begin, end, wantPaths] {
+            SearchContext& context = contexts[ThreadPool::workerIndex()];
+            for (size_t i = begin; i < end; ++i) {
+                const auto& [source, target] = queries[i];
+                results[i] = engine ? engine(source, target, context) : shortestPath(graph, source, target, context);
+                if (!wantPaths) results[i].path = std::vector<int>();
+            }
+        });
+    }
+    pool.wait();
+    return results;
+}
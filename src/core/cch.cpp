@@ -0,0 +1,352 @@
+#include "pathfinder/cch.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Cells this small are not split further
+constexpr size_t kLeafSize = 16;
+// Levels with fewer ranks are customized on the calling thread
+constexpr size_t kParallelLevel = 512;
+constexpr size_t kRanksPerTask = 256;
+
+// Neighbours over arcs in either direction: contraction works on the
+// undirected structure so that one topology serves both arc directions
+struct Adjacency {
+    std::vector<int> first, neighbour;
+};
+
+Adjacency symmetricAdjacency(const Graph& graph) {
+    const int n = graph.nodeCount();
+    Adjacency adjacency;
+    adjacency.first.assign(n + 1, 0);
+    for (int u = 0; u < n; ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            int v = graph.target[e];
+            if (u == v) continue;
+            ++adjacency.first[u + 1];
+            ++adjacency.first[v + 1];
+        }
+    }
+    for (int u = 0; u < n; ++u) adjacency.first[u + 1] += adjacency.first[u];
+    adjacency.neighbour.resize(adjacency.first[n]);
+    std::vector<int> fill(adjacency.first.begin(), adjacency.first.end() - 1);
+    for (int u = 0; u < n; ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            int v = graph.target[e];
+            if (u == v) continue;
+            adjacency.neighbour[fill[u]++] = v;
+            adjacency.neighbour[fill[v]++] = u;
+        }
+    }
+    return adjacency;
+}
+
+// Directions tried for each split: both axes and both diagonals
+constexpr float kSplitDirections[][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+
+// Appends nodes to order, the separator of each split after both halves.
+// side is 0 for every node on entry and on return.
+void dissect(const Graph& graph, const Adjacency& adjacency, std::vector<int>& nodes, std::vector<int>& side,
+             std::vector<int>& order) {
+    if (nodes.size() <= kLeafSize) {
+        order.insert(order.end(), nodes.begin(), nodes.end());
+        return;
+    }
+    // Median split along each direction; either side's endpoints of the cut
+    // arcs separate the halves, and the smallest such separator wins
+    std::vector<int> bestHalves[2], bestSeparator;
+    bool found = false;
+    for (const auto& direction : kSplitDirections) {
+        auto key = [&](int v) { return direction[0] * graph.positions[v].x + direction[1] * graph.positions[v].y; };
+        auto middle = nodes.begin() + nodes.size() / 2;
+        std::nth_element(nodes.begin(), middle, nodes.end(), [&](int a, int b) { return key(a) < key(b); });
+        for (auto it = nodes.begin(); it != nodes.end(); ++it) side[*it] = it < middle ? 1 : 2;
+
+        std::vector<int> halves[2], cuts[2];
+        for (int v : nodes) {
+            int own = side[v];
+            bool onCut = false;
+            for (int i = adjacency.first[v]; i < adjacency.first[v + 1] && !onCut; ++i) {
+                onCut = side[adjacency.neighbour[i]] == 3 - own;
+            }
+            (onCut ? cuts : halves)[own - 1].push_back(v);
+        }
+        for (int v : nodes) side[v] = 0;
+        int kept = cuts[0].size() <= cuts[1].size() ? 1 : 0;
+        if (found && cuts[1 - kept].size() >= bestSeparator.size()) continue;
+        halves[kept].insert(halves[kept].end(), cuts[kept].begin(), cuts[kept].end());
+        bestHalves[0].swap(halves[0]);
+        bestHalves[1].swap(halves[1]);
+        bestSeparator.swap(cuts[1 - kept]);
+        found = true;
+    }
+
+    std::vector<int>().swap(nodes);
+    dissect(graph, adjacency, bestHalves[0], side, order);
+    dissect(graph, adjacency, bestHalves[1], side, order);
+    order.insert(order.end(), bestSeparator.begin(), bestSeparator.end());
+}
+
+std::vector<int> dissectionOrder(const Graph& graph, const Adjacency& adjacency) {
+    const int n = graph.nodeCount();
+    std::vector<int> nodes(n);
+    for (int v = 0; v < n; ++v) nodes[v] = v;
+    std::vector<int> side(n, 0);
+    std::vector<int> order;
+    order.reserve(n);
+    dissect(graph, adjacency, nodes, side, order);
+    return order;
+}
+
+// Arc between ranks low < high, -1 if there is none
+int findArc(const CchTopology& topology, int low, int high) {
+    auto begin = topology.upHead.begin() + topology.upFirst[low];
+    auto end = topology.upHead.begin() + topology.upFirst[low + 1];
+    auto it = std::lower_bound(begin, end, high);
+    return it != end && *it == high ? static_cast<int>(it - topology.upHead.begin()) : -1;
+}
+
+// Improves the arcs of rank u through every lower triangle x - u - w: the
+// arcs of x are final once its level is done
+void customizeRank(const CchTopology& topology, CchMetric& metric, int u) {
+    for (int i = topology.downFirst[u]; i < topology.downFirst[u + 1]; ++i) {
+        int lower = topology.downArc[i]; // x - u
+        int x = topology.upTail[lower];
+        int p = lower + 1, pEnd = topology.upFirst[x + 1];
+        int q = topology.upFirst[u], qEnd = topology.upFirst[u + 1];
+        while (p < pEnd && q < qEnd) {
+            if (topology.upHead[p] < topology.upHead[q]) {
+                ++p;
+            } else if (topology.upHead[q] < topology.upHead[p]) {
+                ++q;
+            } else {
+                // p is x - w, q is u - w
+                metric.upward[q] = std::min(metric.upward[q], metric.downward[lower] + metric.upward[p]);
+                metric.downward[q] = std::min(metric.downward[q], metric.downward[p] + metric.upward[lower]);
+                ++p;
+                ++q;
+            }
+        }
+    }
+}
+
+// Appends the nodes after the arc's start: low -> high when upward. A shortcut
+// goes through the lower triangle whose sum it took in customization; an arc
+// no triangle explains is an input arc.
+void unpackArc(const CchTopology& topology, const CchMetric& metric, int arc, bool upward,
+               std::vector<int>& path) {
+    int low = topology.upTail[arc], high = topology.upHead[arc];
+    float weight = upward ? metric.upward[arc] : metric.downward[arc];
+    for (int i = topology.downFirst[low]; i < topology.downFirst[low + 1]; ++i) {
+        int toLow = topology.downArc[i]; // x - low
+        int toHigh = findArc(topology, topology.upTail[toLow], high);
+        if (toHigh < 0) continue;
+        if (upward && metric.downward[toLow] + metric.upward[toHigh] == weight) {
+            unpackArc(topology, metric, toLow, false, path);
+            unpackArc(topology, metric, toHigh, true, path);
+            return;
+        }
+        if (!upward && metric.downward[toHigh] + metric.upward[toLow] == weight) {
+            unpackArc(topology, metric, toHigh, false, path);
+            unpackArc(topology, metric, toLow, true, path);
+            return;
+        }
+    }
+    path.push_back(topology.order[upward ? high : low]);
+}
+
+} // namespace
+
+std::vector<int> nestedDissectionOrder(const Graph& graph) {
+    TRACE_SCOPE_CATEGORY("build", "nestedDissectionOrder");
+    return dissectionOrder(graph, symmetricAdjacency(graph));
+}
+
+CchTopology buildCchTopology(const Graph& graph) {
+    TRACE_SCOPE_CATEGORY("build", "buildCchTopology");
+    const int n = graph.nodeCount();
+    Adjacency adjacency = symmetricAdjacency(graph);
+    CchTopology topology;
+    topology.order = dissectionOrder(graph, adjacency);
+    topology.rank.assign(n, 0);
+    for (int r = 0; r < n; ++r) topology.rank[topology.order[r]] = r;
+    topology.fingerprint = topologyFingerprint(graph);
+
+    // Contracting a rank joins its higher neighbours into a clique; adding
+    // them to the lowest of them is enough, as that one is contracted next
+    // among them and passes the rest on
+    std::vector<std::vector<int>> up(n);
+    for (int v = 0; v < n; ++v) {
+        for (int i = adjacency.first[v]; i < adjacency.first[v + 1]; ++i) {
+            int u = adjacency.neighbour[i];
+            if (topology.rank[u] > topology.rank[v]) up[topology.rank[v]].push_back(topology.rank[u]);
+        }
+    }
+    topology.parent.assign(n, -1);
+    topology.upFirst.assign(n + 1, 0);
+    for (int r = 0; r < n; ++r) {
+        std::vector<int>& heads = up[r];
+        std::sort(heads.begin(), heads.end());
+        heads.erase(std::unique(heads.begin(), heads.end()), heads.end());
+        if (!heads.empty()) {
+            int p = heads.front();
+            topology.parent[r] = p;
+            up[p].insert(up[p].end(), heads.begin() + 1, heads.end());
+        }
+        topology.upFirst[r + 1] = topology.upFirst[r] + static_cast<int>(heads.size());
+    }
+    topology.upHead.reserve(topology.upFirst[n]);
+    topology.upTail.reserve(topology.upFirst[n]);
+    for (int r = 0; r < n; ++r) {
+        topology.upHead.insert(topology.upHead.end(), up[r].begin(), up[r].end());
+        topology.upTail.insert(topology.upTail.end(), up[r].size(), r);
+        std::vector<int>().swap(up[r]);
+    }
+
+    const int m = topology.arcCount();
+    topology.downFirst.assign(n + 1, 0);
+    for (int head : topology.upHead) ++topology.downFirst[head + 1];
+    for (int r = 0; r < n; ++r) topology.downFirst[r + 1] += topology.downFirst[r];
+    topology.downArc.resize(m);
+    std::vector<int> fill(topology.downFirst.begin(), topology.downFirst.end() - 1);
+    for (int a = 0; a < m; ++a) topology.downArc[fill[topology.upHead[a]]++] = a;
+
+    // A rank's level is one above the highest of the ranks below it
+    std::vector<int> level(n, 0);
+    int levels = n > 0 ? 1 : 0;
+    for (int r = 0; r < n; ++r) {
+        for (int a = topology.upFirst[r]; a < topology.upFirst[r + 1]; ++a) {
+            int head = topology.upHead[a];
+            level[head] = std::max(level[head], level[r] + 1);
+            levels = std::max(levels, level[head] + 1);
+        }
+    }
+    topology.levelFirst.assign(levels + 1, 0);
+    for (int r = 0; r < n; ++r) ++topology.levelFirst[level[r] + 1];
+    for (int l = 0; l < levels; ++l) topology.levelFirst[l + 1] += topology.levelFirst[l];
+    topology.byLevel.resize(n);
+    fill.assign(topology.levelFirst.begin(), topology.levelFirst.end() - 1);
+    for (int r = 0; r < n; ++r) topology.byLevel[fill[level[r]]++] = r;
+
+    topology.inputArc.assign(graph.target.size(), -1);
+    for (int u = 0; u < n; ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            int ru = topology.rank[u], rv = topology.rank[graph.target[e]];
+            if (ru == rv) continue;
+            int arc = findArc(topology, std::min(ru, rv), std::max(ru, rv));
+            topology.inputArc[e] = 2 * arc + (ru > rv ? 1 : 0);
+        }
+    }
+    return topology;
+}
+
+bool sameTopology(const CchTopology& topology, const Graph& graph) {
+    return graph.nodeCount() == topology.nodeCount() &&
+           graph.target.size() == topology.inputArc.size() &&
+           topologyFingerprint(graph) == topology.fingerprint;
+}
+
+CchMetric customizeCch(const CchTopology& topology, const Graph& graph, ThreadPool& pool) {
+    TRACE_SCOPE_CATEGORY("build", "customizeCch");
+    CchMetric metric;
+    metric.upward.assign(topology.arcCount(), kInfinity);
+    metric.downward.assign(topology.arcCount(), kInfinity);
+    for (size_t e = 0; e < topology.inputArc.size(); ++e) {
+        int code = topology.inputArc[e];
+        if (code < 0) continue;
+        float& slot = (code & 1) ? metric.downward[code >> 1] : metric.upward[code >> 1];
+        slot = std::min(slot, graph.weight[e]);
+    }
+
+    // Ranks of one level write only their own arcs and read those of lower
+    // levels, so a level can be split freely
+    for (size_t l = 0; l + 1 < topology.levelFirst.size(); ++l) {
+        int begin = topology.levelFirst[l], end = topology.levelFirst[l + 1];
+        if (static_cast<size_t>(end - begin) < kParallelLevel || pool.size() < 2) {
+            for (int i = begin; i < end; ++i) customizeRank(topology, metric, topology.byLevel[i]);
+            continue;
+        }
+        for (int first = begin; first < end; first += static_cast<int>(kRanksPerTask)) {
+            int last = std::min(end, first + static_cast<int>(kRanksPerTask));
+            pool.submit([&topology, &metric, first, last] {
+                for (int i = first; i < last; ++i) customizeRank(topology, metric, topology.byLevel[i]);
+            });
+        }
+        pool.wait();
+    }
+    return metric;
+}
+
+void CchQueryContext::prepare(int nodeCount) {
+    if (forward.size() == static_cast<size_t>(nodeCount)) return;
+    forward.assign(nodeCount, kInfinity);
+    backward.assign(nodeCount, kInfinity);
+    forwardArc.assign(nodeCount, -1);
+    backwardArc.assign(nodeCount, -1);
+}
+
+PathResult cchShortestPath(const CchTopology& topology, const CchMetric& metric, int source, int target,
+                           CchQueryContext& context) {
+    TRACE_SCOPE_CATEGORY("query", "cchShortestPath");
+    static QueryMetrics& metrics = queryMetrics("cch");
+    auto queryStart = MetricsClock::now();
+    context.prepare(topology.nodeCount());
+    PathResult result;
+
+    // Only elimination tree ancestors get a distance, so walking the two
+    // chains again afterwards resets the context
+    auto scan = [&](int start, const std::vector<float>& weight, std::vector<float>& dist, std::vector<int>& via) {
+        dist[start] = 0;
+        for (int u = start; u != -1; u = topology.parent[u]) {
+            ++result.stats.settled;
+            float du = dist[u];
+            if (du == kInfinity) continue;
+            for (int a = topology.upFirst[u]; a < topology.upFirst[u + 1]; ++a) {
+                ++result.stats.relaxed;
+                int w = topology.upHead[a];
+                float candidate = du + weight[a];
+                if (candidate < dist[w]) {
+                    dist[w] = candidate;
+                    via[w] = a;
+                }
+            }
+        }
+    };
+    int s = topology.rank[source], t = topology.rank[target];
+    scan(s, metric.upward, context.forward, context.forwardArc);
+    scan(t, metric.downward, context.backward, context.backwardArc);
+
+    int meeting = -1;
+    for (int u = s; u != -1; u = topology.parent[u]) {
+        float total = context.forward[u] + context.backward[u];
+        if (total < result.distance) {
+            result.distance = total;
+            meeting = u;
+        }
+    }
+
+    if (meeting != -1) {
+        // Upward arcs from s to the meeting rank, then downward ones to t
+        std::vector<int> arcs;
+        for (int u = meeting; u != s; u = topology.upTail[context.forwardArc[u]]) arcs.push_back(context.forwardArc[u]);
+        result.path.push_back(source);
+        for (auto it = arcs.rbegin(); it != arcs.rend(); ++it) unpackArc(topology, metric, *it, true, result.path);
+        for (int u = meeting; u != t; u = topology.upTail[context.backwardArc[u]]) {
+            unpackArc(topology, metric, context.backwardArc[u], false, result.path);
+        }
+    }
+
+    for (int start : {s, t}) {
+        for (int u = start; u != -1; u = topology.parent[u]) {
+            context.forward[u] = kInfinity;
+            context.backward[u] = kInfinity;
+            context.forwardArc[u] = -1;
+            context.backwardArc[u] = -1;
+        }
+    }
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
@@ -0,0 +1,212 @@
+#include "pathfinder/delta_stepping.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+// Distance and parent share one 64-bit word so a relaxation updates both
+// atomically. Non-negative floats order like their bit patterns, so packed
+// words compare by distance first.
+uint64_t pack(float distance, int parent) {
+    uint32_t bits;
+    std::memcpy(&bits, &distance, sizeof bits);
+    return static_cast<uint64_t>(bits) << 32 | static_cast<uint32_t>(parent);
+}
+
+float unpackDistance(uint64_t word) {
+    uint32_t bits = static_cast<uint32_t>(word >> 32);
+    float distance;
+    std::memcpy(&distance, &bits, sizeof distance);
+    return distance;
+}
+
+int unpackParent(uint64_t word) { return static_cast<int>(static_cast<uint32_t>(word)); }
+
+// Frontiers below this size are expanded on the calling thread, as is
+// everything when the pool has a single worker
+constexpr size_t kParallelThreshold = 512;
+constexpr size_t kMinChunk = 128;
+
+// Output of one slice of a phase
+struct Chunk {
+    std::vector<int> improved; // nodes whose distance dropped, possibly repeated
+    QueryStats stats;
+};
+
+class DeltaStepper {
+public:
+    DeltaStepper(const Graph& graph, const DeltaSteppingIndex& index, ThreadPool& pool)
+        : graph(graph), index(index), pool(pool), words(new std::atomic<uint64_t>[graph.nodeCount()]),
+          queuedIn(graph.nodeCount(), -1),
+          chunks(std::max<size_t>(1, pool.size() * 4)) {
+        const uint64_t unreached = pack(kInfinity, -1);
+        for (int v = 0; v < graph.nodeCount(); ++v) words[v].store(unreached, std::memory_order_relaxed);
+    }
+
+    void run(int source, DeltaSteppingResult& result) {
+        words[source].store(pack(0.0f, -1), std::memory_order_relaxed);
+        enqueue(source, stats);
+
+        std::vector<int> frontier, removed;
+        for (size_t current = 0; current < buckets.size(); ++current) {
+            removed.clear();
+            // Light edges can refill the current bucket; repeat until it stays empty
+            while (takeBucket(current, frontier)) {
+                stats.settled += static_cast<int>(frontier.size());
+                parallelRelax(frontier, true);
+                removed.insert(removed.end(), frontier.begin(), frontier.end());
+            }
+            // Nodes of this bucket are final now; heavy edges only reach later buckets
+            std::sort(removed.begin(), removed.end());
+            removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+            parallelRelax(removed, false);
+        }
+
+        const int n = graph.nodeCount();
+        result.dist.resize(n);
+        result.prev.resize(n);
+        for (int v = 0; v < n; ++v) {
+            uint64_t word = words[v].load(std::memory_order_relaxed);
+            result.dist[v] = unpackDistance(word);
+            result.prev[v] = unpackParent(word);
+        }
+        result.stats = stats;
+    }
+
+private:
+    size_t bucketOf(float distance) const { return static_cast<size_t>(distance / index.delta); }
+
+    void enqueue(int v, QueryStats& counters) {
+        size_t bucket = bucketOf(unpackDistance(words[v].load(std::memory_order_relaxed)));
+        if (queuedIn[v] == static_cast<long long>(bucket)) return; // already waiting there
+        queuedIn[v] = static_cast<long long>(bucket);
+        if (bucket >= buckets.size()) buckets.resize(bucket + 1);
+        buckets[bucket].push_back(v);
+        ++counters.heapPushes;
+    }
+
+    // Moves the live entries of a bucket into frontier; entries whose node has
+    // since moved to an earlier bucket are stale and dropped.
+    bool takeBucket(size_t bucket, std::vector<int>& frontier) {
+        frontier.clear();
+        std::vector<int> entries;
+        entries.swap(buckets[bucket]);
+        for (int v : entries) {
+            ++stats.heapPops;
+            if (queuedIn[v] != static_cast<long long>(bucket)) continue;
+            queuedIn[v] = -1;
+            frontier.push_back(v);
+        }
+        return !frontier.empty();
+    }
+
+    void relaxNode(int u, bool light, Chunk& chunk) {
+        float d = unpackDistance(words[u].load(std::memory_order_relaxed));
+        int begin = light ? graph.firstEdge[u] : index.lightEnd[u];
+        int end = light ? index.lightEnd[u] : graph.firstEdge[u + 1];
+        chunk.stats.relaxed += end - begin;
+        for (int e = begin; e < end; ++e) {
+            int v = index.target[e];
+            uint64_t candidate = pack(d + index.weight[e], u);
+            uint64_t seen = words[v].load(std::memory_order_relaxed);
+            // Compare distances only: ties keep the first parent
+            while ((candidate >> 32) < (seen >> 32)) {
+                if (words[v].compare_exchange_weak(seen, candidate, std::memory_order_relaxed)) {
+                    chunk.improved.push_back(v);
+                    break;
+                }
+            }
+        }
+    }
+
+    void parallelRelax(const std::vector<int>& nodes, bool light) {
+        if (nodes.empty()) return;
+        size_t count = nodes.size();
+        size_t used = 1;
+        if (count >= kParallelThreshold && pool.size() > 1)
+            used = std::min(chunks.size(), count / kMinChunk);
+        size_t step = (count + used - 1) / used;
+
+        for (size_t c = 0; c < used; ++c) {
+            chunks[c].improved.clear();
+            chunks[c].stats = QueryStats();
+        }
+        auto work = [&, step, light](size_t c) {
+            size_t begin = c * step, end = std::min(count, begin + step);
+            for (size_t i = begin; i < end; ++i) relaxNode(nodes[i], light, chunks[c]);
+        };
+        if (used == 1) {
+            work(0);
+        } else {
+            TRACE_SCOPE_CATEGORY("query", light ? "deltaLightPhase" : "deltaHeavyPhase");
+            for (size_t c = 0; c < used; ++c) pool.submit([&work, c] { work(c); });
+            pool.wait();
+        }
+
+        // Bucket bookkeeping stays on one thread; it is linear in the
+        // improvements, while the relaxations above are linear in the edges.
+        for (size_t c = 0; c < used; ++c) {
+            stats.relaxed += chunks[c].stats.relaxed;
+            for (int v : chunks[c].improved) enqueue(v, stats);
+        }
+    }
+
+    const Graph& graph;
+    const DeltaSteppingIndex& index;
+    ThreadPool& pool;
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+    std::vector<long long> queuedIn; // bucket a node is waiting in, or -1
+    std::vector<std::vector<int>> buckets;
+    std::vector<Chunk> chunks;
+    QueryStats stats;
+};
+
+} // namespace
+
+float suggestDelta(const Graph& graph, float scale) {
+    if (graph.weight.empty()) return 0;
+    std::vector<float> lengths(graph.weight);
+    auto middle = lengths.begin() + lengths.size() / 2;
+    std::nth_element(lengths.begin(), middle, lengths.end());
+    return scale * *middle;
+}
+
+DeltaSteppingIndex buildDeltaSteppingIndex(const Graph& graph, float delta) {
+    TRACE_SCOPE_CATEGORY("build", "buildDeltaSteppingIndex");
+    DeltaSteppingIndex index;
+    index.delta = delta > 0 ? delta : suggestDelta(graph);
+    if (!(index.delta > 0)) index.delta = 1; // no arcs, or only zero-length ones
+    index.target.resize(graph.target.size());
+    index.weight.resize(graph.weight.size());
+    index.lightEnd.resize(graph.nodeCount());
+    for (int u = 0; u < graph.nodeCount(); ++u) {
+        int slot = graph.firstEdge[u];
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                bool light = graph.weight[e] <= index.delta;
+                if (light != (pass == 0)) continue;
+                index.target[slot] = graph.target[e];
+                index.weight[slot] = graph.weight[e];
+                ++slot;
+            }
+            if (pass == 0) index.lightEnd[u] = slot;
+        }
+    }
+    return index;
+}
+
+void deltaSteppingTree(const Graph& graph, const DeltaSteppingIndex& index, int source,
+                       ThreadPool& pool, DeltaSteppingResult& result) {
+    TRACE_SCOPE_CATEGORY("query", "deltaSteppingTree");
+    static QueryMetrics& metrics = queryMetrics("delta_stepping");
+    auto queryStart = MetricsClock::now();
+    DeltaStepper stepper(graph, index, pool);
+    stepper.run(source, result);
+    metrics.record(MetricsClock::now() - queryStart, result.stats, true);
+}
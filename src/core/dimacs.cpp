@@ -0,0 +1,199 @@
+#include "pathfinder/dimacs.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <tuple>
+
+namespace {
+
+// The USA graphs are several hundred megabytes; slurp the file and walk it
+// with strtol instead of going through iostream extraction per token.
+bool readWholeFile(const std::string& path, std::string& contents) {
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile) {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << inFile.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+// Calls handle(line) for every non-empty, non-comment line.
+template <typename Handler>
+bool forEachLine(const std::string& contents, Handler handle) {
+    const char* at = contents.c_str();
+    const char* end = at + contents.size();
+    while (at < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(at, '\n', end - at));
+        if (!lineEnd) lineEnd = end;
+        if (*at != 'c' && *at != '\n' && *at != '\r') {
+            if (!handle(at)) return false;
+        }
+        at = lineEnd + 1;
+    }
+    return true;
+}
+
+// Parses count integers following the leading tag character of a line.
+bool parseInts(const char* line, long long* values, int count) {
+    const char* at = line + 1;
+    for (int i = 0; i < count; ++i) {
+        char* next = nullptr;
+        values[i] = std::strtoll(at, &next, 10);
+        if (next == at) return false;
+        at = next;
+    }
+    return true;
+}
+
+// Splits a problem line ("p sp N M", "p aux sp co N", ...) into words.
+std::vector<std::string> splitWords(const char* line) {
+    const char* end = std::strchr(line, '\n');
+    std::istringstream words(end ? std::string(line, end) : std::string(line));
+    std::vector<std::string> result;
+    for (std::string w; words >> w;) result.push_back(w);
+    return result;
+}
+
+} // namespace
+
+bool loadDimacsGraph(const std::string& grPath,
+                     const std::string& coPath,
+                     std::vector<Node>& destinationNodes,
+                     std::vector<IdArc>& arcs) {
+    TRACE_SCOPE_CATEGORY("io", "loadDimacsGraph");
+    std::string contents;
+
+    // Coordinates first: they define the node positions
+    if (!readWholeFile(coPath, contents)) return false;
+    long long nodeCount = -1;
+    std::vector<long long> xs, ys;
+    std::vector<char> seen;
+    bool ok = forEachLine(contents, [&](const char* line) {
+        if (*line == 'p') {
+            auto words = splitWords(line);
+            if (words.size() < 5 || words[3] != "co") return false;
+            nodeCount = std::atoll(words[4].c_str());
+            // Node ids are narrowed to int below
+            if (nodeCount < 0 || nodeCount > INT_MAX) return false;
+            xs.assign(nodeCount, 0);
+            ys.assign(nodeCount, 0);
+            seen.assign(nodeCount, 0);
+            return true;
+        }
+        if (*line != 'v' || nodeCount < 0) return false;
+        long long v[3];
+        if (!parseInts(line, v, 3) || v[0] < 1 || v[0] > nodeCount) return false;
+        xs[v[0] - 1] = v[1];
+        ys[v[0] - 1] = v[2];
+        seen[v[0] - 1] = 1;
+        return true;
+    });
+    if (!ok || nodeCount < 0) {
+        std::cerr << "Malformed coordinate file " << coPath << "\n";
+        return false;
+    }
+    if (std::find(seen.begin(), seen.end(), 0) != seen.end()) {
+        std::cerr << "Coordinate file " << coPath << " does not cover every vertex\n";
+        return false;
+    }
+
+    // Coordinates are micro-degrees; shift them next to the origin so floats
+    // keep as much precision as possible, and flip latitude so north is up.
+    long long minX = nodeCount ? *std::min_element(xs.begin(), xs.end()) : 0;
+    long long maxY = nodeCount ? *std::max_element(ys.begin(), ys.end()) : 0;
+    size_t firstNew = destinationNodes.size();
+    destinationNodes.reserve(firstNew + nodeCount);
+    for (long long i = 0; i < nodeCount; ++i) {
+        destinationNodes.push_back(Node{
+            Vec2{static_cast<float>(xs[i] - minX), static_cast<float>(maxY - ys[i])}, true});
+    }
+    xs.clear(); xs.shrink_to_fit();
+    ys.clear(); ys.shrink_to_fit();
+
+    // Arcs
+    if (!readWholeFile(grPath, contents)) return false;
+    struct Arc {
+        int from, to;
+        long long length;
+        bool operator<(const Arc& other) const {
+            return std::tie(from, to, length) < std::tie(other.from, other.to, other.length);
+        }
+    };
+    std::vector<Arc> parsed;
+    ok = forEachLine(contents, [&](const char* line) {
+        if (*line == 'p') {
+            auto words = splitWords(line);
+            if (words.size() < 4 || words[1] != "sp" || std::atoll(words[2].c_str()) != nodeCount)
+                return false;
+            parsed.reserve(std::atoll(words[3].c_str()));
+            return true;
+        }
+        if (*line != 'a') return false;
+        long long a[3];
+        if (!parseInts(line, a, 3) || a[0] < 1 || a[0] > nodeCount || a[1] < 1 || a[1] > nodeCount || a[2] < 0)
+            return false;
+        if (a[0] == a[1]) return true; // self loop
+        parsed.push_back(Arc{static_cast<int>(a[0] - 1), static_cast<int>(a[1] - 1), a[2]});
+        return true;
+    });
+    if (!ok) {
+        std::cerr << "Malformed graph file " << grPath << "\n";
+        return false;
+    }
+    // Keep the shortest of parallel arcs
+    std::sort(parsed.begin(), parsed.end());
+    parsed.erase(std::unique(parsed.begin(), parsed.end(),
+                           [](const Arc& a, const Arc& b) { return a.from == b.from && a.to == b.to; }),
+               parsed.end());
+
+    const int firstId = static_cast<int>(firstNew);
+    arcs.reserve(arcs.size() + parsed.size());
+    for (const Arc& arc : parsed) {
+        arcs.push_back(IdArc{firstId + arc.from, firstId + arc.to, static_cast<float>(arc.length)});
+    }
+    return true;
+}
+
+bool loadDimacsQueries(const std::string& path, DimacsQueries& queries) {
+    TRACE_SCOPE_CATEGORY("io", "loadDimacsQueries");
+    std::string contents;
+    if (!readWholeFile(path, contents)) return false;
+
+    bool haveProblem = false;
+    bool ok = forEachLine(contents, [&](const char* line) {
+        if (*line == 'p') {
+            auto words = splitWords(line);
+            if (words.size() < 5 || words[1] != "aux" || words[2] != "sp") return false;
+            if (words[3] == "ss") queries.singleSource = true;
+            else if (words[3] == "p2p") queries.singleSource = false;
+            else return false;
+            haveProblem = true;
+            return true;
+        }
+        if (!haveProblem) return false;
+        long long q[2];
+        if (*line == 's' && queries.singleSource && parseInts(line, q, 1)) {
+            queries.sources.push_back(static_cast<int>(q[0] - 1));
+            return true;
+        }
+        if (*line == 'q' && !queries.singleSource && parseInts(line, q, 2)) {
+            queries.pairs.emplace_back(static_cast<int>(q[0] - 1), static_cast<int>(q[1] - 1));
+            return true;
+        }
+        return false;
+    });
+    if (!ok || !haveProblem) {
+        std::cerr << "Malformed query file " << path << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,406 @@
+#include "pathfinder/graph.hpp"
+#include "pathfinder/arena.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory_resource>
+#include <queue>
+#include <unordered_map>
+
+float euclidean(const Vec2& a, const Vec2& b) {
+    float dx = a.x - b.x, dy = a.y - b.y;
+    return std::sqrt(dx*dx + dy*dy);
+}
+
+namespace {
+
+const char* const kRoadClassNames[kRoadClassCount] = {"track", "street", "main", "motorway"};
+const float kDefaultSpeeds[kRoadClassCount] = {0.5f, 1.0f, 1.5f, 2.5f};
+
+} // namespace
+
+const char* roadClassName(RoadClass roadClass) {
+    return kRoadClassNames[static_cast<int>(roadClass)];
+}
+
+bool parseRoadClass(const std::string& text, RoadClass& roadClass) {
+    for (int i = 0; i < kRoadClassCount; ++i) {
+        if (text == kRoadClassNames[i]) {
+            roadClass = static_cast<RoadClass>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+float defaultSpeed(RoadClass roadClass) {
+    return kDefaultSpeeds[static_cast<int>(roadClass)];
+}
+
+float edgeWeight(const Edge& edge) {
+    if (edge.weight >= 0.0f) return edge.weight;
+    float speed = edge.speed > 0.0f ? edge.speed : defaultSpeed(edge.roadClass);
+    return euclidean(edge.from, edge.to) / speed;
+}
+
+std::vector<Vec2> findShortestPath(
+    const Vec2& start,
+    const Vec2& goal,
+    const std::vector<Node>& destinationNodes,
+    const std::vector<Node>& roadNodes,
+    const std::vector<Edge>& edges,
+    QueryStats* stats,
+    float* distance
+) {
+    TRACE_SCOPE_CATEGORY("query", "findShortestPath");
+    static QueryMetrics& metrics = queryMetrics("legacy");
+    auto queryStart = MetricsClock::now();
+    QueryStats work;
+
+    // Every temporary below lives in this arena and is dropped in one go on return
+    thread_local Arena arena;
+    ArenaScope scope(arena);
+
+    // Build adjacency list
+    std::pmr::vector<Vec2> allNodes(&arena);
+    allNodes.reserve(destinationNodes.size() + roadNodes.size());
+    for (const auto& n : destinationNodes) allNodes.push_back(n.position);
+    for (const auto& n : roadNodes) allNodes.push_back(n.position);
+
+    std::pmr::unordered_map<Vec2, std::pmr::vector<std::pair<Vec2, float>>> adj(&arena);
+    adj.reserve(allNodes.size());
+    for (const auto& node : allNodes) adj.try_emplace(node);
+    for (const auto& e : edges) {
+        float w = edgeWeight(e);
+        adj[e.from].emplace_back(e.to, w);
+        if (!e.oneWay) adj[e.to].emplace_back(e.from, w);
+    }
+
+    // Dijkstra
+    std::pmr::unordered_map<Vec2, float> dist(&arena);
+    std::pmr::unordered_map<Vec2, Vec2> prev(&arena);
+    dist.reserve(allNodes.size());
+    auto cmp = [&](const Vec2& a, const Vec2& b) {
+        return dist[a] > dist[b];
+    };
+    std::priority_queue<Vec2, std::pmr::vector<Vec2>, decltype(cmp)> pq(cmp, std::pmr::vector<Vec2>(&arena));
+
+    for (const auto& node : allNodes) dist[node] = std::numeric_limits<float>::infinity();
+    dist[start] = 0;
+    pq.push(start);
+    ++work.heapPushes;
+
+    while (!pq.empty()) {
+        Vec2 u = pq.top(); pq.pop();
+        ++work.heapPops;
+        ++work.settled;
+        if (u == goal) break;
+        for (const auto& [v, w] : adj[u]) {
+            ++work.relaxed;
+            float alt = dist[u] + w;
+            if (alt < dist[v]) {
+                dist[v] = alt;
+                prev[v] = u;
+                pq.push(v);
+                ++work.heapPushes;
+            }
+        }
+    }
+    if (stats) *stats = work;
+    if (distance) {
+        auto reached = dist.find(goal);
+        *distance = reached != dist.end() ? reached->second : kInfinity;
+    }
+
+    // Reconstruct path
+    std::vector<Vec2> path;
+    bool reachable = prev.find(goal) != prev.end();
+    if (reachable) {
+        // The path is the one allocation that outlives the arena; size it up front
+        size_t length = 1;
+        for (Vec2 at = goal; at != start; at = prev[at]) ++length;
+        path.resize(length);
+        for (Vec2 at = goal; at != start; at = prev[at]) path[--length] = at;
+        path[0] = start;
+    }
+    metrics.record(MetricsClock::now() - queryStart, work, reachable);
+    return path; // empty if there is no path
+}
+
+namespace {
+
+struct BuildArc {
+    int from, to;
+    float weight;
+    RoadClass roadClass;
+};
+
+RoadClass arcRoadClass(const BuildArc& arc) { return arc.roadClass; }
+RoadClass arcRoadClass(const IdArc&) { return RoadClass::Street; }
+
+Graph graphWithNodes(const std::vector<Node>& destinationNodes, const std::vector<Node>& roadNodes) {
+    Graph graph;
+    graph.destinationCount = static_cast<int>(destinationNodes.size());
+    graph.positions.reserve(destinationNodes.size() + roadNodes.size());
+    for (const auto& n : destinationNodes) graph.positions.push_back(n.position);
+    for (const auto& n : roadNodes) graph.positions.push_back(n.position);
+    return graph;
+}
+
+// Lays arcs between valid node ids out as graph's adjacency arrays
+template <typename Arcs>
+void fillArcs(Graph& graph, const Arcs& arcs, Arena& arena) {
+    const int n = graph.nodeCount();
+    graph.firstEdge.assign(n + 1, 0);
+    for (const auto& a : arcs) ++graph.firstEdge[a.from + 1];
+    for (int i = 0; i < n; ++i) graph.firstEdge[i + 1] += graph.firstEdge[i];
+
+    const size_t arcCount = graph.firstEdge[n];
+    graph.target.resize(arcCount);
+    graph.weight.resize(arcCount);
+    graph.arcClass.resize(arcCount);
+    std::pmr::vector<int> fill(graph.firstEdge.begin(), graph.firstEdge.end() - 1, &arena);
+    for (const auto& a : arcs) {
+        int slot = fill[a.from]++;
+        graph.target[slot] = a.to;
+        graph.weight[slot] = a.weight;
+        graph.arcClass[slot] = static_cast<uint8_t>(arcRoadClass(a));
+    }
+}
+
+} // namespace
+
+Graph buildGraph(const std::vector<Node>& destinationNodes,
+                 const std::vector<Node>& roadNodes,
+                 const std::vector<Edge>& edges) {
+    TRACE_SCOPE_CATEGORY("build", "buildGraph");
+    Graph graph = graphWithNodes(destinationNodes, roadNodes);
+
+    // Build scratch comes from a per-thread arena; only the Graph arrays outlive the call
+    thread_local Arena arena;
+    ArenaScope scope(arena);
+
+    // Edges reference nodes by position; resolve them to ids once
+    std::pmr::unordered_map<Vec2, int> idOf(&arena);
+    idOf.reserve(graph.positions.size());
+    for (int i = 0; i < graph.nodeCount(); ++i) idOf.emplace(graph.positions[i], i);
+
+    std::pmr::vector<BuildArc> arcs(&arena);
+    arcs.reserve(edges.size() * 2);
+    for (const auto& e : edges) {
+        auto from = idOf.find(e.from);
+        auto to = idOf.find(e.to);
+        if (from == idOf.end() || to == idOf.end()) continue; // dangling edge
+        float w = edgeWeight(e);
+        arcs.push_back(BuildArc{from->second, to->second, w, e.roadClass});
+        if (!e.oneWay) arcs.push_back(BuildArc{to->second, from->second, w, e.roadClass});
+    }
+    fillArcs(graph, arcs, arena);
+    return graph;
+}
+
+Graph buildGraph(const std::vector<Node>& destinationNodes,
+                 const std::vector<Node>& roadNodes,
+                 const std::vector<IdArc>& arcs) {
+    TRACE_SCOPE_CATEGORY("build", "buildGraph");
+    Graph graph = graphWithNodes(destinationNodes, roadNodes);
+    thread_local Arena arena;
+    ArenaScope scope(arena);
+
+    const int n = graph.nodeCount();
+    auto valid = [n](const IdArc& a) { return a.from >= 0 && a.from < n && a.to >= 0 && a.to < n; };
+    if (std::all_of(arcs.begin(), arcs.end(), valid)) {
+        fillArcs(graph, arcs, arena);
+    } else {
+        std::pmr::vector<IdArc> kept(&arena);
+        std::copy_if(arcs.begin(), arcs.end(), std::back_inserter(kept), valid);
+        fillArcs(graph, kept, arena);
+    }
+    return graph;
+}
+
+Graph reverseGraph(const Graph& graph) {
+    TRACE_SCOPE_CATEGORY("build", "reverseGraph");
+    const int n = graph.nodeCount();
+    Graph reversed;
+    reversed.positions = graph.positions;
+    reversed.destinationCount = graph.destinationCount;
+    reversed.firstEdge.assign(n + 1, 0);
+    for (int v : graph.target) ++reversed.firstEdge[v + 1];
+    for (int i = 0; i < n; ++i) reversed.firstEdge[i + 1] += reversed.firstEdge[i];
+    reversed.target.resize(graph.target.size());
+    reversed.weight.resize(graph.weight.size());
+    reversed.arcClass.resize(graph.arcClass.size());
+    std::vector<int> fill(reversed.firstEdge.begin(), reversed.firstEdge.end() - 1);
+    for (int u = 0; u < n; ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            int slot = fill[graph.target[e]]++;
+            reversed.target[slot] = u;
+            reversed.weight[slot] = graph.weight[e];
+            if (!graph.arcClass.empty()) reversed.arcClass[slot] = graph.arcClass[e];
+        }
+    }
+    return reversed;
+}
+
+uint64_t topologyFingerprint(const Graph& graph) {
+    // FNV-1a over the arc arrays
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint32_t word) {
+        for (int i = 0; i < 4; ++i) {
+            hash ^= (word >> (8 * i)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(static_cast<uint32_t>(graph.nodeCount()));
+    for (int offset : graph.firstEdge) mix(static_cast<uint32_t>(offset));
+    for (int v : graph.target) mix(static_cast<uint32_t>(v));
+    return hash;
+}
+
+void SearchContext::prepare(int nodeCount) {
+    if (static_cast<int>(dist.size()) != nodeCount) {
+        dist.assign(nodeCount, kInfinity);
+        prev.assign(nodeCount, -1);
+        potential.assign(nodeCount, 0.0f);
+        touched.clear();
+    }
+    reset();
+}
+
+void SearchContext::reset() {
+    for (int v : touched) {
+        dist[v] = kInfinity;
+        prev[v] = -1;
+        potential[v] = 0.0f;
+    }
+    touched.clear();
+    heap.clear();
+    stats = QueryStats();
+}
+
+namespace {
+
+using HeapEntry = std::pair<float, int>;
+
+// Runs Dijkstra from source until stop(u) returns true for a settled node or
+// the queue empties. Stale heap entries are skipped instead of decreased.
+template <typename Stop>
+void runDijkstra(const Graph& graph, int source, SearchContext& context, Stop stop) {
+    context.prepare(graph.nodeCount());
+    auto& heap = context.heap;
+    auto greater = std::greater<HeapEntry>();
+
+    context.dist[source] = 0;
+    context.touched.push_back(source);
+    heap.emplace_back(0.0f, source);
+    // Counted in locals and stored once, keeping the loop free of stores to context
+    int settled = 0, relaxed = 0, pushes = 1, pops = 0;
+
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [d, u] = heap.back();
+        heap.pop_back();
+        ++pops;
+        if (d > context.dist[u]) continue;
+        ++settled;
+        if (stop(u)) break;
+        relaxed += graph.firstEdge[u + 1] - graph.firstEdge[u];
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            int v = graph.target[e];
+            float alt = d + graph.weight[e];
+            if (alt < context.dist[v]) {
+                if (context.dist[v] == kInfinity) context.touched.push_back(v);
+                context.dist[v] = alt;
+                context.prev[v] = u;
+                heap.emplace_back(alt, v);
+                std::push_heap(heap.begin(), heap.end(), greater);
+                ++pushes;
+            }
+        }
+    }
+    context.stats.settled = settled;
+    context.stats.relaxed = relaxed;
+    context.stats.heapPushes = pushes;
+    context.stats.heapPops = pops;
+}
+
+
+} // namespace
+
+PathResult collectPath(int target, const SearchContext& context) {
+    PathResult result;
+    result.stats = context.stats;
+    result.distance = context.dist[target];
+    if (result.distance != kInfinity) {
+        // Walk the parents twice so the path is allocated once, already in order
+        int length = 0;
+        for (int at = target; at != -1; at = context.prev[at]) ++length;
+        result.path.resize(length);
+        for (int at = target; at != -1; at = context.prev[at]) result.path[--length] = at;
+    }
+    return result;
+}
+
+PathResult shortestPath(const Graph& graph, int source, int target, SearchContext& context) {
+    TRACE_SCOPE_CATEGORY("query", "shortestPath");
+    static QueryMetrics& metrics = queryMetrics("point_to_point");
+    auto queryStart = MetricsClock::now();
+    runDijkstra(graph, source, context, [target](int u) { return u == target; });
+    PathResult result = collectPath(target, context);
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
+
+PathResult shortestPath(const Graph& graph, int source, int target, SearchContext& context,
+                        const SearchControl& control) {
+    TRACE_SCOPE_CATEGORY("query", "shortestPath");
+    static QueryMetrics& metrics = queryMetrics("point_to_point");
+    auto queryStart = MetricsClock::now();
+    bool cancelled = false;
+    int untilCheck = kProgressInterval;
+    runDijkstra(graph, source, context, [&](int u) {
+        if (u == target) return true;
+        if (--untilCheck > 0) return false;
+        untilCheck = kProgressInterval;
+        if (control.cancel && control.cancel->load(std::memory_order_relaxed)) {
+            cancelled = true;
+            return true;
+        }
+        if (control.progress) control.progress(context);
+        return false;
+    });
+    if (cancelled) {
+        PathResult result;
+        result.stats = context.stats;
+        result.cancelled = true;
+        return result;
+    }
+    PathResult result = collectPath(target, context);
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
+
+void shortestPathTree(const Graph& graph, int source, SearchContext& context) {
+    TRACE_SCOPE_CATEGORY("query", "shortestPathTree");
+    static QueryMetrics& metrics = queryMetrics("shortest_path_tree");
+    auto queryStart = MetricsClock::now();
+    runDijkstra(graph, source, context, [](int) { return false; });
+    metrics.record(MetricsClock::now() - queryStart, context.stats, true);
+}
+
+void shortestPathsToTargets(const Graph& graph, int source, const std::vector<char>& isTarget,
+                            int targetCount, SearchContext& context) {
+    TRACE_SCOPE_CATEGORY("query", "shortestPathsToTargets");
+    static QueryMetrics& metrics = queryMetrics("to_targets");
+    auto queryStart = MetricsClock::now();
+    int remaining = targetCount;
+    runDijkstra(graph, source, context, [&](int u) {
+        return isTarget[u] && --remaining == 0;
+    });
+    // Unreachable when some target was never settled
+    metrics.record(MetricsClock::now() - queryStart, context.stats, remaining == 0);
+}
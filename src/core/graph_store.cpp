@@ -0,0 +1,83 @@
+#include "pathfinder/graph_store.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+// Every atomic below is sequentially consistent on purpose. A reader pins
+// (slot = epoch) before loading the version pointer; a writer swaps the
+// pointer, then advances the epoch, then scans the slots. So a reader that
+// loaded a replaced version is always seen pinned at or before the epoch it
+// was retired in, and that version is kept.
+
+namespace {
+
+thread_local size_t slotHint = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+} // namespace
+
+GraphStore::Reader::Reader(Reader&& other) noexcept : slot(other.slot), version(other.version) {
+    other.slot = nullptr;
+}
+
+GraphStore::Reader::~Reader() {
+    if (slot) slot->store(0);
+}
+
+GraphStore::GraphStore(Graph initial) : current(new GraphVersion{1, std::move(initial)}) {}
+
+GraphStore::~GraphStore() {
+    for (auto& [retiredIn, version] : retired) delete version;
+    delete current.load();
+}
+
+GraphStore::Reader GraphStore::read() const {
+    while (true) {
+        for (int i = 0; i < kReaderSlots; ++i) {
+            size_t index = (slotHint + i) % kReaderSlots;
+            uint64_t expected = 0;
+            // A stale epoch here only makes the pin more conservative
+            if (slots[index].epoch.compare_exchange_strong(expected, epoch.load())) {
+                slotHint = index;
+                return Reader(&slots[index].epoch, current.load());
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+uint64_t GraphStore::publish(Graph graph) {
+    TRACE_SCOPE_CATEGORY("build", "publishGraph");
+    std::lock_guard<std::mutex> lock(writerMutex);
+    auto* next = new GraphVersion{current.load()->number + 1, std::move(graph)};
+    const GraphVersion* previous = current.exchange(next);
+    retired.emplace_back(epoch.fetch_add(1), previous);
+    reclaim();
+    return next->number;
+}
+
+uint64_t GraphStore::currentNumber() const {
+    Reader reader = read();
+    return reader.number();
+}
+
+size_t GraphStore::retiredCount() const {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return retired.size();
+}
+
+void GraphStore::reclaim() {
+    uint64_t oldestPinned = UINT64_MAX;
+    for (const Slot& slot : slots) {
+        uint64_t pinned = slot.epoch.load();
+        if (pinned != 0) oldestPinned = std::min(oldestPinned, pinned);
+    }
+    // A version retired in epoch e may be held by readers pinned at e or earlier
+    auto freed = std::remove_if(retired.begin(), retired.end(), [oldestPinned](const auto& entry) {
+        if (entry.first >= oldestPinned) return false;
+        delete entry.second;
+        return true;
+    });
+    retired.erase(freed, retired.end());
+}
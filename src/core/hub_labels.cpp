@@ -0,0 +1,547 @@
+#include "pathfinder/hub_labels.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <queue>
+
+namespace {
+
+struct Arc {
+    int node;
+    float weight;
+};
+
+// The nodes not contracted yet, with the shortcuts added so far
+struct RemainingGraph {
+    std::vector<std::vector<Arc>> out, in;
+
+    explicit RemainingGraph(const Graph& graph) : out(graph.nodeCount()), in(graph.nodeCount()) {
+        for (int u = 0; u < graph.nodeCount(); ++u) {
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                if (graph.target[e] != u) addOrShorten(u, graph.target[e], graph.weight[e]);
+            }
+        }
+    }
+
+    void addOrShorten(int from, int to, float weight) {
+        auto shorten = [](std::vector<Arc>& arcs, int node, float w) {
+            for (Arc& arc : arcs) {
+                if (arc.node == node) {
+                    arc.weight = std::min(arc.weight, w);
+                    return true;
+                }
+            }
+            arcs.push_back({node, w});
+            return false;
+        };
+        shorten(out[from], to, weight);
+        shorten(in[to], from, weight);
+    }
+
+    // Detaches v from its neighbours
+    void remove(int v) {
+        auto drop = [v](std::vector<Arc>& arcs) {
+            arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [v](const Arc& arc) { return arc.node == v; }),
+                       arcs.end());
+        };
+        for (const Arc& arc : out[v]) drop(in[arc.node]);
+        for (const Arc& arc : in[v]) drop(out[arc.node]);
+        std::vector<Arc>().swap(out[v]);
+        std::vector<Arc>().swap(in[v]);
+    }
+};
+
+// Bounded search for a path that avoids the node being contracted and is no
+// longer than the path through it. Giving up early only costs a shortcut, so
+// priority estimates, which run far more often, search less.
+constexpr int kWitnessSettleLimit = 256;
+constexpr int kEstimateSettleLimit = 64;
+
+class WitnessSearch {
+public:
+    explicit WitnessSearch(int nodeCount) : dist(nodeCount, kInfinity) {}
+
+    // Distances from source avoiding skip, exact up to maxDistance for the
+    // nodes settled within the limit; read with distanceTo until the next run
+    void run(const RemainingGraph& graph, int source, int skip, float maxDistance, int settleLimit) {
+        for (int v : touched) dist[v] = kInfinity;
+        touched.assign(1, source);
+        heap.assign(1, {0.0f, source});
+        dist[source] = 0;
+        auto greater = std::greater<std::pair<float, int>>();
+        for (int settled = 0; !heap.empty() && settled < settleLimit; ++settled) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            auto [d, u] = heap.back();
+            heap.pop_back();
+            if (d > dist[u]) continue;
+            if (d > maxDistance) break;
+            for (const Arc& arc : graph.out[u]) {
+                float alt = d + arc.weight;
+                if (arc.node == skip || alt >= dist[arc.node]) continue;
+                if (dist[arc.node] == kInfinity) touched.push_back(arc.node);
+                dist[arc.node] = alt;
+                heap.emplace_back(alt, arc.node);
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+    }
+
+    float distanceTo(int v) const { return dist[v]; }
+
+private:
+    std::vector<float> dist;
+    std::vector<int> touched;
+    std::vector<std::pair<float, int>> heap;
+};
+
+struct Shortcut {
+    int from, to;
+    float weight;
+};
+
+// Shortcuts that contracting v would need, appended to shortcuts when given;
+// a count alone is an estimate
+int countShortcuts(const RemainingGraph& graph, int v, WitnessSearch& witness, std::vector<Shortcut>* shortcuts) {
+    int count = 0;
+    for (const Arc& in : graph.in[v]) {
+        float longest = 0;
+        for (const Arc& out : graph.out[v]) {
+            if (out.node != in.node) longest = std::max(longest, in.weight + out.weight);
+        }
+        if (longest == 0) continue;
+        witness.run(graph, in.node, v, longest, shortcuts ? kWitnessSettleLimit : kEstimateSettleLimit);
+        for (const Arc& out : graph.out[v]) {
+            float through = in.weight + out.weight;
+            if (out.node == in.node || witness.distanceTo(out.node) <= through) continue;
+            ++count;
+            if (shortcuts) shortcuts->push_back({in.node, out.node, through});
+        }
+    }
+    return count;
+}
+
+// Pruned Dijkstra from hub over searched. Each node reached gets (rank, d)
+// appended to its label in grown unless hubLabel and that label already
+// cover d; covered nodes are not expanded. scratch is all kInfinity on entry
+// and on return.
+void prunedSearch(const Graph& searched, int hub, int rank, const std::vector<HubLabel>& hubLabel,
+                  std::vector<std::vector<HubLabel>>& grown, std::vector<std::vector<int>>* parents,
+                  std::vector<float>& scratch, SearchContext& context) {
+    for (const HubLabel& entry : hubLabel) scratch[entry.hub] = entry.distance;
+    context.prepare(searched.nodeCount());
+    auto& heap = context.heap;
+    auto greater = std::greater<std::pair<float, int>>();
+    context.dist[hub] = 0;
+    context.touched.push_back(hub);
+    heap.emplace_back(0.0f, hub);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [d, u] = heap.back();
+        heap.pop_back();
+        if (d > context.dist[u]) continue;
+
+        float covered = kInfinity;
+        for (const HubLabel& entry : grown[u]) covered = std::min(covered, scratch[entry.hub] + entry.distance);
+        if (covered <= d) continue;
+        grown[u].push_back({rank, d});
+        if (parents) (*parents)[u].push_back(context.prev[u]);
+
+        for (int e = searched.firstEdge[u]; e < searched.firstEdge[u + 1]; ++e) {
+            int v = searched.target[e];
+            float alt = d + searched.weight[e];
+            if (alt < context.dist[v]) {
+                if (context.dist[v] == kInfinity) context.touched.push_back(v);
+                context.dist[v] = alt;
+                context.prev[v] = u;
+                heap.emplace_back(alt, v);
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+    }
+    for (const HubLabel& entry : hubLabel) scratch[entry.hub] = kInfinity;
+}
+
+// Concatenates per-node labels, closing each with a kLabelEnd entry
+void flatten(std::vector<std::vector<HubLabel>>& labels, std::vector<std::vector<int>>& parents, bool withParents,
+             std::vector<int>& start, std::vector<HubLabel>& flat, std::vector<int>& flatParents) {
+    const int n = static_cast<int>(labels.size());
+    start.assign(n + 1, 0);
+    for (int v = 0; v < n; ++v) start[v + 1] = start[v] + static_cast<int>(labels[v].size()) + 1;
+    flat.clear();
+    flat.reserve(start[n]);
+    flatParents.clear();
+    if (withParents) flatParents.reserve(start[n]);
+    for (int v = 0; v < n; ++v) {
+        flat.insert(flat.end(), labels[v].begin(), labels[v].end());
+        flat.push_back({kLabelEnd, kInfinity});
+        std::vector<HubLabel>().swap(labels[v]);
+        if (withParents) {
+            flatParents.insert(flatParents.end(), parents[v].begin(), parents[v].end());
+            flatParents.push_back(-1);
+            std::vector<int>().swap(parents[v]);
+        }
+    }
+}
+
+struct Meeting {
+    float distance = kInfinity;
+    int outEntry = -1; // entries of the best common hub
+    int inEntry = -1;
+    int scanned = 0;
+};
+
+// Merges the out-label of source with the in-label of target. Both end with
+// kLabelEnd, so the loop only has to check for the end on equal hubs.
+inline Meeting meet(const HubLabels& labels, int source, int target) {
+    const HubLabel* outBegin = labels.outLabels.data() + labels.outStart[source];
+    const HubLabel* inBegin = labels.inLabels.data() + labels.inStart[target];
+    const HubLabel* a = outBegin;
+    const HubLabel* b = inBegin;
+    Meeting best;
+    while (true) {
+        if (a->hub == b->hub) {
+            if (a->hub == kLabelEnd) break;
+            float through = a->distance + b->distance;
+            if (through < best.distance) {
+                best.distance = through;
+                best.outEntry = static_cast<int>(a - labels.outLabels.data());
+                best.inEntry = static_cast<int>(b - labels.inLabels.data());
+            }
+            ++a;
+            ++b;
+        } else if (a->hub < b->hub) {
+            ++a;
+        } else {
+            ++b;
+        }
+    }
+    best.scanned = static_cast<int>((a - outBegin) + (b - inBegin));
+    return best;
+}
+
+// Index of hub's entry in v's label, -1 if absent
+int findEntry(const std::vector<int>& start, const std::vector<HubLabel>& flat, int v, int hub) {
+    auto first = flat.begin() + start[v];
+    auto last = flat.begin() + start[v + 1] - 1;
+    auto it = std::lower_bound(first, last, hub, [](const HubLabel& entry, int h) { return entry.hub < h; });
+    if (it == last || it->hub != hub) return -1;
+    return static_cast<int>(it - flat.begin());
+}
+
+void putU32(std::vector<char>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>(v >> (8 * i)));
+}
+
+void putU64(std::vector<char>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>(v >> (8 * i)));
+}
+
+void putVarint(std::vector<char>& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+uint32_t zigzag(int32_t v) { return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31); }
+int32_t unzigzag(uint32_t v) { return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1); }
+
+void putLabels(std::vector<char>& out, const std::vector<int>& start, const std::vector<HubLabel>& flat,
+               const std::vector<int>& parents, bool withParents) {
+    const int n = static_cast<int>(start.size()) - 1;
+    for (int v = 0; v < n; ++v) {
+        int first = start[v], last = start[v + 1] - 1; // without the end marker
+        putVarint(out, static_cast<uint32_t>(last - first));
+        int previous = 0;
+        for (int i = first; i < last; ++i) {
+            putVarint(out, static_cast<uint32_t>(flat[i].hub - previous));
+            previous = flat[i].hub;
+        }
+        for (int i = first; i < last; ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, &flat[i].distance, sizeof bits);
+            putU32(out, bits);
+        }
+        if (withParents) {
+            for (int i = first; i < last; ++i) putVarint(out, zigzag(parents[i] - v));
+        }
+    }
+}
+
+// Bounds-checked reads; once a read fails, ok stays false and reads give 0
+struct Reader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint32_t u32() {
+        if (size - pos < 4) return fail();
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(data[pos++]) << (8 * i);
+        return v;
+    }
+    uint64_t u64() {
+        uint64_t low = u32();
+        return low | static_cast<uint64_t>(u32()) << 32;
+    }
+    uint32_t varint() {
+        uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (pos >= size) return fail();
+            uint8_t byte = data[pos++];
+            v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+        return fail();
+    }
+    uint32_t fail() {
+        ok = false;
+        pos = size;
+        return 0;
+    }
+};
+
+bool readLabels(Reader& in, int n, bool withParents, std::vector<int>& start, std::vector<HubLabel>& flat,
+                std::vector<int>& parents) {
+    start.assign(n + 1, 0);
+    flat.clear();
+    parents.clear();
+    for (int v = 0; v < n && in.ok; ++v) {
+        uint32_t size = in.varint();
+        if (size > static_cast<uint32_t>(n)) return false;
+        size_t first = flat.size();
+        int hub = 0;
+        for (uint32_t i = 0; i < size; ++i) {
+            hub += static_cast<int>(in.varint());
+            if (hub < 0 || hub >= n || (i > 0 && hub <= flat.back().hub)) return false;
+            flat.push_back({hub, 0.0f});
+        }
+        for (uint32_t i = 0; i < size; ++i) {
+            uint32_t bits = in.u32();
+            std::memcpy(&flat[first + i].distance, &bits, sizeof bits);
+        }
+        if (withParents) {
+            for (uint32_t i = 0; i < size; ++i) {
+                int parent = v + unzigzag(in.varint());
+                if (parent < -1 || parent >= n) return false;
+                parents.push_back(parent);
+            }
+            parents.push_back(-1);
+        }
+        flat.push_back({kLabelEnd, kInfinity});
+        start[v + 1] = static_cast<int>(flat.size());
+    }
+    return in.ok;
+}
+
+} // namespace
+
+double HubLabels::averageLabelSize() const {
+    if (order.empty()) return 0;
+    double entries = static_cast<double>(outLabels.size() + inLabels.size()) - 2.0 * nodeCount();
+    return entries / (2.0 * nodeCount());
+}
+
+size_t HubLabels::memoryBytes() const {
+    return (outLabels.size() + inLabels.size()) * sizeof(HubLabel) +
+           (outParent.size() + inParent.size() + outStart.size() + inStart.size() + order.size()) * sizeof(int);
+}
+
+std::vector<int> contractionOrder(const Graph& graph) {
+    TRACE_SCOPE_CATEGORY("build", "contractionOrder");
+    const int n = graph.nodeCount();
+    RemainingGraph remaining(graph);
+    WitnessSearch witness(n);
+    std::vector<int> contractedNeighbours(n, 0);
+    // Edge difference, plus a term that spreads contraction evenly
+    auto priority = [&](int v) {
+        int degree = static_cast<int>(remaining.in[v].size() + remaining.out[v].size());
+        return 2 * (countShortcuts(remaining, v, witness, nullptr) - degree) + contractedNeighbours[v];
+    };
+
+    using Entry = std::pair<int, int>; // (priority, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (int v = 0; v < n; ++v) queue.emplace(priority(v), v);
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<char> contracted(n, 0);
+    std::vector<Shortcut> shortcuts;
+    while (!queue.empty()) {
+        int v = queue.top().second;
+        queue.pop();
+        if (contracted[v]) continue;
+        // Priorities go stale as neighbours are contracted; recheck lazily
+        int current = priority(v);
+        if (!queue.empty() && current > queue.top().first) {
+            queue.emplace(current, v);
+            continue;
+        }
+        shortcuts.clear();
+        countShortcuts(remaining, v, witness, &shortcuts);
+        for (const Arc& arc : remaining.in[v]) ++contractedNeighbours[arc.node];
+        for (const Arc& arc : remaining.out[v]) ++contractedNeighbours[arc.node];
+        remaining.remove(v);
+        for (const Shortcut& shortcut : shortcuts) remaining.addOrShorten(shortcut.from, shortcut.to, shortcut.weight);
+        contracted[v] = 1;
+        order.push_back(v);
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+HubLabels buildHubLabels(const Graph& graph, bool withParents) {
+    return buildHubLabels(graph, contractionOrder(graph), withParents);
+}
+
+HubLabels buildHubLabels(const Graph& graph, const std::vector<int>& order, bool withParents) {
+    TRACE_SCOPE_CATEGORY("build", "buildHubLabels");
+    const int n = graph.nodeCount();
+    HubLabels labels;
+    labels.order = order;
+    labels.fingerprint = graphFingerprint(graph);
+    Graph reversed = reverseGraph(graph);
+
+    std::vector<std::vector<HubLabel>> out(n), in(n);
+    std::vector<std::vector<int>> outParents(withParents ? n : 0), inParents(withParents ? n : 0);
+    std::vector<float> scratch(n, kInfinity);
+    SearchContext context;
+    for (int rank = 0; rank < n; ++rank) {
+        int hub = labels.order[rank];
+        // Forward search fills in-labels d(hub, v); the backward search on the
+        // reversed graph fills out-labels d(v, hub)
+        prunedSearch(graph, hub, rank, out[hub], in, withParents ? &inParents : nullptr, scratch, context);
+        prunedSearch(reversed, hub, rank, in[hub], out, withParents ? &outParents : nullptr, scratch, context);
+    }
+    flatten(out, outParents, withParents, labels.outStart, labels.outLabels, labels.outParent);
+    flatten(in, inParents, withParents, labels.inStart, labels.inLabels, labels.inParent);
+    return labels;
+}
+
+uint64_t graphFingerprint(const Graph& graph) {
+    // FNV-1a over the arc arrays
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint32_t word) {
+        for (int i = 0; i < 4; ++i) {
+            hash ^= (word >> (8 * i)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(static_cast<uint32_t>(graph.nodeCount()));
+    for (int offset : graph.firstEdge) mix(static_cast<uint32_t>(offset));
+    for (int v : graph.target) mix(static_cast<uint32_t>(v));
+    for (float w : graph.weight) {
+        uint32_t bits;
+        std::memcpy(&bits, &w, sizeof bits);
+        mix(bits);
+    }
+    return hash;
+}
+
+float hubDistance(const HubLabels& labels, int source, int target) {
+    return meet(labels, source, target).distance;
+}
+
+PathResult hubShortestPath(const HubLabels& labels, int source, int target) {
+    TRACE_SCOPE_CATEGORY("query", "hubShortestPath");
+    static QueryMetrics& metrics = queryMetrics("hub_labels");
+    auto queryStart = MetricsClock::now();
+    Meeting meeting = meet(labels, source, target);
+    PathResult result;
+    result.distance = meeting.distance;
+    result.stats.relaxed = meeting.scanned;
+
+    if (meeting.distance != kInfinity && labels.hasParents()) {
+        int rank = labels.outLabels[meeting.outEntry].hub;
+        int hub = labels.order[rank];
+        // source -> hub along out-label parents, then hub -> target by walking
+        // the in-label parents back from target. Every node on those paths
+        // was expanded by the hub's search, so each has an entry for it.
+        bool complete = true;
+        for (int v = source, entry = meeting.outEntry; complete;) {
+            result.path.push_back(v);
+            if (v == hub) break;
+            v = labels.outParent[entry];
+            entry = v < 0 ? -1 : findEntry(labels.outStart, labels.outLabels, v, rank);
+            complete = entry >= 0;
+        }
+        size_t middle = result.path.size();
+        for (int v = target, entry = meeting.inEntry; complete && v != hub;) {
+            result.path.push_back(v);
+            v = labels.inParent[entry];
+            entry = v < 0 ? -1 : findEntry(labels.inStart, labels.inLabels, v, rank);
+            complete = entry >= 0;
+        }
+        std::reverse(result.path.begin() + middle, result.path.end());
+        if (!complete) result.path.clear(); // labels do not belong to one graph
+    }
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
+
+bool saveHubLabels(const HubLabels& labels, const std::string& path) {
+    TRACE_SCOPE_CATEGORY("io", "saveHubLabels");
+    const int n = labels.nodeCount();
+    bool withParents = labels.hasParents();
+    std::vector<char> bytes = {'P', 'F', 'H', 'L'};
+    putU32(bytes, 1);
+    putU32(bytes, static_cast<uint32_t>(n));
+    putU32(bytes, withParents ? 1 : 0);
+    putU64(bytes, labels.fingerprint);
+    for (int v : labels.order) putVarint(bytes, static_cast<uint32_t>(v));
+    putLabels(bytes, labels.outStart, labels.outLabels, labels.outParent, withParents);
+    putLabels(bytes, labels.inStart, labels.inLabels, labels.inParent, withParents);
+
+    std::ofstream outFile(path, std::ios::binary);
+    if (!outFile) return false;
+    outFile.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(outFile);
+}
+
+bool loadHubLabels(HubLabels& labels, const std::string& path) {
+    TRACE_SCOPE_CATEGORY("io", "loadHubLabels");
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile) {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+    Reader in{bytes.data(), bytes.size()};
+    if (bytes.size() < 4 || std::memcmp(bytes.data(), "PFHL", 4) != 0) in.fail();
+    else in.pos = 4;
+    uint32_t version = in.u32();
+    uint32_t n = in.u32();
+    uint32_t flags = in.u32();
+    uint64_t fingerprint = in.u64();
+    // Every node takes at least two bytes per label
+    if (!in.ok || version != 1 || n > bytes.size()) {
+        std::cerr << "Malformed hub label file " << path << "\n";
+        return false;
+    }
+
+    HubLabels loaded;
+    loaded.fingerprint = fingerprint;
+    loaded.order.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        loaded.order[i] = static_cast<int>(in.varint());
+        if (loaded.order[i] < 0 || loaded.order[i] >= static_cast<int>(n)) in.fail();
+    }
+    bool withParents = flags & 1;
+    int nodes = static_cast<int>(n);
+    if (!in.ok ||
+        !readLabels(in, nodes, withParents, loaded.outStart, loaded.outLabels, loaded.outParent) ||
+        !readLabels(in, nodes, withParents, loaded.inStart, loaded.inLabels, loaded.inParent) ||
+        in.pos != bytes.size()) {
+        std::cerr << "Malformed hub label file " << path << "\n";
+        return false;
+    }
+    labels = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,274 @@
+#include "pathfinder/k_shortest.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace {
+
+struct Route {
+    std::vector<int> path;
+    std::vector<float> cost; // cost[i]: from the source to path[i]
+    int deviation = 0;       // first index where it leaves its parent's path
+};
+
+// Accepted paths merged on common prefixes. The children of the entry an
+// accepted path reaches at index i are the arcs out of path[i] that paths
+// with that prefix took, which is what a spur at i must avoid.
+struct PrefixTree {
+    std::vector<int> node;
+    std::vector<std::vector<int>> children;
+
+    // Adds path and returns the entry of each of its indices
+    std::vector<int> insert(const std::vector<int>& path) {
+        if (node.empty()) {
+            node.push_back(path[0]);
+            children.emplace_back();
+        }
+        std::vector<int> entries(1, 0);
+        for (size_t i = 1; i < path.size(); ++i) {
+            int at = entries.back(), next = -1;
+            for (int child : children[at]) {
+                if (node[child] == path[i]) next = child;
+            }
+            if (next < 0) {
+                next = static_cast<int>(node.size());
+                node.push_back(path[i]);
+                children.emplace_back();
+                children[at].push_back(next);
+            }
+            entries.push_back(next);
+        }
+        return entries;
+    }
+};
+
+// Queue entry: a spur still to be searched, keyed by its lower bound, or a
+// found candidate keyed by its cost. Candidates go first on equal keys.
+struct Entry {
+    float key;
+    bool found;
+    int index; // accepted path of the spur, or candidate
+    int spur;
+
+    bool operator>(const Entry& other) const {
+        if (key != other.key) return key > other.key;
+        return !found && other.found;
+    }
+};
+
+// Shortest path from spur to target that avoids blocked nodes and the arcs
+// from spur to any of avoid, as an A* over the exact distances toTarget of
+// the unrestricted graph. Appends it (without spur) to route, costs offset
+// by route's last cost.
+bool searchSpur(const Graph& graph, const SearchContext& tree, int spur, int target,
+                const std::vector<char>& blocked, const std::vector<int>& avoid, SearchContext& context,
+                Route& route, QueryStats& stats) {
+    const std::vector<float>& toTarget = tree.dist;
+    const float base = route.cost.back();
+    auto avoided = [&](int v) { return std::find(avoid.begin(), avoid.end(), v) != avoid.end(); };
+
+    // No route beats the best allowed first arc followed by the tree, so when
+    // that tree path (parents in the reversed graph are next hops towards
+    // the target) avoids the prefix and spur, it is the answer
+    int first = -1;
+    float firstCost = kInfinity;
+    for (int e = graph.firstEdge[spur]; e < graph.firstEdge[spur + 1]; ++e) {
+        int v = graph.target[e];
+        if (blocked[v] || avoided(v) || graph.weight[e] + toTarget[v] >= firstCost) continue;
+        first = v;
+        firstCost = graph.weight[e] + toTarget[v];
+    }
+    if (first < 0) return false;
+    bool treeClear = true;
+    for (int v = first; treeClear && v != -1; v = tree.prev[v]) treeClear = !blocked[v] && v != spur;
+    if (treeClear) {
+        for (int v = first; v != -1; v = tree.prev[v]) {
+            route.path.push_back(v);
+            route.cost.push_back(base + firstCost - toTarget[v]);
+        }
+        return true;
+    }
+
+    context.prepare(graph.nodeCount());
+    auto& heap = context.heap;
+    auto greater = std::greater<std::pair<float, int>>();
+    context.dist[spur] = 0;
+    context.touched.push_back(spur);
+    heap.emplace_back(toTarget[spur], spur);
+    int settled = 0, relaxed = 0, pushes = 1, pops = 0;
+    bool reached = false;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [key, u] = heap.back();
+        heap.pop_back();
+        ++pops;
+        float d = context.dist[u];
+        if (key > d + toTarget[u]) continue;
+        ++settled;
+        if (u == target) {
+            reached = true;
+            break;
+        }
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            int v = graph.target[e];
+            // Nodes with no way to the target can never help
+            if (blocked[v] || toTarget[v] == kInfinity || (u == spur && avoided(v))) continue;
+            ++relaxed;
+            float alt = d + graph.weight[e];
+            if (alt < context.dist[v]) {
+                if (context.dist[v] == kInfinity) context.touched.push_back(v);
+                context.dist[v] = alt;
+                context.prev[v] = u;
+                heap.emplace_back(alt + toTarget[v], v);
+                std::push_heap(heap.begin(), heap.end(), greater);
+                ++pushes;
+            }
+        }
+    }
+    stats.settled += settled;
+    stats.relaxed += relaxed;
+    stats.heapPushes += pushes;
+    stats.heapPops += pops;
+    if (!reached) return false;
+
+    const size_t start = route.path.size();
+    for (int v = target; v != spur; v = context.prev[v]) {
+        route.path.push_back(v);
+        route.cost.push_back(base + context.dist[v]);
+    }
+    std::reverse(route.path.begin() + start, route.path.end());
+    std::reverse(route.cost.begin() + start, route.cost.end());
+    return true;
+}
+
+} // namespace
+
+std::vector<PathResult> kShortestPaths(const Graph& graph, const Graph& reversed, int source, int target, int k,
+                                       KShortestSearch& search, ThreadPool& pool, const SearchControl* control) {
+    TRACE_SCOPE_CATEGORY("query", "kShortestPaths");
+    static QueryMetrics& metrics = queryMetrics("k_shortest");
+    auto queryStart = MetricsClock::now();
+    const int n = graph.nodeCount();
+    std::vector<PathResult> paths;
+
+    shortestPathTree(reversed, target, search.tree);
+    const SearchContext& tree = search.tree;
+    QueryStats stats = tree.stats;
+    if (k <= 0 || tree.dist[source] == kInfinity) {
+        metrics.record(MetricsClock::now() - queryStart, stats, false);
+        return paths;
+    }
+    search.spurs.resize(pool.size());
+    for (auto& spur : search.spurs) {
+        if (spur.blocked.size() != static_cast<size_t>(n)) spur.blocked.assign(n, 0);
+    }
+    if (search.position.size() != static_cast<size_t>(n)) search.position.assign(n, -1);
+
+    std::vector<Route> accepted, candidates;
+    std::vector<std::vector<int>> entries; // prefix tree entry per accepted path and index
+    PrefixTree prefixes;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    auto accept = [&](Route route) {
+        const int j = static_cast<int>(accepted.size());
+        entries.push_back(prefixes.insert(route.path));
+        // Lower bound of each spur: its prefix, the cheapest arc it may take,
+        // then the unrestricted tree. It is exact whenever that tree path
+        // avoids the prefix, and a spur with no arc left is dropped.
+        std::vector<int>& position = search.position;
+        for (size_t i = 0; i < route.path.size(); ++i) position[route.path[i]] = static_cast<int>(i);
+        for (size_t i = route.deviation; i + 1 < route.path.size(); ++i) {
+            const std::vector<int>& children = prefixes.children[entries[j][i]];
+            const int spur = route.path[i];
+            float bound = kInfinity;
+            for (int e = graph.firstEdge[spur]; e < graph.firstEdge[spur + 1]; ++e) {
+                int v = graph.target[e];
+                if ((position[v] >= 0 && position[v] < static_cast<int>(i)) || tree.dist[v] == kInfinity) continue;
+                if (std::any_of(children.begin(), children.end(), [&](int c) { return prefixes.node[c] == v; }))
+                    continue;
+                bound = std::min(bound, graph.weight[e] + tree.dist[v]);
+            }
+            if (bound != kInfinity) queue.push(Entry{route.cost[i] + bound, false, j, static_cast<int>(i)});
+        }
+        for (int v : route.path) position[v] = -1;
+        accepted.push_back(std::move(route));
+    };
+
+    Route shortest;
+    for (int v = source; v != -1; v = tree.prev[v]) {
+        shortest.path.push_back(v);
+        shortest.cost.push_back(tree.dist[source] - tree.dist[v]);
+    }
+    accept(std::move(shortest));
+
+    std::vector<Entry> batch;
+    std::vector<Route> found;
+    std::vector<char> reached;
+    std::vector<QueryStats> spurStats;
+    while (static_cast<int>(accepted.size()) < k && !queue.empty()) {
+        if (control && control->cancel && control->cancel->load(std::memory_order_relaxed)) {
+            PathResult cancelled;
+            cancelled.stats = stats;
+            cancelled.cancelled = true;
+            paths.push_back(std::move(cancelled));
+            return paths;
+        }
+        if (queue.top().found) {
+            int index = queue.top().index;
+            queue.pop();
+            accept(std::move(candidates[index]));
+            continue;
+        }
+        // Search the spurs at the front together, up to one per worker
+        batch.clear();
+        while (!queue.empty() && !queue.top().found && batch.size() < search.spurs.size()) {
+            batch.push_back(queue.top());
+            queue.pop();
+        }
+        found.assign(batch.size(), Route());
+        reached.assign(batch.size(), 0);
+        spurStats.assign(batch.size(), QueryStats());
+        for (size_t b = 0; b < batch.size(); ++b) {
+            pool.submit([&, b] {
+                KShortestSearch::Spur& scratch = search.spurs[ThreadPool::workerIndex()];
+                const Route& parent = accepted[batch[b].index];
+                const int i = batch[b].spur;
+                const std::vector<int>& children = prefixes.children[entries[batch[b].index][i]];
+                std::vector<int> avoid;
+                avoid.reserve(children.size());
+                for (int child : children) avoid.push_back(prefixes.node[child]);
+                for (int r = 0; r < i; ++r) scratch.blocked[parent.path[r]] = 1;
+
+                Route& route = found[b];
+                route.path.assign(parent.path.begin(), parent.path.begin() + i + 1);
+                route.cost.assign(parent.cost.begin(), parent.cost.begin() + i + 1);
+                route.deviation = i;
+                reached[b] = searchSpur(graph, tree, parent.path[i], target, scratch.blocked, avoid, scratch.context,
+                                        route, spurStats[b]);
+                for (int r = 0; r < i; ++r) scratch.blocked[parent.path[r]] = 0;
+            });
+        }
+        pool.wait();
+        for (size_t b = 0; b < batch.size(); ++b) {
+            stats.settled += spurStats[b].settled;
+            stats.relaxed += spurStats[b].relaxed;
+            stats.heapPushes += spurStats[b].heapPushes;
+            stats.heapPops += spurStats[b].heapPops;
+            if (!reached[b]) continue;
+            queue.push(Entry{found[b].cost.back(), true, static_cast<int>(candidates.size()), 0});
+            candidates.push_back(std::move(found[b]));
+        }
+    }
+
+    for (Route& route : accepted) {
+        PathResult result;
+        result.distance = route.cost.back();
+        result.path = std::move(route.path);
+        result.stats = stats;
+        paths.push_back(std::move(result));
+    }
+    metrics.record(MetricsClock::now() - queryStart, stats, true);
+    return paths;
+}
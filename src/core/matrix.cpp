@@ -0,0 +1,113 @@
+#include "pathfinder/matrix.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+DistanceMatrix computeDistanceMatrix(const Graph& graph,
+                                     const std::vector<int>& sources,
+                                     const std::vector<int>& targets,
+                                     unsigned threadCount) {
+    TRACE_SCOPE_CATEGORY("query", "computeDistanceMatrix");
+    DistanceMatrix matrix;
+    matrix.sources = sources;
+    matrix.targets = targets;
+    matrix.values.assign(sources.size() * targets.size(), kInfinity);
+    if (sources.empty() || targets.empty()) return matrix;
+
+    std::vector<char> isTarget(graph.nodeCount(), 0);
+    int distinctTargets = 0;
+    for (int t : targets) {
+        if (!isTarget[t]) {
+            isTarget[t] = 1;
+            ++distinctTargets;
+        }
+    }
+
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<unsigned>(threadCount, static_cast<unsigned>(sources.size()));
+
+    // Rows are claimed one at a time so uneven search costs balance out
+    std::atomic<size_t> nextRow{0};
+    auto worker = [&] {
+        SearchContext context;
+        for (size_t row = nextRow++; row < sources.size(); row = nextRow++) {
+            shortestPathsToTargets(graph, sources[row], isTarget, distinctTargets, context);
+            float* out = &matrix.values[row * targets.size()];
+            for (size_t column = 0; column < targets.size(); ++column) {
+                out[column] = context.dist[targets[column]];
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back([&worker, i] {
+            setTraceThreadName("matrix worker " + std::to_string(i));
+            worker();
+        });
+    }
+    worker();
+    for (auto& t : threads) t.join();
+    return matrix;
+}
+
+bool writeMatrixCsv(const DistanceMatrix& matrix, const std::string& path) {
+    std::FILE* out = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fputs("source", out);
+    for (int t : matrix.targets) std::fprintf(out, ",n%d", t);
+    std::fputc('\n', out);
+    for (size_t row = 0; row < matrix.sources.size(); ++row) {
+        std::fprintf(out, "n%d", matrix.sources[row]);
+        for (size_t column = 0; column < matrix.targets.size(); ++column) {
+            float d = matrix.at(row, column);
+            if (d == kInfinity) std::fputc(',', out);
+            else std::fprintf(out, ",%.3f", d);
+        }
+        std::fputc('\n', out);
+    }
+    bool ok = !std::ferror(out);
+    if (out != stdout) ok = std::fclose(out) == 0 && ok;
+    return ok;
+}
+
+namespace {
+
+void putU32(std::vector<char>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>(v >> (8 * i)));
+}
+
+} // namespace
+
+bool writeMatrixBinary(const DistanceMatrix& matrix, const std::string& path) {
+    std::vector<char> bytes = {'P', 'F', 'D', 'M'};
+    putU32(bytes, 1);
+    putU32(bytes, static_cast<uint32_t>(matrix.sources.size()));
+    putU32(bytes, static_cast<uint32_t>(matrix.targets.size()));
+    for (int s : matrix.sources) putU32(bytes, static_cast<uint32_t>(s));
+    for (int t : matrix.targets) putU32(bytes, static_cast<uint32_t>(t));
+
+    std::ofstream outFile(path, std::ios::binary);
+    if (!outFile) return false;
+    outFile.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+    // Values go out in row-sized chunks to avoid a second full copy
+    std::vector<char> row;
+    for (size_t r = 0; r < matrix.sources.size(); ++r) {
+        row.clear();
+        for (size_t c = 0; c < matrix.targets.size(); ++c) {
+            uint32_t bits;
+            float d = matrix.at(r, c);
+            std::memcpy(&bits, &d, sizeof bits);
+            putU32(row, bits);
+        }
+        outFile.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    return static_cast<bool>(outFile);
+}
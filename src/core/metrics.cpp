@@ -0,0 +1,226 @@
+#include "pathfinder/metrics.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+
+namespace {
+
+int highestBit(uint64_t v) {
+    int bit = 0;
+    while (v >>= 1) ++bit;
+    return bit;
+}
+
+std::string withLabels(const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) return "";
+    if (labels.empty()) return "{" + extra + "}";
+    if (extra.empty()) return "{" + labels + "}";
+    return "{" + labels + "," + extra + "}";
+}
+
+void appendSample(std::string& out, const std::string& name, const std::string& labels, double value) {
+    char number[32];
+    std::snprintf(number, sizeof number, "%.9g", value);
+    out += name;
+    out += labels;
+    out += ' ';
+    out += number;
+    out += '\n';
+}
+
+double toSeconds(uint64_t nanoseconds) { return nanoseconds / 1e9; }
+
+} // namespace
+
+int LatencyHistogram::bucketIndex(uint64_t nanoseconds) {
+    if (nanoseconds < kLinearBuckets) return static_cast<int>(nanoseconds);
+    uint64_t limit = (uint64_t(1) << kMaxExponent) - 1;
+    if (nanoseconds > limit) nanoseconds = limit;
+    int shift = highestBit(nanoseconds) - 6; // leaves the top 7 bits, 64..127
+    return kLinearBuckets + (shift - 1) * kSubBuckets + static_cast<int>((nanoseconds >> shift) - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < kLinearBuckets) return static_cast<uint64_t>(index);
+    int k = index - kLinearBuckets;
+    int shift = k / kSubBuckets + 1;
+    uint64_t sub = static_cast<uint64_t>(k % kSubBuckets + kSubBuckets);
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    buckets[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t seen = maximum.load(std::memory_order_relaxed);
+    while (nanoseconds > seen && !maximum.compare_exchange_weak(seen, nanoseconds, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::record(MetricsClock::duration elapsed) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    record(static_cast<uint64_t>(ns > 0 ? ns : 0));
+}
+
+uint64_t LatencyHistogram::quantile(double q) const {
+    // Buckets are read one by one while other threads record, so the counts
+    // may not add up to total exactly; clamp the rank to what was seen.
+    std::array<uint64_t, kBucketCount> counts;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        seen += counts[i];
+    }
+    if (seen == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(q * seen + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > seen) rank = seen;
+
+    uint64_t cumulative = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        cumulative += counts[i];
+        if (cumulative >= rank) {
+            uint64_t bound = bucketUpperBound(i);
+            uint64_t highest = maxNanoseconds();
+            return bound < highest ? bound : highest;
+        }
+    }
+    return maxNanoseconds();
+}
+
+MetricsRegistry::Series& MetricsRegistry::series(Kind kind, const std::string& name,
+                                                 const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family* family = nullptr;
+    for (auto& f : families) {
+        if (f->name == name) family = f.get();
+    }
+    if (!family) {
+        families.push_back(std::make_unique<Family>(Family{name, help, kind, {}}));
+        family = families.back().get();
+    }
+    for (auto& s : family->series) {
+        if (s->labels == labels) return *s;
+    }
+    family->series.push_back(std::make_unique<Series>());
+    Series& created = *family->series.back();
+    created.labels = labels;
+    switch (family->kind) {
+        case Kind::Counter: created.counter = std::make_unique<Counter>(); break;
+        case Kind::Gauge: created.gauge = std::make_unique<Gauge>(); break;
+        case Kind::Histogram: created.histogram = std::make_unique<LatencyHistogram>(); break;
+    }
+    return created;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    return *series(Kind::Counter, name, help, labels).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    return *series(Kind::Gauge, name, help, labels).gauge;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                             const std::string& labels) {
+    return *series(Kind::Histogram, name, help, labels).histogram;
+}
+
+std::string MetricsRegistry::prometheusText() const {
+    static const std::pair<double, const char*> kQuantiles[] = {
+        {0.5, "0.5"}, {0.9, "0.9"}, {0.99, "0.99"}, {0.999, "0.999"}};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    for (const auto& family : families) {
+        const std::string& name = family->name;
+        out += "# HELP " + name + " " + family->help + "\n";
+        switch (family->kind) {
+            case Kind::Counter:
+                out += "# TYPE " + name + " counter\n";
+                for (const auto& s : family->series)
+                    appendSample(out, name, withLabels(s->labels), static_cast<double>(s->counter->value()));
+                break;
+            case Kind::Gauge:
+                out += "# TYPE " + name + " gauge\n";
+                for (const auto& s : family->series)
+                    appendSample(out, name, withLabels(s->labels), static_cast<double>(s->gauge->value()));
+                break;
+            case Kind::Histogram:
+                out += "# TYPE " + name + " summary\n";
+                for (const auto& s : family->series) {
+                    const LatencyHistogram& h = *s->histogram;
+                    for (const auto& [q, text] : kQuantiles) {
+                        appendSample(out, name, withLabels(s->labels, std::string("quantile=\"") + text + "\""),
+                                     toSeconds(h.quantile(q)));
+                    }
+                    appendSample(out, name + "_sum", withLabels(s->labels), toSeconds(h.sumNanoseconds()));
+                    appendSample(out, name + "_count", withLabels(s->labels), static_cast<double>(h.count()));
+                }
+                out += "# TYPE " + name + "_max gauge\n";
+                for (const auto& s : family->series)
+                    appendSample(out, name + "_max", withLabels(s->labels), toSeconds(s->histogram->maxNanoseconds()));
+                break;
+        }
+    }
+    return out;
+}
+
+bool MetricsRegistry::writePrometheusFile(const std::string& path) const {
+    std::string text = prometheusText();
+    if (path == "-") {
+        std::fwrite(text.data(), 1, text.size(), stdout);
+        return std::fflush(stdout) == 0;
+    }
+    std::string temporary = path + ".tmp";
+    std::FILE* out = std::fopen(temporary.c_str(), "w");
+    if (!out) return false;
+    bool ok = std::fwrite(text.data(), 1, text.size(), out) == text.size();
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+MetricsRegistry& metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void QueryMetrics::record(MetricsClock::duration elapsed, const QueryStats& stats, bool reachable) {
+    latency.record(elapsed);
+    queries.add();
+    if (!reachable) unreachable.add();
+    settled.add(static_cast<uint64_t>(stats.settled));
+    relaxed.add(static_cast<uint64_t>(stats.relaxed));
+    heapPushes.add(static_cast<uint64_t>(stats.heapPushes));
+    heapPops.add(static_cast<uint64_t>(stats.heapPops));
+}
+
+QueryMetrics& queryMetrics(const std::string& kind) {
+    static std::mutex mutex;
+    static std::map<std::string, std::unique_ptr<QueryMetrics>> byKind;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = byKind[kind];
+    if (!slot) {
+        MetricsRegistry& r = metrics();
+        std::string labels = "query=\"" + kind + "\"";
+        slot.reset(new QueryMetrics{
+            r.histogram("pathfinder_query_duration_seconds", "Time spent answering a query.", labels),
+            r.counter("pathfinder_queries_total", "Queries answered.", labels),
+            r.counter("pathfinder_unreachable_queries_total", "Queries whose target was unreachable.", labels),
+            r.counter("pathfinder_settled_nodes_total", "Nodes settled by searches.", labels),
+            r.counter("pathfinder_relaxed_edges_total", "Edges scanned from settled nodes.", labels),
+            r.counter("pathfinder_heap_pushes_total", "Priority queue insertions.", labels),
+            r.counter("pathfinder_heap_pops_total", "Priority queue removals, stale entries included.", labels),
+        });
+    }
+    return *slot;
+}
+
+std::string metricsOutputFromEnvironment() {
+    const char* path = std::getenv("PATHFINDER_METRICS");
+    return path ? path : "";
+}
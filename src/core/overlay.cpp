@@ -0,0 +1,343 @@
+#include "pathfinder/overlay.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+// Directions tried for each bisection: both axes and both diagonals
+constexpr float kSplitDirections[][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+
+// Recursive bisection: each split is a median cut along the direction that
+// cuts the fewest arcs, and a part becomes a cell of every level whose size
+// limit it is the first to fit
+class Partitioner {
+public:
+    Partitioner(const Graph& graph, const std::vector<int>& cellSizes, std::vector<OverlayLevel>& levels)
+        : graph(graph), cellSizes(cellSizes), levels(levels), cellCounts(cellSizes.size(), 0),
+          side(graph.nodeCount(), 0) {}
+
+    // Levels [0, open) still need a cell for nodes
+    void split(std::vector<int>& nodes, int open) {
+        while (open > 0 && nodes.size() <= static_cast<size_t>(cellSizes[open - 1])) {
+            --open;
+            int id = cellCounts[open]++;
+            for (int v : nodes) levels[open].cell[v] = id;
+        }
+        if (open == 0) return;
+
+        std::vector<int> best;
+        size_t bestCut = 0;
+        for (const auto& direction : kSplitDirections) {
+            auto key = [&](int v) { return direction[0] * graph.positions[v].x + direction[1] * graph.positions[v].y; };
+            auto middle = nodes.begin() + nodes.size() / 2;
+            std::nth_element(nodes.begin(), middle, nodes.end(), [&](int a, int b) { return key(a) < key(b); });
+            for (auto it = nodes.begin(); it != nodes.end(); ++it) side[*it] = it < middle ? 1 : 2;
+            size_t cut = 0;
+            for (int v : nodes) {
+                for (int e = graph.firstEdge[v]; e < graph.firstEdge[v + 1]; ++e) {
+                    char other = side[graph.target[e]];
+                    if (other != 0 && other != side[v]) ++cut;
+                }
+            }
+            for (int v : nodes) side[v] = 0;
+            if (best.empty() || cut < bestCut) {
+                best = nodes;
+                bestCut = cut;
+            }
+        }
+        std::vector<int>().swap(nodes);
+        std::vector<int> upper(best.begin() + best.size() / 2, best.end());
+        best.resize(best.size() / 2);
+        split(best, open);
+        split(upper, open);
+    }
+
+    int cellCount(int level) const { return cellCounts[level]; }
+
+private:
+    const Graph& graph;
+    const std::vector<int>& cellSizes;
+    std::vector<OverlayLevel>& levels;
+    std::vector<int> cellCounts;
+    std::vector<char> side; // 1 or 2 for the halves being compared, 0 elsewhere
+};
+
+// Dijkstra from source where forEachArc(u, relax) calls relax(v, weight) for
+// the arcs leaving u; ends once stop(u) is true for a settled node
+template <typename ForEachArc, typename Stop>
+void runSearch(int nodeCount, int source, SearchContext& context, ForEachArc forEachArc, Stop stop) {
+    context.prepare(nodeCount);
+    auto& heap = context.heap;
+    auto greater = std::greater<std::pair<float, int>>();
+    context.dist[source] = 0;
+    context.touched.push_back(source);
+    heap.emplace_back(0.0f, source);
+    QueryStats& stats = context.stats;
+    stats.heapPushes = 1;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [d, u] = heap.back();
+        heap.pop_back();
+        ++stats.heapPops;
+        if (d > context.dist[u]) continue;
+        ++stats.settled;
+        if (stop(u)) break;
+        forEachArc(u, [&](int v, float weight) {
+            ++stats.relaxed;
+            float alt = d + weight;
+            if (alt < context.dist[v]) {
+                if (context.dist[v] == kInfinity) context.touched.push_back(v);
+                context.dist[v] = alt;
+                context.prev[v] = u;
+                heap.emplace_back(alt, v);
+                std::push_heap(heap.begin(), heap.end(), greater);
+                ++stats.heapPushes;
+            }
+        });
+    }
+}
+
+// Arcs of u inside cell c of level l: input arcs on the finest level, above
+// it the clique of u's cell one level down plus the input arcs leaving that
+// cell. u must be a boundary node of the level below.
+template <typename Relax>
+void forEachCellArc(const Graph& graph, const OverlayGraph& overlay, int l, int c, int u, Relax relax) {
+    const OverlayLevel& level = overlay.levels[l];
+    if (l == 0) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            if (level.cell[graph.target[e]] == c) relax(graph.target[e], graph.weight[e]);
+        }
+        return;
+    }
+    const OverlayLevel& lower = overlay.levels[l - 1];
+    int sub = lower.cell[u];
+    int first = lower.boundaryFirst[sub];
+    int k = lower.boundaryFirst[sub + 1] - first;
+    const float* row = lower.clique.data() + lower.cliqueFirst[sub] + static_cast<size_t>(lower.slot[u]) * k;
+    for (int j = 0; j < k; ++j) relax(lower.boundary[first + j], row[j]);
+    for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+        int v = graph.target[e];
+        if (lower.cell[v] != sub && level.cell[v] == c) relax(v, graph.weight[e]);
+    }
+}
+
+void searchCell(const Graph& graph, const OverlayGraph& overlay, int l, int c, int source, int target,
+                SearchContext& context) {
+    runSearch(
+        graph.nodeCount(), source, context,
+        [&](int u, auto relax) { forEachCellArc(graph, overlay, l, c, u, relax); },
+        [target](int u) { return u == target; });
+}
+
+// One search per boundary node of the cell, each stopping once the whole
+// boundary is settled
+void customizeCell(const Graph& graph, OverlayGraph& overlay, int l, int c, SearchContext& context) {
+    OverlayLevel& level = overlay.levels[l];
+    int first = level.boundaryFirst[c];
+    int k = level.boundaryFirst[c + 1] - first;
+    float* matrix = level.clique.data() + level.cliqueFirst[c];
+    for (int i = 0; i < k; ++i) {
+        int remaining = k;
+        runSearch(
+            graph.nodeCount(), level.boundary[first + i], context,
+            [&](int u, auto relax) { forEachCellArc(graph, overlay, l, c, u, relax); },
+            [&](int u) { return level.slot[u] >= 0 && level.cell[u] == c && --remaining == 0; });
+        for (int j = 0; j < k; ++j) matrix[static_cast<size_t>(i) * k + j] = context.dist[level.boundary[first + j]];
+    }
+}
+
+// Cells of one level only read the level below, so they run side by side
+void customizeCells(const Graph& graph, OverlayGraph& overlay, int l, const std::vector<int>& cells,
+                    ThreadPool& pool) {
+    std::vector<SearchContext> contexts(pool.size());
+    for (int c : cells) {
+        pool.submit([&, c] { customizeCell(graph, overlay, l, c, contexts[ThreadPool::workerIndex()]); });
+    }
+    pool.wait();
+}
+
+void findBoundaries(const Graph& graph, OverlayLevel& level, int cellCount) {
+    const int n = graph.nodeCount();
+    std::vector<char> onBoundary(n, 0);
+    for (int u = 0; u < n; ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            int v = graph.target[e];
+            if (level.cell[u] != level.cell[v]) onBoundary[u] = onBoundary[v] = 1;
+        }
+    }
+    level.boundaryFirst.assign(cellCount + 1, 0);
+    for (int v = 0; v < n; ++v) {
+        if (onBoundary[v]) ++level.boundaryFirst[level.cell[v] + 1];
+    }
+    for (int c = 0; c < cellCount; ++c) level.boundaryFirst[c + 1] += level.boundaryFirst[c];
+    level.boundary.resize(level.boundaryFirst[cellCount]);
+    level.slot.assign(n, -1);
+    std::vector<int> fill(level.boundaryFirst.begin(), level.boundaryFirst.end() - 1);
+    for (int v = 0; v < n; ++v) {
+        if (!onBoundary[v]) continue;
+        int c = level.cell[v];
+        level.slot[v] = fill[c] - level.boundaryFirst[c];
+        level.boundary[fill[c]++] = v;
+    }
+    level.cliqueFirst.assign(cellCount + 1, 0);
+    for (int c = 0; c < cellCount; ++c) {
+        size_t k = level.boundaryFirst[c + 1] - level.boundaryFirst[c];
+        level.cliqueFirst[c + 1] = level.cliqueFirst[c] + k * k;
+    }
+    level.clique.assign(level.cliqueFirst[cellCount], kInfinity);
+}
+
+// Level of the cliques a query from source to target uses at u: the
+// coarsest level where u's cell holds neither endpoint, counted from 1; 0
+// when u shares its finest cell with one of them
+int queryLevel(const OverlayGraph& overlay, int source, int target, int u) {
+    for (int l = static_cast<int>(overlay.levels.size()) - 1; l >= 0; --l) {
+        const std::vector<int>& cell = overlay.levels[l].cell;
+        if (cell[u] != cell[source] && cell[u] != cell[target]) return l + 1;
+    }
+    return 0;
+}
+
+// Appends the nodes after from on a shortest path to to inside their cell of
+// level l, unpacking the cliques of the levels below
+void unpackClique(const Graph& graph, const OverlayGraph& overlay, int l, int from, int to, SearchContext& context,
+                  std::vector<int>& path) {
+    searchCell(graph, overlay, l, overlay.levels[l].cell[from], from, to, context);
+    std::vector<int> chain;
+    for (int v = to; v != from; v = context.prev[v]) chain.push_back(v);
+    chain.push_back(from);
+    std::reverse(chain.begin(), chain.end());
+    for (size_t i = 1; i < chain.size(); ++i) {
+        int x = chain[i - 1], y = chain[i];
+        if (l > 0 && overlay.levels[l - 1].cell[x] == overlay.levels[l - 1].cell[y]) {
+            unpackClique(graph, overlay, l - 1, x, y, context, path);
+        } else {
+            path.push_back(y);
+        }
+    }
+}
+
+} // namespace
+
+size_t OverlayGraph::memoryBytes() const {
+    size_t bytes = weight.size() * sizeof(float);
+    for (const OverlayLevel& level : levels) {
+        bytes += (level.cell.size() + level.boundaryFirst.size() + level.boundary.size() + level.slot.size()) *
+                 sizeof(int);
+        bytes += level.cliqueFirst.size() * sizeof(size_t) + level.clique.size() * sizeof(float);
+    }
+    return bytes;
+}
+
+OverlayGraph buildOverlay(const Graph& graph, ThreadPool& pool, const std::vector<int>& cellSizes) {
+    TRACE_SCOPE_CATEGORY("build", "buildOverlay");
+    const int n = graph.nodeCount();
+    const int levelCount = static_cast<int>(cellSizes.size());
+    OverlayGraph overlay;
+    overlay.levels.resize(levelCount);
+    for (OverlayLevel& level : overlay.levels) level.cell.assign(n, 0);
+    overlay.fingerprint = topologyFingerprint(graph);
+    overlay.weight = graph.weight;
+
+    Partitioner partitioner(graph, cellSizes, overlay.levels);
+    std::vector<int> nodes(n);
+    for (int v = 0; v < n; ++v) nodes[v] = v;
+    partitioner.split(nodes, levelCount);
+
+    for (int l = 0; l < levelCount; ++l) {
+        int cellCount = partitioner.cellCount(l);
+        findBoundaries(graph, overlay.levels[l], cellCount);
+        std::vector<int> cells(cellCount);
+        for (int c = 0; c < cellCount; ++c) cells[c] = c;
+        customizeCells(graph, overlay, l, cells, pool);
+    }
+    return overlay;
+}
+
+bool overlayFits(const OverlayGraph& overlay, const Graph& graph) {
+    return graph.weight.size() == overlay.weight.size() && topologyFingerprint(graph) == overlay.fingerprint;
+}
+
+int updateOverlay(OverlayGraph& overlay, const Graph& graph, ThreadPool& pool) {
+    TRACE_SCOPE_CATEGORY("build", "updateOverlay");
+    // An arc inside a cell changes that cell's clique, and with it the cell
+    // around it on every coarser level, which holds the arc too
+    const int levelCount = static_cast<int>(overlay.levels.size());
+    std::vector<std::vector<char>> dirty(levelCount);
+    for (int l = 0; l < levelCount; ++l) dirty[l].assign(overlay.levels[l].cellCount(), 0);
+    for (int u = 0; u < graph.nodeCount(); ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            if (graph.weight[e] == overlay.weight[e]) continue;
+            for (int l = 0; l < levelCount; ++l) {
+                const std::vector<int>& cell = overlay.levels[l].cell;
+                if (cell[u] == cell[graph.target[e]]) dirty[l][cell[u]] = 1;
+            }
+        }
+    }
+    overlay.weight = graph.weight;
+
+    int recomputed = 0;
+    for (int l = 0; l < levelCount; ++l) {
+        std::vector<int> cells;
+        for (int c = 0; c < overlay.levels[l].cellCount(); ++c) {
+            if (dirty[l][c]) cells.push_back(c);
+        }
+        customizeCells(graph, overlay, l, cells, pool);
+        recomputed += static_cast<int>(cells.size());
+    }
+    return recomputed;
+}
+
+PathResult overlayShortestPath(const Graph& graph, const OverlayGraph& overlay, int source, int target,
+                               SearchContext& context) {
+    TRACE_SCOPE_CATEGORY("query", "overlayShortestPath");
+    static QueryMetrics& metrics = queryMetrics("overlay");
+    auto queryStart = MetricsClock::now();
+
+    // Every node the search reaches at query level q > 0 entered its cell of
+    // that level over a cut arc, so it is on the cell's boundary
+    runSearch(
+        graph.nodeCount(), source, context,
+        [&](int u, auto relax) {
+            int q = queryLevel(overlay, source, target, u);
+            if (q == 0) {
+                for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) relax(graph.target[e], graph.weight[e]);
+                return;
+            }
+            const OverlayLevel& level = overlay.levels[q - 1];
+            int c = level.cell[u];
+            int first = level.boundaryFirst[c];
+            int k = level.boundaryFirst[c + 1] - first;
+            const float* row = level.clique.data() + level.cliqueFirst[c] + static_cast<size_t>(level.slot[u]) * k;
+            for (int j = 0; j < k; ++j) relax(level.boundary[first + j], row[j]);
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                if (level.cell[graph.target[e]] != c) relax(graph.target[e], graph.weight[e]);
+            }
+        },
+        [target](int u) { return u == target; });
+
+    PathResult result;
+    result.stats = context.stats;
+    result.distance = context.dist[target];
+    if (result.distance != kInfinity) {
+        std::vector<int> chain;
+        for (int v = target; v != -1; v = context.prev[v]) chain.push_back(v);
+        std::reverse(chain.begin(), chain.end());
+        // The search is done with context, so unpacking reuses it
+        result.path.push_back(source);
+        for (size_t i = 1; i < chain.size(); ++i) {
+            int u = chain[i - 1], v = chain[i];
+            int q = queryLevel(overlay, source, target, u);
+            if (q > 0 && overlay.levels[q - 1].cell[u] == overlay.levels[q - 1].cell[v]) {
+                unpackClique(graph, overlay, q - 1, u, v, context, result.path);
+            } else {
+                result.path.push_back(v);
+            }
+        }
+    }
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
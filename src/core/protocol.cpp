@@ -0,0 +1,151 @@
+#include "pathfinder/protocol.hpp"
+
+#include <cstring>
+
+namespace {
+
+void putU8(std::vector<uint8_t>& out, uint8_t v) { out.push_back(v); }
+
+void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 24));
+}
+
+void putF32(std::vector<uint8_t>& out, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    putU32(out, bits);
+}
+
+uint32_t readU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+// Bounds-checked cursor over a payload
+struct Reader {
+    const uint8_t* at;
+    const uint8_t* end;
+
+    bool u8(uint8_t& v) {
+        if (end - at < 1) return false;
+        v = *at++;
+        return true;
+    }
+    bool u32(uint32_t& v) {
+        if (end - at < 4) return false;
+        v = readU32(at);
+        at += 4;
+        return true;
+    }
+    bool f32(float& v) {
+        uint32_t bits;
+        if (!u32(bits)) return false;
+        std::memcpy(&v, &bits, sizeof v);
+        return true;
+    }
+};
+
+// Reserves the length header and returns its offset for finishFrame
+size_t beginFrame(std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    putU32(out, 0);
+    return start;
+}
+
+void finishFrame(std::vector<uint8_t>& out, size_t start) {
+    uint32_t length = static_cast<uint32_t>(out.size() - start - kFrameHeaderSize);
+    for (int i = 0; i < 4; ++i) out[start + i] = static_cast<uint8_t>(length >> (8 * i));
+}
+
+} // namespace
+
+size_t completeFrameSize(const uint8_t* data, size_t size) {
+    if (size < kFrameHeaderSize) return 0;
+    uint32_t length = readU32(data);
+    if (length == 0 || length > kMaxPayloadSize) return kInvalidFrame;
+    if (size - kFrameHeaderSize < length) return 0;
+    return kFrameHeaderSize + length;
+}
+
+void appendRequest(std::vector<uint8_t>& out, const Request& request) {
+    size_t start = beginFrame(out);
+    putU32(out, request.id);
+    putU8(out, static_cast<uint8_t>(request.type));
+    if (request.type == MessageType::Route) {
+        putU32(out, request.source);
+        putU32(out, request.target);
+        putU8(out, request.flags);
+    }
+    finishFrame(out, start);
+}
+
+void appendResponse(std::vector<uint8_t>& out, const Response& response) {
+    size_t start = beginFrame(out);
+    putU32(out, response.id);
+    putU8(out, static_cast<uint8_t>(response.type));
+    putU8(out, static_cast<uint8_t>(response.status));
+    if (response.status != Status::BadRequest) {
+        if (response.type == MessageType::Route) {
+            putF32(out, response.distance);
+            putU32(out, response.settled);
+            putU32(out, static_cast<uint32_t>(response.path.size()));
+            for (uint32_t v : response.path) putU32(out, v);
+        } else if (response.type == MessageType::Info) {
+            putU32(out, response.nodeCount);
+            putU32(out, response.destinationCount);
+        } else if (response.type == MessageType::Metrics) {
+            putU32(out, static_cast<uint32_t>(response.text.size()));
+            out.insert(out.end(), response.text.begin(), response.text.end());
+        }
+    }
+    finishFrame(out, start);
+}
+
+bool parseRequest(const uint8_t* payload, size_t size, Request& request) {
+    Reader in{payload, payload + size};
+    uint8_t type;
+    if (!in.u32(request.id) || !in.u8(type)) return false;
+    request.type = static_cast<MessageType>(type);
+    switch (request.type) {
+        case MessageType::Route:
+            if (!in.u32(request.source) || !in.u32(request.target) || !in.u8(request.flags)) return false;
+            break;
+        case MessageType::Info:
+        case MessageType::Metrics:
+            break;
+        default:
+            return false;
+    }
+    return in.at == in.end;
+}
+
+bool parseResponse(const uint8_t* payload, size_t size, Response& response) {
+    Reader in{payload, payload + size};
+    uint8_t type, status;
+    if (!in.u32(response.id) || !in.u8(type) || !in.u8(status)) return false;
+    response.type = static_cast<MessageType>(type);
+    response.status = static_cast<Status>(status);
+    response.path.clear();
+    if (response.status == Status::BadRequest) return in.at == in.end;
+
+    if (response.type == MessageType::Route) {
+        uint32_t length;
+        if (!in.f32(response.distance) || !in.u32(response.settled) || !in.u32(length)) return false;
+        if (length > static_cast<size_t>(in.end - in.at) / 4) return false;
+        response.path.resize(length);
+        for (uint32_t& v : response.path) in.u32(v);
+    } else if (response.type == MessageType::Info) {
+        if (!in.u32(response.nodeCount) || !in.u32(response.destinationCount)) return false;
+    } else if (response.type == MessageType::Metrics) {
+        uint32_t length;
+        if (!in.u32(length) || length > static_cast<size_t>(in.end - in.at)) return false;
+        response.text.assign(reinterpret_cast<const char*>(in.at), length);
+        in.at += length;
+    } else {
+        return false;
+    }
+    return in.at == in.end;
+}
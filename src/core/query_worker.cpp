@@ -0,0 +1,168 @@
+#include "pathfinder/query_worker.hpp"
+#include "pathfinder/alt.hpp"
+#include "pathfinder/alternatives.hpp"
+#include "pathfinder/k_shortest.hpp"
+#include "pathfinder/trace.hpp"
+
+namespace {
+
+// Enough to prune most of an editor-sized search, cheap to recompute after
+// every edit
+constexpr int kEditorLandmarks = 8;
+
+PathResult cancelledResult() {
+    PathResult result;
+    result.cancelled = true;
+    return result;
+}
+
+} // namespace
+
+std::vector<Vec2> QueryTicket::frontier() const {
+    std::lock_guard<std::mutex> lock(frontierMutex);
+    return frontierPoints;
+}
+
+QueryWorker::QueryWorker(const GraphStore& store) : store(store), thread([this] { run(); }) {}
+
+QueryWorker::~QueryWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        if (next.ticket) next.ticket->cancel();
+        if (running) running->cancel();
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+std::shared_ptr<QueryTicket> QueryWorker::submit(int source, int target, bool streamFrontier,
+                                                 QueryRoutes routes) {
+    auto ticket = std::make_shared<QueryTicket>();
+    // The pin moves to the worker with the job and is released there
+    auto graph = std::make_unique<GraphStore::Reader>(store.read());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (next.ticket) {
+            // Superseded before it started
+            next.ticket->cancel();
+            next.ticket->done.store(true, std::memory_order_release);
+        }
+        if (running) running->cancel();
+        next = Job{std::move(graph), source, target, streamFrontier, routes, ticket};
+    }
+    wake.notify_one();
+    return ticket;
+}
+
+void QueryWorker::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (next.ticket) {
+        next.ticket->cancel();
+        next.ticket->done.store(true, std::memory_order_release);
+        next = Job();
+    }
+    if (running) running->cancel();
+}
+
+void QueryWorker::run() {
+    setTraceThreadName("query worker");
+    SearchContext context;
+    ThreadPool pool;
+    // Landmarks of the graph version last searched; rebuilt on the pool when
+    // a newer version arrives
+    LandmarkIndex landmarks;
+    bool haveLandmarks = false;
+    uint64_t landmarkNumber = 0;
+    // Reversed graph for alternative routes and K shortest paths, built for
+    // the first such query on a version
+    AlternativeSearch alternativeSearch;
+    KShortestSearch kShortestSearch;
+    Graph reversed;
+    bool haveReversed = false;
+    uint64_t reversedNumber = 0;
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || next.ticket; });
+            if (stopping) {
+                if (next.ticket) next.ticket->done.store(true, std::memory_order_release);
+                return;
+            }
+            job = std::move(next);
+            next = Job();
+            running = job.ticket;
+        }
+
+        QueryTicket& ticket = *job.ticket;
+        const Graph& graph = job.graph->graph();
+        ticket.number = job.graph->number();
+        SearchControl control;
+        control.cancel = &ticket.cancelRequested;
+        if (job.streamFrontier) {
+            control.progress = [&ticket, &graph](const SearchContext& searching) {
+                // Live heap entries only; stale ones carry an outdated key
+                std::vector<Vec2> nodes;
+                nodes.reserve(searching.heap.size());
+                for (const auto& [key, v] : searching.heap) {
+                    if (key == searching.dist[v] + searching.potential[v]) nodes.push_back(graph.positions[v]);
+                }
+                std::lock_guard<std::mutex> lock(ticket.frontierMutex);
+                ticket.frontierPoints.swap(nodes);
+            };
+        }
+
+        int n = graph.nodeCount();
+        if (job.routes == QueryRoutes::Shortest && (!haveLandmarks || landmarkNumber != ticket.number)) {
+            // Edits that keep the node count usually keep the landmarks'
+            // ids too, so only their distances need recomputing. A cancelled
+            // rebuild is redone by the next query.
+            if (landmarks.count() > 0 && landmarks.fromLandmark.size() == static_cast<size_t>(n) * landmarks.count()) {
+                haveLandmarks = updateLandmarkDistances(graph, landmarks, pool, control.cancel);
+            } else {
+                landmarks = buildLandmarkIndex(graph, kEditorLandmarks, LandmarkStrategy::Avoid, pool, 1,
+                                               control.cancel);
+                haveLandmarks = landmarks.count() > 0 || n == 0;
+            }
+            landmarkNumber = ticket.number;
+        }
+        if (job.routes != QueryRoutes::Shortest && (!haveReversed || reversedNumber != ticket.number)) {
+            reversed = reverseGraph(graph);
+            haveReversed = true;
+            reversedNumber = ticket.number;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<PathResult> routes;
+        if (job.source >= 0 && job.source < n && job.target >= 0 && job.target < n) {
+            if (job.routes == QueryRoutes::Alternatives)
+                routes = alternativeRoutes(graph, reversed, job.source, job.target, alternativeSearch, {}, &control);
+            else if (job.routes == QueryRoutes::KShortest)
+                routes = kShortestPaths(graph, reversed, job.source, job.target, kEditorPaths, kShortestSearch, pool,
+                                        &control);
+            else if (!haveLandmarks)
+                routes.push_back(cancelledResult());
+            else
+                routes.push_back(altShortestPath(graph, landmarks, job.source, job.target, context, &control));
+        }
+        ticket.duration = std::chrono::steady_clock::now() - start;
+        for (size_t i = 0; i < routes.size(); ++i) {
+            std::vector<Vec2> points;
+            for (int v : routes[i].path) points.push_back(graph.positions[v]);
+            if (i == 0) ticket.points = std::move(points);
+            else ticket.alternatives.push_back(std::move(points));
+        }
+        if (!routes.empty()) ticket.answer = std::move(routes[0]);
+        job.graph.reset();
+        {
+            std::lock_guard<std::mutex> lock(ticket.frontierMutex);
+            ticket.frontierPoints.clear();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = nullptr;
+        }
+        ticket.done.store(true, std::memory_order_release);
+    }
+}
@@ -0,0 +1,212 @@
+#include "pathfinder/reorder.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+
+namespace {
+
+// Position of (x, y) along a Hilbert curve filling a 2^16 x 2^16 grid
+uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant so the curve stays continuous
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - (x & (s - 1));
+                y = s - 1 - (y & (s - 1));
+            }
+            std::swap(x, y);
+        }
+        x &= s - 1;
+        y &= s - 1;
+    }
+    return d;
+}
+
+std::vector<int> hilbertOrder(const Graph& graph) {
+    const int n = graph.nodeCount();
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    if (n > 0) {
+        minX = maxX = graph.positions[0].x;
+        minY = maxY = graph.positions[0].y;
+    }
+    for (const Vec2& p : graph.positions) {
+        minX = std::min(minX, p.x);
+        maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y);
+        maxY = std::max(maxY, p.y);
+    }
+    // One scale for both axes keeps the cells square
+    float extent = std::max(maxX - minX, maxY - minY);
+    float scale = extent > 0 ? 65535.0f / extent : 0.0f;
+
+    std::vector<std::pair<uint64_t, int>> keyed(n);
+    for (int v = 0; v < n; ++v) {
+        auto x = static_cast<uint32_t>((graph.positions[v].x - minX) * scale);
+        auto y = static_cast<uint32_t>((graph.positions[v].y - minY) * scale);
+        keyed[v] = {hilbertIndex(x, y), v};
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    std::vector<int> newId(n);
+    for (int i = 0; i < n; ++i) newId[keyed[i].second] = i;
+    return newId;
+}
+
+// Visit order of a breadth-first search over every component. Each
+// component starts at pickRoot(its lowest unvisited id), an unvisited node,
+// until that id is visited too (one-way arcs may keep the root from
+// reaching it); with byDegree, neighbours are queued by increasing degree
+// (Cuthill-McKee).
+template <typename PickRoot>
+std::vector<int> breadthFirstVisit(const Graph& graph, bool byDegree, PickRoot pickRoot) {
+    const int n = graph.nodeCount();
+    auto degree = [&graph](int v) { return graph.firstEdge[v + 1] - graph.firstEdge[v]; };
+    std::vector<int> visit;
+    visit.reserve(n);
+    std::vector<char> seen(n, 0);
+    std::vector<int> neighbours;
+    for (int start = 0; start < n; ++start) {
+        while (!seen[start]) {
+            int root = pickRoot(start, seen);
+            seen[root] = 1;
+            size_t head = visit.size();
+            visit.push_back(root);
+            while (head < visit.size()) {
+                int u = visit[head++];
+                neighbours.clear();
+                for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                    int v = graph.target[e];
+                    if (!seen[v]) {
+                        seen[v] = 1;
+                        neighbours.push_back(v);
+                    }
+                }
+                if (byDegree) {
+                    std::stable_sort(neighbours.begin(), neighbours.end(),
+                                     [&](int a, int b) { return degree(a) < degree(b); });
+                }
+                visit.insert(visit.end(), neighbours.begin(), neighbours.end());
+            }
+        }
+    }
+    return visit;
+}
+
+std::vector<int> bfsOrder(const Graph& graph) {
+    std::vector<int> visit = breadthFirstVisit(graph, false, [](int start, const std::vector<char>&) { return start; });
+    std::vector<int> newId(visit.size());
+    for (size_t i = 0; i < visit.size(); ++i) newId[visit[i]] = static_cast<int>(i);
+    return newId;
+}
+
+std::vector<int> rcmOrder(const Graph& graph) {
+    auto degree = [&graph](int v) { return graph.firstEdge[v + 1] - graph.firstEdge[v]; };
+    // Start each component at its lowest-degree node, found with a separate
+    // BFS from the component's first id. One mark array serves them all. With
+    // one-way arcs that BFS can reach nodes already visited, which cannot be
+    // roots again, and stops early at nodes an earlier BFS marked, which only
+    // narrows the choice.
+    std::vector<char> mark(graph.nodeCount(), 0);
+    std::vector<int> component;
+    std::vector<int> visit = breadthFirstVisit(graph, true, [&](int start, const std::vector<char>& seen) {
+        component.assign(1, start);
+        mark[start] = 1;
+        for (size_t head = 0; head < component.size(); ++head) {
+            int u = component[head];
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                int v = graph.target[e];
+                if (!mark[v]) {
+                    mark[v] = 1;
+                    component.push_back(v);
+                }
+            }
+        }
+        component.erase(std::remove_if(component.begin(), component.end(), [&](int v) { return seen[v]; }),
+                        component.end());
+        return *std::min_element(component.begin(), component.end(),
+                                 [&](int a, int b) { return degree(a) < degree(b); });
+    });
+    const int n = static_cast<int>(visit.size());
+    std::vector<int> newId(n);
+    for (int i = 0; i < n; ++i) newId[visit[i]] = n - 1 - i;
+    return newId;
+}
+
+} // namespace
+
+bool parseNodeOrder(const std::string& text, NodeOrder& order) {
+    if (text == "input") order = NodeOrder::Input;
+    else if (text == "hilbert") order = NodeOrder::Hilbert;
+    else if (text == "bfs") order = NodeOrder::Bfs;
+    else if (text == "rcm") order = NodeOrder::Rcm;
+    else return false;
+    return true;
+}
+
+const char* nodeOrderName(NodeOrder order) {
+    switch (order) {
+        case NodeOrder::Hilbert: return "hilbert";
+        case NodeOrder::Bfs: return "bfs";
+        case NodeOrder::Rcm: return "rcm";
+        default: return "input";
+    }
+}
+
+std::vector<int> computeNodeOrder(const Graph& graph, NodeOrder order) {
+    switch (order) {
+        case NodeOrder::Hilbert: return hilbertOrder(graph);
+        case NodeOrder::Bfs: return bfsOrder(graph);
+        case NodeOrder::Rcm: return rcmOrder(graph);
+        default: {
+            std::vector<int> identity(graph.nodeCount());
+            std::iota(identity.begin(), identity.end(), 0);
+            return identity;
+        }
+    }
+}
+
+ReorderedGraph reorderGraph(const Graph& graph, NodeOrder order) {
+    TRACE_SCOPE_CATEGORY("build", "reorderGraph");
+    const int n = graph.nodeCount();
+    ReorderedGraph result;
+    result.toInternal = computeNodeOrder(graph, order);
+    result.toEditor.resize(n);
+    for (int v = 0; v < n; ++v) result.toEditor[result.toInternal[v]] = v;
+
+    Graph& out = result.graph;
+    out.destinationCount = graph.destinationCount;
+    out.positions.resize(n);
+    out.firstEdge.resize(n + 1);
+    out.target.resize(graph.target.size());
+    out.weight.resize(graph.weight.size());
+    out.arcClass.resize(graph.arcClass.size());
+    int arc = 0;
+    for (int u = 0; u < n; ++u) {
+        int old = result.toEditor[u];
+        out.positions[u] = graph.positions[old];
+        out.firstEdge[u] = arc;
+        for (int e = graph.firstEdge[old]; e < graph.firstEdge[old + 1]; ++e, ++arc) {
+            out.target[arc] = result.toInternal[graph.target[e]];
+            out.weight[arc] = graph.weight[e];
+            if (!graph.arcClass.empty()) out.arcClass[arc] = graph.arcClass[e];
+        }
+    }
+    out.firstEdge[n] = arc;
+    return result;
+}
+
+double meanArcSpan(const Graph& graph) {
+    if (graph.target.empty()) return 0;
+    double total = 0;
+    for (int u = 0; u < graph.nodeCount(); ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) total += std::abs(graph.target[e] - u);
+    }
+    return total / static_cast<double>(graph.target.size());
+}
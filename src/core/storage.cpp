@@ -0,0 +1,125 @@
+#include "pathfinder/storage.hpp"
+#include "pathfinder/trace.hpp"
+
+#include "json.hpp"
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+nlohmann::json positionJson(const Vec2& position) {
+    return {position.x, position.y};
+}
+
+Vec2 positionFromJson(const nlohmann::json& position) {
+    return Vec2{position[0].get<float>(), position[1].get<float>()};
+}
+
+} // namespace
+
+void saveToFile(const std::vector<Node>& destinationNodes,
+                const std::vector<Node>& roadNodes,
+                const std::vector<Edge>& edges,
+                const std::string& path) {
+    saveToFile(destinationNodes, roadNodes, edges, {}, path);
+}
+
+void saveToFile(const std::vector<Node>& destinationNodes,
+                const std::vector<Node>& roadNodes,
+                const std::vector<Edge>& edges,
+                const std::vector<Turn>& turns,
+                const std::string& path) {
+    TRACE_SCOPE_CATEGORY("io", "saveToFile");
+    nlohmann::json j;
+    j["destinations"] = nlohmann::json::array();
+    for (const auto& node : destinationNodes) {
+        j["destinations"].push_back({node.position.x, node.position.y});
+    }
+    j["roads"] = nlohmann::json::array();
+    for (const auto& node : roadNodes) {
+        j["roads"].push_back({node.position.x, node.position.y});
+    }
+    j["edges"] = nlohmann::json::array();
+    for (const auto& edge : edges) {
+        nlohmann::json entry = {{edge.from.x, edge.from.y}, {edge.to.x, edge.to.y}};
+        // Attributes only when an edge has any, so plain maps keep the old layout
+        nlohmann::json attributes = nlohmann::json::object();
+        if (edge.weight >= 0.0f) attributes["weight"] = edge.weight;
+        if (edge.speed > 0.0f) attributes["speed"] = edge.speed;
+        if (edge.roadClass != RoadClass::Street) attributes["class"] = roadClassName(edge.roadClass);
+        if (edge.oneWay) attributes["oneway"] = true;
+        if (!attributes.empty()) entry.push_back(attributes);
+        j["edges"].push_back(entry);
+    }
+    if (!turns.empty()) {
+        j["turns"] = nlohmann::json::array();
+        for (const auto& turn : turns) {
+            nlohmann::json entry = {positionJson(turn.from), positionJson(turn.via), positionJson(turn.to)};
+            if (turn.cost != kInfinity) entry.push_back(turn.cost);
+            j["turns"].push_back(entry);
+        }
+    }
+    std::ofstream outFile(path);
+    outFile << j.dump(4);
+}
+
+bool loadFromFile(std::vector<Node>& destinationNodes,
+                  std::vector<Node>& roadNodes,
+                  std::vector<Edge>& edges,
+                  const std::string& path) {
+    std::vector<Turn> turns;
+    return loadFromFile(destinationNodes, roadNodes, edges, turns, path);
+}
+
+bool loadFromFile(std::vector<Node>& destinationNodes,
+                  std::vector<Node>& roadNodes,
+                  std::vector<Edge>& edges,
+                  std::vector<Turn>& turns,
+                  const std::string& path) {
+    TRACE_SCOPE_CATEGORY("io", "loadFromFile");
+    std::ifstream inFile(path);
+    if (!inFile) return false;
+    try {
+        nlohmann::json j;
+        inFile >> j;
+        if (j.contains("destinations")) {
+            for (const auto& node : j["destinations"]) {
+                destinationNodes.push_back(Node{Vec2{node[0].get<float>(), node[1].get<float>()}, true});
+            }
+        }
+        if (j.contains("roads")) {
+            for (const auto& node : j["roads"]) {
+                roadNodes.push_back(Node{Vec2{node[0].get<float>(), node[1].get<float>()}, false});
+            }
+        }
+        if (j.contains("edges")) {
+            for (const auto& edge : j["edges"]) {
+                Edge loaded{Vec2{edge[0][0].get<float>(), edge[0][1].get<float>()},
+                            Vec2{edge[1][0].get<float>(), edge[1][1].get<float>()}};
+                if (edge.size() > 2) {
+                    const auto& attributes = edge[2];
+                    loaded.weight = attributes.value("weight", -1.0f);
+                    loaded.speed = attributes.value("speed", 0.0f);
+                    loaded.oneWay = attributes.value("oneway", false);
+                    if (attributes.contains("class") &&
+                        !parseRoadClass(attributes["class"].get<std::string>(), loaded.roadClass)) {
+                        std::cerr << "Unknown road class " << attributes["class"] << " in " << path << "\n";
+                        return false;
+                    }
+                }
+                edges.push_back(loaded);
+            }
+        }
+        if (j.contains("turns")) {
+            for (const auto& turn : j["turns"]) {
+                Turn loaded{positionFromJson(turn[0]), positionFromJson(turn[1]), positionFromJson(turn[2])};
+                if (turn.size() > 3) loaded.cost = turn[3].get<float>();
+                turns.push_back(loaded);
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "Cannot parse " << path << ": " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
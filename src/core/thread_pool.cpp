@@ -0,0 +1,99 @@
+#include "pathfinder/thread_pool.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <string>
+
+namespace {
+
+thread_local const void* currentPool = nullptr;
+thread_local int currentIndex = -1;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 1;
+    for (unsigned i = 0; i < threadCount; ++i) queues.push_back(std::make_unique<Queue>());
+    workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this, i] {
+            setTraceThreadName("pool worker " + std::to_string(i));
+            workerLoop(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+int ThreadPool::workerIndex() { return currentIndex; }
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned target = currentPool == this ? static_cast<unsigned>(currentIndex)
+                                          : nextQueue.fetch_add(1, std::memory_order_relaxed) % size();
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    // Taking the sleep mutex orders this wakeup after a worker's empty check
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    taskReady.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    idle.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+}
+
+bool ThreadPool::popOwn(unsigned index, std::function<void()>& task) {
+    Queue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(unsigned thief, std::function<void()>& task) {
+    for (unsigned k = 1; k < size(); ++k) {
+        Queue& queue = *queues[(thief + k) % size()];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    currentPool = this;
+    currentIndex = static_cast<int>(index);
+    std::function<void()> task;
+    while (true) {
+        if (popOwn(index, task) || steal(index, task)) {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            task = nullptr;
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                idle.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        // A skipped (locked) victim or a task still being pushed leaves queued
+        // non-zero; scan again instead of sleeping.
+        if (queued.load(std::memory_order_acquire) > 0) continue;
+        if (stopping) return;
+        taskReady.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+    }
+}
@@ -0,0 +1,307 @@
+#include "pathfinder/time_dependent.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include "json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+
+namespace {
+
+// Where a time falls on the breakpoint grid: between breakpoints segment and
+// segment + 1 (wrapping), fraction of the way along
+struct GridPosition {
+    int segment = 0;
+    int next = 0;
+    float fraction = 0.0f;
+};
+
+GridPosition locate(const TravelTimeProfiles& profiles, float time) {
+    GridPosition at;
+    const int count = profiles.breakpointCount();
+    if (count <= 1) return at;
+    float t = std::fmod(time, profiles.period);
+    if (t < 0) t += profiles.period;
+    auto upper = std::upper_bound(profiles.times.begin(), profiles.times.end(), t);
+    // Before the first breakpoint counts as the tail of the previous period
+    at.segment = upper == profiles.times.begin() ? count - 1 : static_cast<int>(upper - profiles.times.begin()) - 1;
+    at.next = (at.segment + 1) % count;
+    float start = profiles.times[at.segment];
+    float end = profiles.times[at.next];
+    if (at.next == 0) end += profiles.period;
+    if (t < start) t += profiles.period;
+    at.fraction = end > start ? (t - start) / (end - start) : 0.0f;
+    return at;
+}
+
+float factorAt(const TravelTimeProfiles& profiles, int profile, const GridPosition& at) {
+    if (profiles.times.empty()) return 1.0f;
+    const float* row = profiles.factors.data() + static_cast<size_t>(profile) * profiles.times.size();
+    return row[at.segment] + (row[at.next] - row[at.segment]) * at.fraction;
+}
+
+} // namespace
+
+float TravelTimeProfiles::factor(int profile, float time) const {
+    return factorAt(*this, profile, locate(*this, time));
+}
+
+float TravelTimeProfiles::minimumFactor(int profile) const {
+    if (times.empty()) return 1.0f;
+    auto row = factors.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(profile) * times.size());
+    // Linear between breakpoints, so the minimum is at one of them
+    return *std::min_element(row, row + static_cast<std::ptrdiff_t>(times.size()));
+}
+
+TravelTimeProfiles defaultTravelTimeProfiles() {
+    TravelTimeProfiles profiles;
+    const float hour = 3600.0f;
+    for (float h : {0.0f, 6.0f, 7.0f, 8.0f, 9.0f, 11.0f, 15.0f, 17.0f, 18.0f, 19.0f, 21.0f})
+        profiles.times.push_back(h * hour);
+    const std::vector<float> rows[kRoadClassCount] = {
+        {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f},   // track
+        {1.0f, 1.0f, 1.2f, 1.4f, 1.2f, 1.05f, 1.1f, 1.3f, 1.4f, 1.15f, 1.0f}, // street
+        {1.0f, 1.0f, 1.4f, 1.8f, 1.4f, 1.1f, 1.2f, 1.6f, 1.8f, 1.3f, 1.0f},   // main
+        {1.0f, 1.0f, 1.6f, 2.2f, 1.6f, 1.1f, 1.3f, 1.9f, 2.2f, 1.4f, 1.0f},   // motorway
+    };
+    for (const auto& row : rows) profiles.factors.insert(profiles.factors.end(), row.begin(), row.end());
+    return profiles;
+}
+
+bool loadTravelTimeProfiles(const std::string& path, TravelTimeProfiles& profiles, std::vector<ArcProfile>* arcs) {
+    TRACE_SCOPE_CATEGORY("io", "loadTravelTimeProfiles");
+    std::ifstream inFile(path);
+    if (!inFile) {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+    TravelTimeProfiles loaded;
+    std::vector<ArcProfile> loadedArcs;
+    try {
+        nlohmann::json j;
+        inFile >> j;
+        loaded.period = j.value("period", loaded.period);
+        loaded.times = j.at("times").get<std::vector<float>>();
+        const size_t count = loaded.times.size();
+        loaded.factors.assign(kRoadClassCount * count, 1.0f);
+        for (auto it = j.begin(); it != j.end(); ++it) {
+            if (it.key() == "period" || it.key() == "times") continue;
+            if (it.key() == "arcs") {
+                if (!arcs) {
+                    std::cerr << "Per-arc profiles in " << path << " are not supported here\n";
+                    return false;
+                }
+                for (const auto& entry : it.value()) {
+                    loadedArcs.push_back(ArcProfile{entry.at("from").get<int>(), entry.at("to").get<int>(),
+                                                    entry.at("factors").get<std::vector<float>>()});
+                    if (loadedArcs.back().factors.size() != count) {
+                        std::cerr << "Profile of arc " << loadedArcs.back().from << " -> " << loadedArcs.back().to
+                                  << " in " << path << " has " << loadedArcs.back().factors.size() << " factors for "
+                                  << count << " times\n";
+                        return false;
+                    }
+                }
+                continue;
+            }
+            RoadClass roadClass;
+            if (!parseRoadClass(it.key(), roadClass)) {
+                std::cerr << "Unknown road class \"" << it.key() << "\" in " << path << "\n";
+                return false;
+            }
+            auto row = it.value().get<std::vector<float>>();
+            if (row.size() != count) {
+                std::cerr << "Profile \"" << it.key() << "\" in " << path << " has " << row.size()
+                          << " factors for " << count << " times\n";
+                return false;
+            }
+            std::copy(row.begin(), row.end(), loaded.factors.begin() + static_cast<int>(roadClass) * count);
+        }
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "Cannot parse " << path << ": " << e.what() << "\n";
+        return false;
+    }
+    bool valid = loaded.period > 0 && !loaded.times.empty();
+    for (size_t i = 0; valid && i < loaded.times.size(); ++i) {
+        valid = loaded.times[i] >= 0 && loaded.times[i] < loaded.period && (i == 0 || loaded.times[i] > loaded.times[i - 1]);
+    }
+    for (size_t i = 0; valid && i < loaded.factors.size(); ++i) valid = loaded.factors[i] > 0;
+    for (size_t i = 0; valid && i < loadedArcs.size(); ++i) {
+        for (float factor : loadedArcs[i].factors) valid = valid && factor > 0;
+    }
+    if (!valid) {
+        std::cerr << "Profiles in " << path
+                  << " need increasing times within [0, period) and positive factors\n";
+        return false;
+    }
+    profiles = std::move(loaded);
+    if (arcs) *arcs = std::move(loadedArcs);
+    return true;
+}
+
+bool setArcProfiles(TravelTimeProfiles& profiles, const Graph& graph, const std::vector<ArcProfile>& arcs) {
+    const int n = graph.nodeCount();
+    const size_t count = profiles.times.size();
+    // Rows by their factors, so arcs with equal ones share a profile
+    std::map<std::vector<float>, int> rows;
+    for (int p = 0; p < profiles.profileCount(); ++p) {
+        auto row = profiles.factors.begin() + static_cast<std::ptrdiff_t>(p * count);
+        rows.emplace(std::vector<float>(row, row + static_cast<std::ptrdiff_t>(count)), p);
+    }
+    std::vector<uint16_t> arcProfile = profiles.arcProfile;
+    if (arcProfile.empty()) {
+        arcProfile.resize(graph.target.size());
+        for (size_t e = 0; e < arcProfile.size(); ++e)
+            arcProfile[e] = static_cast<uint16_t>(profiles.profileOf(graph, static_cast<int>(e)));
+    }
+    std::vector<float> factors = profiles.factors;
+    for (const ArcProfile& arc : arcs) {
+        if (count == 0 || arc.factors.size() != count) {
+            std::cerr << "Profile of arc " << arc.from << " -> " << arc.to << " has " << arc.factors.size()
+                      << " factors for " << count << " times\n";
+            return false;
+        }
+        auto [slot, added] = rows.emplace(arc.factors, static_cast<int>(factors.size() / count));
+        if (added) {
+            if (slot->second > UINT16_MAX) {
+                std::cerr << "More than " << UINT16_MAX + 1 << " distinct arc profiles\n";
+                return false;
+            }
+            factors.insert(factors.end(), arc.factors.begin(), arc.factors.end());
+        }
+        bool found = false;
+        if (arc.from >= 0 && arc.from < n && arc.to >= 0 && arc.to < n) {
+            for (int e = graph.firstEdge[arc.from]; e < graph.firstEdge[arc.from + 1]; ++e) {
+                if (graph.target[e] != arc.to) continue;
+                arcProfile[e] = static_cast<uint16_t>(slot->second);
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "No arc " << arc.from << " -> " << arc.to << " for its profile\n";
+            return false;
+        }
+    }
+    profiles.factors = std::move(factors);
+    profiles.arcProfile = std::move(arcProfile);
+    return true;
+}
+
+bool parseTimeOfDay(const std::string& text, float& seconds) {
+    // Up to three fields of digits: hours (1 or 2), then minutes and seconds (2 each)
+    int fields[3];
+    int count = 0;
+    size_t at = 0;
+    while (true) {
+        size_t start = at;
+        int value = 0;
+        while (at < text.size() && at - start < 5 && text[at] >= '0' && text[at] <= '9')
+            value = value * 10 + (text[at++] - '0');
+        size_t digits = at - start;
+        if (digits == 0 || (count > 0 && digits != 2) || count == 3) return false;
+        fields[count++] = value;
+        if (at == text.size()) break;
+        if (text[at] != ':') return false;
+        ++at;
+    }
+    int total = fields[0];
+    if (count > 1) {
+        if (fields[0] >= 24 || fields[1] >= 60 || (count == 3 && fields[2] >= 60)) return false;
+        total = fields[0] * 3600 + fields[1] * 60 + (count == 3 ? fields[2] : 0);
+    }
+    if (total >= 86400) return false;
+    seconds = static_cast<float>(total);
+    return true;
+}
+
+bool checkFifo(const Graph& graph, const TravelTimeProfiles& profiles) {
+    const int count = profiles.breakpointCount();
+    if (count <= 1) return true;
+    std::vector<float> longest(profiles.profileCount(), 0.0f);
+    for (size_t e = 0; e < graph.weight.size(); ++e) {
+        float& profileLongest = longest[profiles.profileOf(graph, static_cast<int>(e))];
+        profileLongest = std::max(profileLongest, graph.weight[e]);
+    }
+    for (int p = 0; p < profiles.profileCount(); ++p) {
+        const float* row = profiles.factors.data() + static_cast<size_t>(p) * count;
+        for (int i = 0; i < count; ++i) {
+            int next = (i + 1) % count;
+            float span = profiles.times[next] - profiles.times[i] + (next == 0 ? profiles.period : 0.0f);
+            float slope = (row[next] - row[i]) / span;
+            if (longest[p] * slope < -1.0f) {
+                if (p < kRoadClassCount) std::cerr << roadClassName(static_cast<RoadClass>(p));
+                else std::cerr << "Profile " << p;
+                std::cerr << " arcs up to " << longest[p] << " long are not FIFO: leaving later after "
+                          << profiles.times[i] << " can arrive earlier\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+Graph lowerBoundGraph(const Graph& graph, const TravelTimeProfiles& profiles) {
+    std::vector<float> minimum(profiles.profileCount());
+    for (int p = 0; p < profiles.profileCount(); ++p) minimum[p] = profiles.minimumFactor(p);
+    Graph bounded = graph;
+    for (size_t e = 0; e < bounded.weight.size(); ++e)
+        bounded.weight[e] *= minimum[profiles.profileOf(graph, static_cast<int>(e))];
+    return bounded;
+}
+
+PathResult timeDependentShortestPath(const Graph& graph, const TravelTimeProfiles& profiles, int source,
+                                     int target, float departure, SearchContext& context,
+                                     const LandmarkIndex* landmarks) {
+    TRACE_SCOPE_CATEGORY("query", "timeDependentShortestPath");
+    static QueryMetrics& metrics = queryMetrics("time_dependent");
+    auto queryStart = MetricsClock::now();
+    // Bounds are only consulted when landmarks are given; an empty index gives 0
+    static const LandmarkIndex kNoLandmarks;
+    const LandmarkPotential potential(landmarks ? *landmarks : kNoLandmarks, source, target);
+
+    context.prepare(graph.nodeCount());
+    auto& heap = context.heap;
+    auto greater = std::greater<std::pair<float, int>>();
+    context.dist[source] = 0;
+    context.potential[source] = potential(source);
+    context.touched.push_back(source);
+    heap.emplace_back(context.potential[source], source);
+    int settled = 0, relaxed = 0, pushes = 1, pops = 0;
+
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [key, u] = heap.back();
+        heap.pop_back();
+        ++pops;
+        float d = context.dist[u];
+        if (key > d + context.potential[u]) continue;
+        ++settled;
+        if (u == target) break;
+        // Every arc out of u is entered at the same time
+        GridPosition at = locate(profiles, departure + d);
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            ++relaxed;
+            int v = graph.target[e];
+            float alt = d + graph.weight[e] * factorAt(profiles, profiles.profileOf(graph, e), at);
+            if (alt < context.dist[v]) {
+                if (context.dist[v] == kInfinity) {
+                    context.touched.push_back(v);
+                    context.potential[v] = potential(v);
+                }
+                context.dist[v] = alt;
+                context.prev[v] = u;
+                heap.emplace_back(alt + context.potential[v], v);
+                std::push_heap(heap.begin(), heap.end(), greater);
+                ++pushes;
+            }
+        }
+    }
+    context.stats = QueryStats{settled, relaxed, pushes, pops};
+
+    PathResult result = collectPath(target, context);
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
@@ -0,0 +1,173 @@
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> gTraceEnabled{false};
+
+namespace {
+
+constexpr size_t kEventsPerThread = 1 << 16;
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+// Written only by its owning thread; head counts every event ever recorded
+// and the slot for event i is i % kEventsPerThread.
+struct ThreadBuffer {
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[kEventsPerThread]};
+    std::atomic<uint64_t> head{0};
+    int tid = 0;
+    std::string name;
+};
+
+// Buffers outlive their threads so events from finished threads can still be exported
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    TraceClock::time_point epoch = TraceClock::now();
+    std::atomic<int64_t> startNs{0};
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Buffers are allocated on a thread's first event, so naming a thread that
+// never traces costs nothing
+struct ThreadState {
+    std::shared_ptr<ThreadBuffer> buffer;
+    std::string name;
+};
+
+ThreadState& threadState() {
+    thread_local ThreadState state;
+    return state;
+}
+
+ThreadBuffer& localBuffer() {
+    ThreadState& state = threadState();
+    if (!state.buffer) {
+        state.buffer = std::make_shared<ThreadBuffer>();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        state.buffer->tid = static_cast<int>(r.buffers.size()) + 1;
+        state.buffer->name = state.name;
+        r.buffers.push_back(state.buffer);
+    }
+    return *state.buffer;
+}
+
+int64_t sinceEpochNs(TraceClock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t - registry().epoch).count();
+}
+
+void writeEscaped(std::FILE* out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') std::fputc('\\', out);
+        if (static_cast<unsigned char>(c) >= 0x20) std::fputc(c, out);
+    }
+}
+
+} // namespace
+
+void startTracing() {
+    registry().startNs.store(sinceEpochNs(TraceClock::now()), std::memory_order_relaxed);
+    gTraceEnabled.store(true, std::memory_order_release);
+}
+
+void stopTracing() {
+    gTraceEnabled.store(false, std::memory_order_release);
+}
+
+std::string traceOutputFromEnvironment() {
+    const char* path = std::getenv("PATHFINDER_TRACE");
+    return path ? path : "";
+}
+
+void setTraceThreadName(const std::string& name) {
+    ThreadState& state = threadState();
+    state.name = name;
+    if (state.buffer) {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        state.buffer->name = name;
+    }
+}
+
+void recordTraceEvent(const char* name, const char* category,
+                      TraceClock::time_point start, TraceClock::time_point end) {
+    ThreadBuffer& buffer = localBuffer();
+    uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer.events[index % kEventsPerThread];
+    event.name = name;
+    event.category = category;
+    event.startNs = sinceEpochNs(start);
+    event.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+bool writeTrace(const std::string& path) {
+    Registry& r = registry();
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        buffers = r.buffers;
+    }
+    const int64_t startNs = r.startNs.load(std::memory_order_relaxed);
+
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    std::fputs("{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"pathfinder\"}}", out);
+
+    std::vector<TraceEvent> events;
+    for (const auto& buffer : buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = head > kEventsPerThread ? head - kEventsPerThread : 0;
+        events.clear();
+        for (uint64_t i = first; i < head; ++i) events.push_back(buffer->events[i % kEventsPerThread]);
+
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            name = buffer->name.empty() ? "thread " + std::to_string(buffer->tid) : buffer->name;
+        }
+        std::fprintf(out, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"",
+                     buffer->tid);
+        writeEscaped(out, name);
+        std::fputs("\"}}", out);
+
+        for (const auto& e : events) {
+            if (e.startNs < startNs) continue; // before the current session
+            std::fprintf(out, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"name\":\"", buffer->tid);
+            writeEscaped(out, e.name);
+            std::fputs("\",\"cat\":\"", out);
+            writeEscaped(out, e.category);
+            std::fprintf(out, "\",\"ts\":%.3f,\"dur\":%.3f}", e.startNs / 1000.0, e.durationNs / 1000.0);
+        }
+    }
+    std::fputs("\n]}\n", out);
+    bool ok = !std::ferror(out);
+    return std::fclose(out) == 0 && ok;
+}
+
+TraceSession::TraceSession(std::string path) : path(std::move(path)) {
+    if (!this->path.empty()) startTracing();
+}
+
+TraceSession::~TraceSession() {
+    if (path.empty()) return;
+    stopTracing();
+    if (writeTrace(path)) std::cerr << "Trace written to " << path << "\n";
+    else std::cerr << "Cannot write trace " << path << "\n";
+}
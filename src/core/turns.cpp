@@ -0,0 +1,123 @@
+#include "pathfinder/turns.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <unordered_map>
+
+TurnCosts buildTurnCosts(const Graph& graph, const std::vector<Turn>& turns, float uTurnCost) {
+    TRACE_SCOPE_CATEGORY("build", "buildTurnCosts");
+    const int n = graph.nodeCount();
+    std::unordered_map<Vec2, int> idOf;
+    idOf.reserve(n);
+    for (int v = 0; v < n; ++v) idOf.emplace(graph.positions[v], v);
+    auto idAt = [&](const Vec2& position) {
+        auto found = idOf.find(position);
+        return found == idOf.end() ? -1 : found->second;
+    };
+
+    std::vector<std::pair<int, TurnCosts::Entry>> resolved; // (via, entry)
+    for (const Turn& turn : turns) {
+        int from = idAt(turn.from), via = idAt(turn.via), to = idAt(turn.to);
+        if (from < 0 || via < 0 || to < 0) continue;
+        for (int in = graph.firstEdge[from]; in < graph.firstEdge[from + 1]; ++in) {
+            if (graph.target[in] != via) continue;
+            for (int out = graph.firstEdge[via]; out < graph.firstEdge[via + 1]; ++out) {
+                if (graph.target[out] == to) resolved.push_back({via, TurnCosts::Entry{in, out, turn.cost}});
+            }
+        }
+    }
+    // Highest cost first within a pair, so unique keeps it
+    std::sort(resolved.begin(), resolved.end(), [](const auto& a, const auto& b) {
+        return std::make_tuple(a.first, a.second.fromArc, a.second.toArc, -a.second.cost) <
+               std::make_tuple(b.first, b.second.fromArc, b.second.toArc, -b.second.cost);
+    });
+    resolved.erase(std::unique(resolved.begin(), resolved.end(), [](const auto& a, const auto& b) {
+        return a.second.fromArc == b.second.fromArc && a.second.toArc == b.second.toArc;
+    }), resolved.end());
+
+    TurnCosts costs;
+    costs.uTurnCost = uTurnCost;
+    costs.firstEntry.assign(n + 1, 0);
+    for (const auto& r : resolved) ++costs.firstEntry[r.first + 1];
+    for (int v = 0; v < n; ++v) costs.firstEntry[v + 1] += costs.firstEntry[v];
+    costs.entries.reserve(resolved.size());
+    for (const auto& r : resolved) costs.entries.push_back(r.second);
+    return costs;
+}
+
+PathResult turnAwareShortestPath(const Graph& graph, const TurnCosts& turns, int source, int target,
+                                 SearchContext& context) {
+    TRACE_SCOPE_CATEGORY("query", "turnAwareShortestPath");
+    static QueryMetrics& metrics = queryMetrics("turns");
+    auto queryStart = MetricsClock::now();
+    const bool uTurnsFree = turns.uTurnCost == 0.0f;
+
+    // dist and prev are per arc: the cost of arriving over it, and the arc before
+    context.prepare(static_cast<int>(graph.target.size()));
+    auto& heap = context.heap;
+    auto greater = std::greater<std::pair<float, int>>();
+    int settled = 0, relaxed = 0, pushes = 0, pops = 0;
+    auto reach = [&](int arc, float cost, int before) {
+        if (cost >= context.dist[arc]) return;
+        if (context.dist[arc] == kInfinity) context.touched.push_back(arc);
+        context.dist[arc] = cost;
+        context.prev[arc] = before;
+        heap.emplace_back(cost, arc);
+        std::push_heap(heap.begin(), heap.end(), greater);
+        ++pushes;
+    };
+
+    PathResult result;
+    if (source == target) {
+        result.distance = 0;
+        result.path.push_back(source);
+    } else {
+        for (int e = graph.firstEdge[source]; e < graph.firstEdge[source + 1]; ++e) reach(e, graph.weight[e], -1);
+    }
+    int arrival = -1;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto [d, arc] = heap.back();
+        heap.pop_back();
+        ++pops;
+        if (d > context.dist[arc]) continue;
+        ++settled;
+        const int v = graph.target[arc];
+        if (v == target) {
+            arrival = arc;
+            break;
+        }
+        // The arc's tail, to recognise turning back onto the reverse arc
+        const int u = uTurnsFree ? -1 : context.prev[arc] >= 0 ? graph.target[context.prev[arc]] : source;
+        // Costed turns out of this arc, in toArc order like the loop below
+        auto entry = std::lower_bound(turns.entries.begin() + turns.firstEntry[v],
+                                      turns.entries.begin() + turns.firstEntry[v + 1], arc,
+                                      [](const TurnCosts::Entry& t, int fromArc) { return t.fromArc < fromArc; });
+        auto entriesEnd = turns.entries.begin() + turns.firstEntry[v + 1];
+        for (int out = graph.firstEdge[v]; out < graph.firstEdge[v + 1]; ++out) {
+            ++relaxed;
+            float turnCost = graph.target[out] == u ? turns.uTurnCost : 0.0f;
+            while (entry != entriesEnd && entry->fromArc == arc && entry->toArc < out) ++entry;
+            if (entry != entriesEnd && entry->fromArc == arc && entry->toArc == out) turnCost += entry->cost;
+            if (turnCost == kInfinity) continue;
+            reach(out, d + turnCost + graph.weight[out], arc);
+        }
+    }
+    context.stats = QueryStats{settled, relaxed, pushes, pops};
+    result.stats = context.stats;
+
+    if (arrival >= 0) {
+        result.distance = context.dist[arrival];
+        // Walk the arcs twice so the path is allocated once, already in order
+        int length = 1;
+        for (int arc = arrival; arc >= 0; arc = context.prev[arc]) ++length;
+        result.path.resize(length);
+        result.path[0] = source;
+        for (int arc = arrival; arc >= 0; arc = context.prev[arc]) result.path[--length] = graph.target[arc];
+    }
+    metrics.record(MetricsClock::now() - queryStart, result.stats, result.distance != kInfinity);
+    return result;
+}
@@ -0,0 +1,418 @@
+// Runs a DIMACS .ss/.p2p query file against the path finding engines and
+// reports throughput and latency percentiles.
+//
+//   dimacs_runner <graph.gr> <graph.co> <queries.ss|queries.p2p>
+//                 [--engine dijkstra|legacy|delta|alt|cch|overlay|arcflags|td|tdalt|all]
+//                 [--limit N] [--threads N] [--delta-scale X] [--order input|hilbert|bfs|rcm]
+//                 [--landmarks N] [--landmark-strategy farthest|avoid] [--regions N]
+//                 [--depart HH:MM] [--profiles PATH]
+//
+// delta runs single-source files with parallel delta-stepping on N threads
+// (default: hardware concurrency); its bucket width is X times the median
+// arc length (default 2).
+//
+// --order renumbers the graph for memory locality before the dijkstra and
+// delta runs; legacy always works on the input vectors. Checksums do not
+// depend on the order.
+//
+// alt answers point-to-point files with landmark A*; it first picks N
+// landmarks (default 16) and computes their distances on the thread pool,
+// and reports that preprocessing time and the index size.
+//
+// cch answers point-to-point files from a customizable contraction hierarchy
+// and reports the topology preprocessing and the customization (on the
+// thread pool) separately, since only the latter reruns when weights change.
+//
+// overlay answers point-to-point files over a multi-level overlay graph and
+// reports its partitioning and customization time and size.
+//
+// arcflags answers point-to-point files with Dijkstra pruned by arc flags
+// over N k-d regions (default 32). Building them takes one search per
+// boundary node, so all leaves it out.
+//
+// td and tdalt answer point-to-point files with time-dependent Dijkstra and
+// A* for a departure (default 8:00) under the default or --profiles travel
+// time profiles. Their checksums are travel times, so all leaves them out.
+
+#include "pathfinder/alt.hpp"
+#include "pathfinder/arc_flags.hpp"
+#include "pathfinder/cch.hpp"
+#include "pathfinder/delta_stepping.hpp"
+#include "pathfinder/dimacs.hpp"
+#include "pathfinder/graph.hpp"
+#include "pathfinder/overlay.hpp"
+#include "pathfinder/reorder.hpp"
+#include "pathfinder/time_dependent.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct RunStats {
+    std::string engine;
+    std::vector<double> latenciesUs;
+    double totalSeconds = 0;
+    double checksum = 0;   // sum of finite distances, to compare engines
+    long long unreachable = 0;
+    long long settled = 0;
+};
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+void report(RunStats& stats) {
+    std::sort(stats.latenciesUs.begin(), stats.latenciesUs.end());
+    size_t n = stats.latenciesUs.size();
+    std::printf("%-9s %9zu %10.3f %12.1f %10.1f %10.1f %10.1f %10.1f %14.1f %8lld %12.1f\n",
+                stats.engine.c_str(), n, stats.totalSeconds,
+                stats.totalSeconds > 0 ? n / stats.totalSeconds : 0.0,
+                percentile(stats.latenciesUs, 50), percentile(stats.latenciesUs, 90),
+                percentile(stats.latenciesUs, 99), n ? stats.latenciesUs.back() : 0.0,
+                stats.checksum, stats.unreachable,
+                n ? static_cast<double>(stats.settled) / n : 0.0);
+}
+
+template <typename Query>
+void timeQueries(RunStats& stats, size_t count, Query query) {
+    stats.latenciesUs.reserve(count);
+    auto runStart = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        auto start = Clock::now();
+        float distance = query(i);
+        auto end = Clock::now();
+        stats.latenciesUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        if (distance == kInfinity) ++stats.unreachable;
+        else stats.checksum += distance;
+    }
+    stats.totalSeconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+}
+
+void printUsage() {
+    std::cerr << "usage: dimacs_runner <graph.gr> <graph.co> <queries.ss|queries.p2p>"
+                 " [--engine dijkstra|legacy|delta|alt|cch|overlay|arcflags|td|tdalt|all]\n"
+                 "                     [--limit N] [--threads N] [--delta-scale X] [--order input|hilbert|bfs|rcm]\n"
+                 "                     [--landmarks N] [--landmark-strategy farthest|avoid] [--regions N]\n"
+                 "                     [--depart HH:MM] [--profiles PATH]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        printUsage();
+        return 1;
+    }
+    std::string engine = "dijkstra";
+    size_t limit = 0;
+    unsigned threads = 0;
+    float deltaScale = 2.0f;
+    NodeOrder order = NodeOrder::Input;
+    int landmarkCount = 16;
+    LandmarkStrategy landmarkStrategy = LandmarkStrategy::Avoid;
+    int regionCount = 32;
+    float departure = 8 * 3600.0f;
+    std::string profilesPath;
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--engine" && i + 1 < argc) engine = argv[++i];
+        else if (arg == "--limit" && i + 1 < argc) limit = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && i + 1 < argc) threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--delta-scale" && i + 1 < argc) deltaScale = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--order" && i + 1 < argc && parseNodeOrder(argv[i + 1], order)) ++i;
+        else if (arg == "--landmarks" && i + 1 < argc) landmarkCount = std::atoi(argv[++i]);
+        else if (arg == "--landmark-strategy" && i + 1 < argc && parseLandmarkStrategy(argv[i + 1], landmarkStrategy))
+            ++i;
+        else if (arg == "--regions" && i + 1 < argc) regionCount = std::atoi(argv[++i]);
+        else if (arg == "--depart" && i + 1 < argc && parseTimeOfDay(argv[i + 1], departure)) ++i;
+        else if (arg == "--profiles" && i + 1 < argc) profilesPath = argv[++i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (engine != "dijkstra" && engine != "legacy" && engine != "delta" && engine != "alt" && engine != "cch" &&
+        engine != "overlay" && engine != "arcflags" && engine != "td" &&
+        engine != "tdalt" && engine != "all") {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Node> destinationNodes, roadNodes;
+    std::vector<IdArc> arcs;
+    auto loadStart = Clock::now();
+    if (!loadDimacsGraph(argv[1], argv[2], destinationNodes, arcs)) return 1;
+    DimacsQueries queries;
+    if (!loadDimacsQueries(argv[3], queries)) return 1;
+    double loadSeconds = std::chrono::duration<double>(Clock::now() - loadStart).count();
+
+    auto buildStart = Clock::now();
+    Graph graph = buildGraph(destinationNodes, roadNodes, arcs);
+    double buildSeconds = std::chrono::duration<double>(Clock::now() - buildStart).count();
+
+    auto validId = [&](int id) {
+        if (id >= 0 && id < graph.nodeCount()) return true;
+        std::cerr << "Query references unknown vertex " << id + 1 << "\n";
+        return false;
+    };
+    for (int id : queries.sources) {
+        if (!validId(id)) return 1;
+    }
+    for (const auto& q : queries.pairs) {
+        if (!validId(q.first) || !validId(q.second)) return 1;
+    }
+
+    size_t count = queries.singleSource ? queries.sources.size() : queries.pairs.size();
+    if (limit) count = std::min(count, limit);
+
+    std::printf("graph: %d nodes, %zu arcs (load %.2f s, build %.2f s)\n",
+                graph.nodeCount(), arcs.size(), loadSeconds, buildSeconds);
+
+    // The legacy engine keeps editor ids; the others search the renumbered graph
+    DimacsQueries internalQueries = queries;
+    std::vector<int> toInternal; // empty in input order
+    if (order != NodeOrder::Input) {
+        double spanBefore = meanArcSpan(graph);
+        auto reorderStart = Clock::now();
+        ReorderedGraph reordered = reorderGraph(graph, order);
+        double reorderSeconds = std::chrono::duration<double>(Clock::now() - reorderStart).count();
+        graph = std::move(reordered.graph);
+        for (int& id : internalQueries.sources) id = reordered.toInternal[id];
+        for (auto& q : internalQueries.pairs) {
+            q.first = reordered.toInternal[q.first];
+            q.second = reordered.toInternal[q.second];
+        }
+        toInternal = std::move(reordered.toInternal);
+        std::printf("order: %s (%.2f s), mean arc span %.1f -> %.1f\n", nodeOrderName(order), reorderSeconds,
+                    spanBefore, meanArcSpan(graph));
+    }
+    std::printf("queries: %zu %s\n\n", count, queries.singleSource ? "single-source" : "point-to-point");
+    std::printf("%-9s %9s %10s %12s %10s %10s %10s %10s %14s %8s %12s\n",
+                "engine", "queries", "total_s", "queries/s", "p50_us", "p90_us", "p99_us", "max_us",
+                "checksum", "unreach", "settled/q");
+
+    if (engine == "dijkstra" || engine == "all") {
+        RunStats stats;
+        stats.engine = "dijkstra";
+        SearchContext context;
+        if (queries.singleSource) {
+            timeQueries(stats, count, [&](size_t i) {
+                shortestPathTree(graph, internalQueries.sources[i], context);
+                stats.settled += context.stats.settled;
+                // Report the sum over the tree so checksums compare across runs
+                double total = 0;
+                for (int v : context.touched) total += context.dist[v];
+                return static_cast<float>(total);
+            });
+        } else {
+            timeQueries(stats, count, [&](size_t i) {
+                const auto& q = internalQueries.pairs[i];
+                PathResult result = shortestPath(graph, q.first, q.second, context);
+                stats.settled += result.stats.settled;
+                return result.distance;
+            });
+        }
+        report(stats);
+    }
+
+    if (engine == "legacy" || engine == "all") {
+        if (queries.singleSource) {
+            std::cerr << "legacy engine only answers point-to-point queries, skipped\n";
+        } else {
+            // findShortestPath rebuilds its hash maps on every call; this is the
+            // baseline the other engines are measured against. It knows nodes by
+            // position only, so vertices sharing coordinates merge there.
+            std::vector<Edge> edges;
+            edges.reserve(arcs.size());
+            for (const IdArc& arc : arcs) {
+                Edge edge{destinationNodes[arc.from].position, destinationNodes[arc.to].position};
+                edge.weight = arc.weight;
+                edge.oneWay = true;
+                edges.push_back(edge);
+            }
+            RunStats stats;
+            stats.engine = "legacy";
+            timeQueries(stats, count, [&](size_t i) {
+                const auto& start = destinationNodes[queries.pairs[i].first].position;
+                const auto& goal = destinationNodes[queries.pairs[i].second].position;
+                if (start == goal) return 0.0f;
+                float distance = kInfinity;
+                findShortestPath(start, goal, destinationNodes, roadNodes, edges, nullptr, &distance);
+                return distance;
+            });
+            report(stats);
+        }
+    }
+
+    if (engine == "delta" || engine == "all") {
+        if (!queries.singleSource) {
+            std::cerr << "delta engine only answers single-source queries, skipped\n";
+        } else {
+            ThreadPool pool(threads);
+            DeltaSteppingIndex index = buildDeltaSteppingIndex(graph, suggestDelta(graph, deltaScale));
+            DeltaSteppingResult result;
+            RunStats stats;
+            stats.engine = "delta";
+            timeQueries(stats, count, [&](size_t i) {
+                deltaSteppingTree(graph, index, internalQueries.sources[i], pool, result);
+                stats.settled += result.stats.settled;
+                double total = 0;
+                for (float d : result.dist) {
+                    if (d != kInfinity) total += d;
+                }
+                return static_cast<float>(total);
+            });
+            report(stats);
+        }
+    }
+
+    if (engine == "alt" || engine == "all") {
+        if (queries.singleSource) {
+            std::cerr << "alt engine only answers point-to-point queries, skipped\n";
+        } else {
+            ThreadPool pool(threads);
+            auto preprocessStart = Clock::now();
+            LandmarkIndex index = buildLandmarkIndex(graph, landmarkCount, landmarkStrategy, pool);
+            double preprocessSeconds = std::chrono::duration<double>(Clock::now() - preprocessStart).count();
+            std::fprintf(stderr, "alt: %d landmarks in %.2f s, %.1f MiB\n", index.count(), preprocessSeconds,
+                         index.memoryBytes() / (1024.0 * 1024.0));
+            SearchContext context;
+            RunStats stats;
+            stats.engine = "alt";
+            timeQueries(stats, count, [&](size_t i) {
+                const auto& q = internalQueries.pairs[i];
+                PathResult result = altShortestPath(graph, index, q.first, q.second, context);
+                stats.settled += result.stats.settled;
+                return result.distance;
+            });
+            report(stats);
+        }
+    }
+
+    if (engine == "cch" || engine == "all") {
+        if (queries.singleSource) {
+            std::cerr << "cch engine only answers point-to-point queries, skipped\n";
+        } else {
+            ThreadPool pool(threads);
+            auto topologyStart = Clock::now();
+            CchTopology topology = buildCchTopology(graph);
+            auto customizeStart = Clock::now();
+            CchMetric metric = customizeCch(topology, graph, pool);
+            auto customizeEnd = Clock::now();
+            std::fprintf(stderr, "cch: %d arcs, topology %.2f s, customization %.2f s on %u threads\n",
+                         topology.arcCount(), std::chrono::duration<double>(customizeStart - topologyStart).count(),
+                         std::chrono::duration<double>(customizeEnd - customizeStart).count(), pool.size());
+            CchQueryContext context;
+            RunStats stats;
+            stats.engine = "cch";
+            timeQueries(stats, count, [&](size_t i) {
+                const auto& q = internalQueries.pairs[i];
+                PathResult result = cchShortestPath(topology, metric, q.first, q.second, context);
+                stats.settled += result.stats.settled;
+                return result.distance;
+            });
+            report(stats);
+        }
+    }
+
+    if (engine == "overlay" || engine == "all") {
+        if (queries.singleSource) {
+            std::cerr << "overlay engine only answers point-to-point queries, skipped\n";
+        } else {
+            ThreadPool pool(threads);
+            auto buildStart = Clock::now();
+            OverlayGraph overlay = buildOverlay(graph, pool);
+            double buildSeconds = std::chrono::duration<double>(Clock::now() - buildStart).count();
+            std::fprintf(stderr, "overlay: %zu levels in %.2f s, %.1f MiB\n", overlay.levels.size(), buildSeconds,
+                         overlay.memoryBytes() / (1024.0 * 1024.0));
+            SearchContext context;
+            RunStats stats;
+            stats.engine = "overlay";
+            timeQueries(stats, count, [&](size_t i) {
+                const auto& q = internalQueries.pairs[i];
+                PathResult result = overlayShortestPath(graph, overlay, q.first, q.second, context);
+                stats.settled += result.stats.settled;
+                return result.distance;
+            });
+            report(stats);
+        }
+    }
+
+    if (engine == "arcflags") {
+        if (queries.singleSource) {
+            std::cerr << "arcflags engine only answers point-to-point queries, skipped\n";
+        } else {
+            ThreadPool pool(threads);
+            auto buildStart = Clock::now();
+            ArcFlags flags = buildArcFlags(graph, regionCount, pool);
+            double buildSeconds = std::chrono::duration<double>(Clock::now() - buildStart).count();
+            std::fprintf(stderr, "arcflags: %d regions in %.2f s on %u threads, %.1f MiB\n", flags.regionCount,
+                         buildSeconds, pool.size(), flags.memoryBytes() / (1024.0 * 1024.0));
+            SearchContext context;
+            RunStats stats;
+            stats.engine = "arcflags";
+            timeQueries(stats, count, [&](size_t i) {
+                const auto& q = internalQueries.pairs[i];
+                PathResult result = arcFlagsShortestPath(graph, flags, q.first, q.second, context);
+                stats.settled += result.stats.settled;
+                return result.distance;
+            });
+            report(stats);
+        }
+    }
+
+    if (engine == "td" || engine == "tdalt") {
+        TravelTimeProfiles profiles = defaultTravelTimeProfiles();
+        if (!profilesPath.empty()) {
+            // Arcs are named by DIMACS vertex ids
+            std::vector<ArcProfile> arcProfiles;
+            if (!loadTravelTimeProfiles(profilesPath, profiles, &arcProfiles)) return 1;
+            for (ArcProfile& arc : arcProfiles) {
+                --arc.from;
+                --arc.to;
+                if (toInternal.empty() || arc.from < 0 || arc.from >= graph.nodeCount() || arc.to < 0 ||
+                    arc.to >= graph.nodeCount())
+                    continue;
+                arc.from = toInternal[arc.from];
+                arc.to = toInternal[arc.to];
+            }
+            if (!arcProfiles.empty() && !setArcProfiles(profiles, graph, arcProfiles)) return 1;
+        }
+        if (queries.singleSource) {
+            std::cerr << engine << " engine only answers point-to-point queries, skipped\n";
+        } else {
+            if (!checkFifo(graph, profiles)) std::cerr << "Travel times may not be the earliest arrivals\n";
+            LandmarkIndex index;
+            if (engine == "tdalt") {
+                ThreadPool pool(threads);
+                auto preprocessStart = Clock::now();
+                index = buildLandmarkIndex(lowerBoundGraph(graph, profiles), landmarkCount, landmarkStrategy, pool);
+                double preprocessSeconds = std::chrono::duration<double>(Clock::now() - preprocessStart).count();
+                std::fprintf(stderr, "tdalt: %d landmarks on lower bounds in %.2f s\n", index.count(),
+                             preprocessSeconds);
+            }
+            SearchContext context;
+            RunStats stats;
+            stats.engine = engine;
+            timeQueries(stats, count, [&](size_t i) {
+                const auto& q = internalQueries.pairs[i];
+                PathResult result = timeDependentShortestPath(graph, profiles, q.first, q.second, departure, context,
+                                                              engine == "tdalt" ? &index : nullptr);
+                stats.settled += result.stats.settled;
+                return result.distance;
+            });
+            report(stats);
+        }
+    }
+    return 0;
+}
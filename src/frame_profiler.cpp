@@ -0,0 +1,89 @@
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+
+namespace {
+
+double toUs(FrameProfiler::Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+} // namespace
+
+const char* FrameProfiler::sectionName(FrameSection section) {
+    switch (section) {
+        case FrameSection::Events: return "events";
+        case FrameSection::Map: return "map";
+        case FrameSection::Edges: return "edges";
+        case FrameSection::Hover: return "hover";
+        case FrameSection::Nodes: return "nodes";
+        case FrameSection::Ui: return "ui";
+        case FrameSection::Path: return "path";
+        case FrameSection::Display: return "display";
+        default: return "?";
+    }
+}
+
+void FrameProfiler::endFrame(const std::array<Clock::duration, kSectionCount>& sections, Clock::duration total) {
+    Frame& frame = history[frameCount % kHistory];
+    for (int i = 0; i < kSectionCount; ++i) frame.sectionUs[i] = toUs(sections[i]);
+    frame.totalUs = toUs(total);
+    frameDuration.record(total);
+
+    if (csv) {
+        std::fprintf(csv, "%d,%.1f", frameCount, frame.totalUs);
+        for (double us : frame.sectionUs) std::fprintf(csv, ",%.1f", us);
+        if (queryThisFrame) std::fprintf(csv, ",%.1f,%d\n", lastQueryUs, lastQuerySettled);
+        else std::fputs(",,\n", csv);
+    }
+    queryThisFrame = false;
+    ++frameCount;
+}
+
+void FrameProfiler::recordQuery(Clock::duration elapsed, int settled) {
+    lastQueryUs = toUs(elapsed);
+    lastQuerySettled = settled;
+    queryThisFrame = true;
+}
+
+std::string FrameProfiler::overlayText() const {
+    int frames = std::min(frameCount, kHistory);
+    if (frames == 0) return "";
+    Frame average;
+    double worstUs = 0;
+    for (int f = 0; f < frames; ++f) {
+        for (int i = 0; i < kSectionCount; ++i) average.sectionUs[i] += history[f].sectionUs[i] / frames;
+        average.totalUs += history[f].totalUs / frames;
+        worstUs = std::max(worstUs, history[f].totalUs);
+    }
+
+    char line[128];
+    std::snprintf(line, sizeof line, "frame %7.2f ms  max %.2f  %.0f fps\n",
+                  average.totalUs / 1000, worstUs / 1000, average.totalUs > 0 ? 1e6 / average.totalUs : 0.0);
+    std::string text = line;
+    for (int i = 0; i < kSectionCount; ++i) {
+        std::snprintf(line, sizeof line, "%-8s %7.3f ms\n", sectionName(static_cast<FrameSection>(i)),
+                      average.sectionUs[i] / 1000);
+        text += line;
+    }
+    std::snprintf(line, sizeof line, "query    %7.3f ms  %d settled", lastQueryUs / 1000, lastQuerySettled);
+    text += line;
+    if (csv) text += "\nrecording " + csvPath;
+    return text;
+}
+
+bool FrameProfiler::startCsv(const std::string& path) {
+    stopCsv();
+    csv = std::fopen(path.c_str(), "w");
+    if (!csv) return false;
+    csvPath = path;
+    std::fputs("frame,total_us", csv);
+    for (int i = 0; i < kSectionCount; ++i) std::fprintf(csv, ",%s_us", sectionName(static_cast<FrameSection>(i)));
+    std::fputs(",query_us,settled\n", csv);
+    return true;
+}
+
+void FrameProfiler::stopCsv() {
+    if (csv) std::fclose(csv);
+    csv = nullptr;
+}
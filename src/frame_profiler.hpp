@@ -0,0 +1,107 @@
+#pragma once
+
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/trace.hpp"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Per-frame timing of the editor loop. Each frame is split into consecutive
+// sections; a FrameTimer attributes the time between section switches to the
+// section that was active. While a trace is being recorded every section is
+// also emitted as a trace event. Build without PATHFINDER_FRAME_PROFILER and
+// the PROFILE_* macros compile to nothing.
+
+enum class FrameSection {
+    Events,
+    Map,
+    Edges,
+    Hover,
+    Nodes,
+    Ui,
+    Path,
+    Display,
+    Count
+};
+
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int kSectionCount = static_cast<int>(FrameSection::Count);
+    static constexpr int kHistory = 120; // frames averaged by the overlay
+
+    ~FrameProfiler() { stopCsv(); }
+
+    void endFrame(const std::array<Clock::duration, kSectionCount>& sections, Clock::duration total);
+    void recordQuery(Clock::duration elapsed, int settled);
+
+    // Multi-line summary for the on-screen overlay
+    std::string overlayText() const;
+
+    bool startCsv(const std::string& path);
+    void stopCsv();
+    bool recording() const { return csv != nullptr; }
+
+    static const char* sectionName(FrameSection section);
+
+private:
+    struct Frame {
+        std::array<double, kSectionCount> sectionUs{};
+        double totalUs = 0;
+    };
+
+    std::array<Frame, kHistory> history{};
+    int frameCount = 0;
+    double lastQueryUs = 0;
+    int lastQuerySettled = 0;
+    bool queryThisFrame = false;
+    std::FILE* csv = nullptr;
+    std::string csvPath;
+    LatencyHistogram& frameDuration = metrics().histogram(
+        "pathfinder_frame_duration_seconds", "Editor frame time from event polling to display().");
+};
+
+// Lives for one iteration of the main loop
+class FrameTimer {
+public:
+    explicit FrameTimer(FrameProfiler& profiler)
+        : profiler(profiler), frameStart(FrameProfiler::Clock::now()), sectionStart(frameStart) {}
+
+    ~FrameTimer() {
+        auto now = FrameProfiler::Clock::now();
+        closeSection(now);
+        profiler.endFrame(sections, now - frameStart);
+    }
+
+    FrameTimer(const FrameTimer&) = delete;
+    FrameTimer& operator=(const FrameTimer&) = delete;
+
+    // Closes the running section and starts the next one
+    void enter(FrameSection section) {
+        auto now = FrameProfiler::Clock::now();
+        closeSection(now);
+        sectionStart = now;
+        current = section;
+    }
+
+private:
+    void closeSection(FrameProfiler::Clock::time_point now) {
+        sections[static_cast<int>(current)] += now - sectionStart;
+        if (isTracing()) recordTraceEvent(FrameProfiler::sectionName(current), "render", sectionStart, now);
+    }
+
+    FrameProfiler& profiler;
+    FrameProfiler::Clock::time_point frameStart;
+    FrameProfiler::Clock::time_point sectionStart;
+    FrameSection current = FrameSection::Events;
+    std::array<FrameProfiler::Clock::duration, FrameProfiler::kSectionCount> sections{};
+};
+
+#ifdef PATHFINDER_FRAME_PROFILER
+#define PROFILE_FRAME(profiler) FrameTimer frameTimer_(profiler)
+#define PROFILE_SECTION(section) frameTimer_.enter(FrameSection::section)
+#else
+#define PROFILE_FRAME(profiler) ((void)0)
+#define PROFILE_SECTION(section) ((void)0)
+#endif
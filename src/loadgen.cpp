@@ -0,0 +1,284 @@
+// Load generator for pathfinder_server: keeps a fixed number of pipelined
+// route requests in flight on each connection and reports sustained
+// queries/second and latency percentiles.
+//
+//   pathfinder_loadgen [--socket PATH | --tcp PORT] [--connections C]
+//                      [--depth D] [--duration SECONDS] [--seed N] [--path]
+//   pathfinder_loadgen [--socket PATH | --tcp PORT] --metrics
+//
+// Endpoints are drawn uniformly from the server's destinations (or from all
+// nodes when there are fewer than two destinations). --metrics prints the
+// server's Prometheus metrics instead. Linux only.
+
+#include "pathfinder/protocol.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string socketPath = "/tmp/pathfinder.sock";
+    int tcpPort = 0;
+    int connections = 4;
+    int depth = 32;
+    double duration = 10;
+    unsigned seed = 1;
+    bool wantPath = false;
+    bool metrics = false;
+};
+
+struct WorkerStats {
+    std::vector<double> latenciesUs;
+    long long unreachable = 0;
+    long long errors = 0;
+};
+
+int connectTo(const Options& options) {
+    if (options.tcpPort > 0) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(options.tcpPort));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        return fd;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, options.socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const std::vector<uint8_t>& bytes) {
+    size_t sent = 0;
+    while (sent < bytes.size()) {
+        ssize_t n = send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Blocking frame reader over a connected socket
+class FrameReader {
+public:
+    explicit FrameReader(int fd) : fd(fd) {}
+
+    // Reads at least one more frame; calls handle(response) for each one
+    template <typename Handler>
+    bool readSome(Handler handle) {
+        uint8_t chunk[64 * 1024];
+        ssize_t n = recv(fd, chunk, sizeof chunk, 0);
+        if (n <= 0) return false;
+        buffer.insert(buffer.end(), chunk, chunk + n);
+        size_t consumed = 0;
+        while (true) {
+            size_t frame = completeFrameSize(buffer.data() + consumed, buffer.size() - consumed);
+            if (frame == kInvalidFrame) return false;
+            if (frame == 0) break;
+            Response response;
+            if (!parseResponse(buffer.data() + consumed + kFrameHeaderSize, frame - kFrameHeaderSize, response))
+                return false;
+            handle(response);
+            consumed += frame;
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + consumed);
+        return true;
+    }
+
+private:
+    int fd;
+    std::vector<uint8_t> buffer;
+};
+
+// Sends one bodiless request on a fresh connection and waits for its answer
+bool fetch(const Options& options, MessageType type, Response& reply) {
+    int fd = connectTo(options);
+    if (fd < 0) return false;
+    std::vector<uint8_t> bytes;
+    Request request;
+    request.type = type;
+    appendRequest(bytes, request);
+    bool done = false;
+    FrameReader reader(fd);
+    bool ok = sendAll(fd, bytes);
+    while (ok && !done) {
+        ok = reader.readSome([&](const Response& response) {
+            reply = response;
+            done = true;
+        });
+    }
+    close(fd);
+    return done && reply.status == Status::Ok;
+}
+
+void runConnection(const Options& options, unsigned seed, uint32_t endpointCount,
+                   Clock::time_point stopAt, WorkerStats& stats) {
+    int fd = connectTo(options);
+    if (fd < 0) {
+        ++stats.errors;
+        return;
+    }
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> pick(0, endpointCount - 1);
+    std::unordered_map<uint32_t, Clock::time_point> sentAt;
+    uint32_t nextId = 0;
+    std::vector<uint8_t> bytes;
+
+    auto queue = [&](int count) {
+        bytes.clear();
+        auto now = Clock::now();
+        for (int i = 0; i < count; ++i) {
+            Request request;
+            request.id = nextId++;
+            request.source = pick(rng);
+            request.target = pick(rng);
+            request.flags = options.wantPath ? kWantPath : 0;
+            appendRequest(bytes, request);
+            sentAt.emplace(request.id, now);
+        }
+        return sendAll(fd, bytes);
+    };
+
+    FrameReader reader(fd);
+    bool ok = queue(options.depth);
+    while (ok && !sentAt.empty()) {
+        int answered = 0;
+        ok = reader.readSome([&](const Response& response) {
+            auto it = sentAt.find(response.id);
+            if (it == sentAt.end()) {
+                ++stats.errors;
+                return;
+            }
+            stats.latenciesUs.push_back(
+                std::chrono::duration<double, std::micro>(Clock::now() - it->second).count());
+            sentAt.erase(it);
+            if (response.status == Status::Unreachable) ++stats.unreachable;
+            else if (response.status != Status::Ok) ++stats.errors;
+            ++answered;
+        });
+        // Refill the pipeline until the run ends, then drain what is in flight
+        if (ok && answered > 0 && Clock::now() < stopAt) ok = queue(answered);
+    }
+    if (!ok) ++stats.errors;
+    close(fd);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+void printUsage() {
+    std::cerr << "usage: pathfinder_loadgen [--socket PATH | --tcp PORT] [--connections C]"
+                 " [--depth D] [--duration SECONDS] [--seed N] [--path]\n"
+                 "       pathfinder_loadgen [--socket PATH | --tcp PORT] --metrics\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) options.socketPath = argv[++i];
+        else if (arg == "--tcp" && i + 1 < argc) options.tcpPort = std::atoi(argv[++i]);
+        else if (arg == "--connections" && i + 1 < argc) options.connections = std::atoi(argv[++i]);
+        else if (arg == "--depth" && i + 1 < argc) options.depth = std::atoi(argv[++i]);
+        else if (arg == "--duration" && i + 1 < argc) options.duration = std::atof(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) options.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--path") options.wantPath = true;
+        else if (arg == "--metrics") options.metrics = true;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.connections < 1 || options.depth < 1 || options.duration <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    if (options.metrics) {
+        Response reply;
+        if (!fetch(options, MessageType::Metrics, reply)) {
+            std::cerr << "Cannot reach the server\n";
+            return 1;
+        }
+        std::fwrite(reply.text.data(), 1, reply.text.size(), stdout);
+        return 0;
+    }
+
+    Response info;
+    if (!fetch(options, MessageType::Info, info)) {
+        std::cerr << "Cannot reach the server\n";
+        return 1;
+    }
+    uint32_t nodeCount = info.nodeCount, destinationCount = info.destinationCount;
+    uint32_t endpointCount = destinationCount >= 2 ? destinationCount : nodeCount;
+    if (endpointCount == 0) {
+        std::cerr << "Server graph is empty\n";
+        return 1;
+    }
+
+    std::vector<WorkerStats> stats(options.connections);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    auto stopAt = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+    for (int c = 0; c < options.connections; ++c) {
+        threads.emplace_back(runConnection, std::cref(options), options.seed + c, endpointCount, stopAt,
+                             std::ref(stats[c]));
+    }
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    WorkerStats total;
+    for (auto& s : stats) {
+        total.latenciesUs.insert(total.latenciesUs.end(), s.latenciesUs.begin(), s.latenciesUs.end());
+        total.unreachable += s.unreachable;
+        total.errors += s.errors;
+    }
+    std::sort(total.latenciesUs.begin(), total.latenciesUs.end());
+    size_t n = total.latenciesUs.size();
+
+    std::printf("connections %d, depth %d, %.2f s, %u endpoints\n",
+                options.connections, options.depth, seconds, endpointCount);
+    std::printf("queries     %zu (%lld unreachable, %lld errors)\n", n, total.unreachable, total.errors);
+    std::printf("queries/s   %.1f\n", seconds > 0 ? n / seconds : 0.0);
+    std::printf("latency us  p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+                percentile(total.latenciesUs, 50), percentile(total.latenciesUs, 90),
+                percentile(total.latenciesUs, 99), percentile(total.latenciesUs, 99.9),
+                n ? total.latenciesUs.back() : 0.0);
+    return total.errors ? 2 : 0;
+}
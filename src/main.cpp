@@ -1,38 +1,23 @@
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <iostream>
 #include <fstream>
-#include "json.hpp"
 #include <SFML/System/Angle.hpp>
 #include <queue>
 #include <unordered_map>
 #include <limits>
 #include <cmath>
-
-// Hash function for sf::Vector2f
-namespace std {
-    template<>
-    struct hash<sf::Vector2f> {
-        size_t operator()(const sf::Vector2f& v) const {
-            // Combine hashes of x and y components
-            size_t h1 = hash<float>()(v.x);
-            size_t h2 = hash<float>()(v.y);
-            return h1 ^ (h2 << 1);
-        }
-    };
-}
-
-struct Node {
-    sf::Vector2f position;
-    bool isDestination;
-};
-
-// Edge structure
-struct Edge {
-    sf::Vector2f from;
-    sf::Vector2f to;
-};
+#include <memory>
+#include "pathfinder/graph.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/graph_store.hpp"
+#include "pathfinder/query_worker.hpp"
+#include "pathfinder/storage.hpp"
+#include "pathfinder/trace.hpp"
+#include "pathfinder/turns.hpp"
+#include "frame_profiler.hpp"
 
 enum class Mode {
     Idle,
@@ -43,26 +28,9 @@ enum class Mode {
     FindPath
 };
 
-// Add this function before main()
-void saveToFile(const std::vector<Node>& destinationNodes, 
-                const std::vector<Node>& roadNodes, 
-                const std::vector<Edge>& edges) {
-    nlohmann::json j;
-    j["destinations"] = nlohmann::json::array();
-    for (const auto& node : destinationNodes) {
-        j["destinations"].push_back({node.position.x, node.position.y});
-    }
-    j["roads"] = nlohmann::json::array();
-    for (const auto& node : roadNodes) {
-        j["roads"].push_back({node.position.x, node.position.y});
-    }
-    j["edges"] = nlohmann::json::array();
-    for (const auto& edge : edges) {
-        j["edges"].push_back({{edge.from.x, edge.from.y}, {edge.to.x, edge.to.y}});
-    }
-    std::ofstream outFile("nodes.json");
-    outFile << j.dump(4);
-}
+// The core stores positions as Vec2; convert at the drawing boundary
+sf::Vector2f toSf(const Vec2& v) { return sf::Vector2f(v.x, v.y); }
+Vec2 toVec2(const sf::Vector2f& v) { return Vec2{v.x, v.y}; }
 
 void centerText(sf::Text& text, unsigned int windowWidth, unsigned int yOffset) {
     sf::FloatRect textBounds = text.getLocalBounds();
@@ -73,73 +41,19 @@ void centerText(sf::Text& text, unsigned int windowWidth, unsigned int yOffset)
     text.setPosition(sf::Vector2f(windowWidth / 2.0f, yOffset));
 }
 
-int findPathNode1 = -1, findPathNode2 = -1;
-std::vector<sf::Vector2f> foundPath;
-
-float euclidean(const sf::Vector2f& a, const sf::Vector2f& b) {
-    float dx = a.x - b.x, dy = a.y - b.y;
-    return std::sqrt(dx*dx + dy*dy);
-}
-
-std::vector<sf::Vector2f> findShortestPath(
-    const sf::Vector2f& start,
-    const sf::Vector2f& goal,
-    const std::vector<Node>& destinationNodes,
-    const std::vector<Node>& roadNodes,
-    const std::vector<Edge>& edges
-) {
-    // Build adjacency list
-    std::vector<sf::Vector2f> allNodes;
-    for (const auto& n : destinationNodes) allNodes.push_back(n.position);
-    for (const auto& n : roadNodes) allNodes.push_back(n.position);
-
-    std::unordered_map<sf::Vector2f, std::vector<sf::Vector2f>> adj;
-    for (const auto& node : allNodes) adj[node] = {};
-    for (const auto& e : edges) {
-        adj[e.from].push_back(e.to);
-        adj[e.to].push_back(e.from);
-    }
-
-    // Dijkstra
-    std::unordered_map<sf::Vector2f, float> dist;
-    std::unordered_map<sf::Vector2f, sf::Vector2f> prev;
-    auto vec_hash = [](const sf::Vector2f& v) {
-        return std::hash<float>()(v.x) ^ std::hash<float>()(v.y);
-    };
-    auto cmp = [&](const sf::Vector2f& a, const sf::Vector2f& b) {
-        return dist[a] > dist[b];
-    };
-    std::priority_queue<sf::Vector2f, std::vector<sf::Vector2f>, decltype(cmp)> pq(cmp);
-
-    for (const auto& node : allNodes) dist[node] = std::numeric_limits<float>::infinity();
-    dist[start] = 0;
-    pq.push(start);
-
-    while (!pq.empty()) {
-        sf::Vector2f u = pq.top(); pq.pop();
-        if (u == goal) break;
-        for (const auto& v : adj[u]) {
-            float alt = dist[u] + euclidean(u, v);
-            if (alt < dist[v]) {
-                dist[v] = alt;
-                prev[v] = u;
-                pq.push(v);
-            }
-        }
-    }
-
-    // Reconstruct path
-    std::vector<sf::Vector2f> path;
-    if (prev.find(goal) == prev.end()) return path; // No path
-    for (sf::Vector2f at = goal; at != start; at = prev[at])
-        path.push_back(at);
-    path.push_back(start);
-    std::reverse(path.begin(), path.end());
-    return path;
+// PATHFINDER_METRICS names a file that receives the query metrics on exit
+void writeMetricsOnExit() {
+    std::string path = metricsOutputFromEnvironment();
+    if (!path.empty() && !metrics().writePrometheusFile(path))
+        std::cerr << "Cannot write metrics to " << path << "\n";
 }
 
 int main()
 {
+    // PATHFINDER_TRACE=out.json records the whole session; F5 captures trace.json
+    TraceSession traceSession(traceOutputFromEnvironment());
+    setTraceThreadName("main");
+
     // Calculate scaled dimensions to fit 1920x1080 screen
     // Using 80% of screen height to leave some margin
     const float scale = (1080.0f * 0.8f) / 1479.0f;
@@ -155,8 +69,11 @@ int main()
 
     // Set window icon
     sf::Image icon;
-    if (icon.loadFromFile("path_finder_logo.png")) {
-        window.setIcon(icon);
+    {
+        TRACE_SCOPE_CATEGORY("io", "loadIcon");
+        if (icon.loadFromFile("path_finder_logo.png")) {
+            window.setIcon(icon);
+        }
     }
 
     // Get the screen dimensions
@@ -171,10 +88,13 @@ int main()
 
     // Load the map texture
     sf::Texture mapTexture;
-    // if (!mapTexture.loadFromFile("map2.jpg"))
-    if (!mapTexture.loadFromFile("map.png"))
     {
-        return -1; // Exit if image loading fails
+        TRACE_SCOPE_CATEGORY("io", "loadMapTexture");
+        // if (!mapTexture.loadFromFile("map2.jpg"))
+        if (!mapTexture.loadFromFile("map.png"))
+        {
+            return -1; // Exit if image loading fails
+        }
     }
 
     // Create a sprite to display the texture
@@ -192,8 +112,11 @@ int main()
 
     // Create button text (Add Node)
     sf::Font font;
-    if (!font.openFromFile("OpenSans-Regular.ttf")) {
-        return -1; // Exit if font loading fails
+    {
+        TRACE_SCOPE_CATEGORY("io", "loadFont");
+        if (!font.openFromFile("OpenSans-Regular.ttf")) {
+            return -1; // Exit if font loading fails
+        }
     }
     sf::Text buttonText(font, "Add Node (A)", 20);
     buttonText.setFillColor(sf::Color::White);
@@ -259,6 +182,49 @@ int main()
     std::vector<Node> destinationNodes;
     std::vector<Node> roadNodes;
     std::vector<Edge> edges;
+    // Kept with the map and dropped along with their nodes or edges; the
+    // editor's own queries are node-based and do not apply them
+    std::vector<Turn> turns;
+
+    // Find Path state: the picked destinations and the last routes found,
+    // best first. V cycles between the shortest path, alternative routes
+    // and the kEditorPaths shortest paths.
+    int findPathNode1 = -1, findPathNode2 = -1;
+    std::vector<std::vector<Vec2>> foundPaths;
+    QueryRoutes findPathRoutes = QueryRoutes::Shortest;
+
+    // Queries run on a background worker against the latest published graph
+    // version; every edit publishes a new one without waiting for them
+    GraphStore graphStore;
+    auto publishGraph = [&] {
+        // Turns over edges that are gone (or no longer run that way) go with them
+        auto joins = [&](const Vec2& a, const Vec2& b) {
+            return std::any_of(edges.begin(), edges.end(), [&](const Edge& e) {
+                return (e.from == a && e.to == b) || (!e.oneWay && e.from == b && e.to == a);
+            });
+        };
+        turns.erase(std::remove_if(turns.begin(), turns.end(), [&](const Turn& t) {
+            return !joins(t.from, t.via) || !joins(t.via, t.to);
+        }), turns.end());
+        graphStore.publish(buildGraph(destinationNodes, roadNodes, edges));
+    };
+    QueryWorker queryWorker(graphStore);
+    std::shared_ptr<QueryTicket> pendingQuery;
+    sf::CircleShape frontierDot(2);
+    frontierDot.setFillColor(sf::Color(255, 140, 0));
+
+    // Found routes are drawn in these colours, best first
+    const sf::Color kRouteColors[] = {sf::Color::Green, sf::Color::Cyan, sf::Color::Magenta,
+                                      sf::Color(80, 140, 255), sf::Color::White};
+    const size_t kRouteColorCount = sizeof(kRouteColors) / sizeof(kRouteColors[0]);
+
+    // Edges are drawn by road class, one-way ones with an arrow head
+    const sf::Color kRoadClassColors[kRoadClassCount] = {
+        sf::Color(160, 120, 60), sf::Color::Yellow, sf::Color(255, 150, 0), sf::Color(230, 60, 60)};
+    const float kRoadClassThickness[kRoadClassCount] = {3, 5, 6, 8};
+    sf::CircleShape oneWayArrow(7, 3);
+    oneWayArrow.setOrigin(sf::Vector2f(7, 7));
+    oneWayArrow.setFillColor(sf::Color::White);
 
     // Node selection state
     Mode currentMode = Mode::Idle;
@@ -268,34 +234,19 @@ int main()
     int selectedNodeIndex = -1;
     int removeEdgeNodeType = -1;
     int removeEdgeNodeIndex = -1;
+    // Attributes given to added edges: C cycles the road class, O toggles one-way
+    RoadClass newEdgeClass = RoadClass::Street;
+    bool newEdgeOneWay = false;
 
     // For hover effect
     int hoveredNodeType = -1; // 0: destination, 1: road
     int hoveredNodeIndex = -1;
 
-    // Load nodes from file
-    {
-        std::ifstream inFile("nodes.json");
-        if (inFile) {
-            nlohmann::json j;
-            inFile >> j;
-            if (j.contains("destinations")) {
-                for (const auto& node : j["destinations"]) {
-                    destinationNodes.push_back(Node{sf::Vector2f(node[0], node[1]), true});
-                }
-            }
-            if (j.contains("roads")) {
-                for (const auto& node : j["roads"]) {
-                    roadNodes.push_back(Node{sf::Vector2f(node[0], node[1]), false});
-                }
-            }
-            if (j.contains("edges")) {
-                for (const auto& edge : j["edges"]) {
-                    edges.push_back(Edge{sf::Vector2f(edge[0][0], edge[0][1]), sf::Vector2f(edge[1][0], edge[1][1])});
-                }
-            }
-        }
+    // Load nodes from file; refuse to start (and later overwrite) a file we could not read
+    if (!loadFromFile(destinationNodes, roadNodes, edges, turns) && std::ifstream("nodes.json")) {
+        return -1;
     }
+    publishGraph();
 
     // Add Find Path button
     sf::RectangleShape findPathButton(sf::Vector2f(150, 40));
@@ -307,15 +258,30 @@ int main()
     findPathText.setFillColor(sf::Color::White);
     findPathText.setPosition(sf::Vector2f(735, 15));
 
+#ifdef PATHFINDER_FRAME_PROFILER
+    // Frame timing overlay (F3) and per-frame CSV dump (F4)
+    FrameProfiler frameProfiler;
+    bool showProfiler = false;
+    sf::RectangleShape profilerBackground(sf::Vector2f(260, 200));
+    profilerBackground.setPosition(sf::Vector2f(10, windowHeight - 210.0f));
+    profilerBackground.setFillColor(sf::Color(0, 0, 0, 170));
+    sf::Text profilerText(font, "", 14);
+    profilerText.setFillColor(sf::Color::White);
+    profilerText.setPosition(sf::Vector2f(18, windowHeight - 205.0f));
+#endif
+
     while (window.isOpen())
     {
+        TRACE_SCOPE_CATEGORY("render", "frame");
+        PROFILE_FRAME(frameProfiler);
         while (const std::optional event = window.pollEvent())
         {
             if (event->is<sf::Event::Closed>() || 
                 (event->is<sf::Event::KeyPressed>() && 
                  event->getIf<sf::Event::KeyPressed>()->code == sf::Keyboard::Key::Escape))
             {
-                saveToFile(destinationNodes, roadNodes, edges);
+                saveToFile(destinationNodes, roadNodes, edges, turns);
+                writeMetricsOnExit();
                 window.close();
                 return 0;
             }
@@ -326,14 +292,14 @@ int main()
                         case sf::Keyboard::Key::A:
                             showTypeButtons = !showTypeButtons;
                             currentMode = Mode::Idle;
-                            foundPath.clear();
+                            foundPaths.clear();
                             break;
                         case sf::Keyboard::Key::D:
                             if (showTypeButtons) {
                                 currentMode = Mode::AddNode;
                                 isDestinationNode = true;
                                 showTypeButtons = false;
-                                foundPath.clear();
+                                foundPaths.clear();
                             }
                             break;
                         case sf::Keyboard::Key::F:
@@ -341,34 +307,71 @@ int main()
                                 currentMode = Mode::AddNode;
                                 isDestinationNode = false;
                                 showTypeButtons = false;
-                                foundPath.clear();
+                                foundPaths.clear();
                             }
                             break;
                         case sf::Keyboard::Key::R:
                             currentMode = (currentMode == Mode::RemoveNode) ? Mode::Idle : Mode::RemoveNode;
                             showTypeButtons = false;
-                            foundPath.clear();
+                            foundPaths.clear();
                             break;
                         case sf::Keyboard::Key::E:
                             currentMode = (currentMode == Mode::AddEdge) ? Mode::Idle : Mode::AddEdge;
                             selectedNodeType = -1;
                             selectedNodeIndex = -1;
                             showTypeButtons = false;
-                            foundPath.clear();
+                            foundPaths.clear();
                             break;
                         case sf::Keyboard::Key::X:
                             currentMode = (currentMode == Mode::RemoveEdge) ? Mode::Idle : Mode::RemoveEdge;
                             removeEdgeNodeType = -1;
                             removeEdgeNodeIndex = -1;
                             showTypeButtons = false;
-                            foundPath.clear();
+                            foundPaths.clear();
+                            break;
+                        case sf::Keyboard::Key::C:
+                            newEdgeClass = static_cast<RoadClass>((static_cast<int>(newEdgeClass) + 1) % kRoadClassCount);
+                            break;
+                        case sf::Keyboard::Key::O:
+                            newEdgeOneWay = !newEdgeOneWay;
+                            break;
+                        case sf::Keyboard::Key::V:
+                            findPathRoutes = findPathRoutes == QueryRoutes::Shortest       ? QueryRoutes::Alternatives
+                                             : findPathRoutes == QueryRoutes::Alternatives ? QueryRoutes::KShortest
+                                                                                           : QueryRoutes::Shortest;
                             break;
                         case sf::Keyboard::Key::P:
                             currentMode = (currentMode == Mode::FindPath) ? Mode::Idle : Mode::FindPath;
                             findPathNode1 = -1;
                             findPathNode2 = -1;
                             showTypeButtons = false;
-                            foundPath.clear();
+                            foundPaths.clear();
+                            queryWorker.cancel();
+                            pendingQuery.reset();
+                            break;
+#ifdef PATHFINDER_FRAME_PROFILER
+                        case sf::Keyboard::Key::F3:
+                            showProfiler = !showProfiler;
+                            break;
+                        case sf::Keyboard::Key::F4:
+                            if (frameProfiler.recording())
+                                frameProfiler.stopCsv();
+                            else if (!frameProfiler.startCsv("frame_times.csv"))
+                                std::cerr << "Cannot write frame_times.csv\n";
+                            break;
+#endif
+                        case sf::Keyboard::Key::F5:
+                            if (!isTracing()) {
+                                startTracing();
+                            } else {
+                                stopTracing();
+                                if (!writeTrace("trace.json"))
+                                    std::cerr << "Cannot write trace.json\n";
+                            }
+                            break;
+                        case sf::Keyboard::Key::F6:
+                            if (!metrics().writePrometheusFile("metrics.prom"))
+                                std::cerr << "Cannot write metrics.prom\n";
                             break;
                         default:
                             break;
@@ -383,7 +386,7 @@ int main()
                 if (button.getGlobalBounds().contains(sf::Vector2f(mousePos)))
                 {
                     showTypeButtons = !showTypeButtons;
-                    foundPath.clear();
+                    foundPaths.clear();
                     if (showTypeButtons) {
                         currentMode = Mode::Idle;
                     } else {
@@ -396,7 +399,7 @@ int main()
                     currentMode = Mode::AddNode;
                     isDestinationNode = true;
                     showTypeButtons = false;
-                    foundPath.clear();
+                    foundPaths.clear();
                 }
                 // Check if road button was clicked
                 else if (showTypeButtons && roadButton.getGlobalBounds().contains(sf::Vector2f(mousePos)))
@@ -404,7 +407,7 @@ int main()
                     currentMode = Mode::AddNode;
                     isDestinationNode = false;
                     showTypeButtons = false;
-                    foundPath.clear();
+                    foundPaths.clear();
                 }
                 // Check if remove button was clicked
                 else if (removeButton.getGlobalBounds().contains(sf::Vector2f(mousePos)))
@@ -419,7 +422,7 @@ int main()
                     selectedNodeType = -1;
                     selectedNodeIndex = -1;
                     showTypeButtons = false;
-                    foundPath.clear();
+                    foundPaths.clear();
                 }
                 // Check if remove edge button was clicked
                 else if (removeEdgeButton.getGlobalBounds().contains(sf::Vector2f(mousePos)))
@@ -428,7 +431,7 @@ int main()
                     removeEdgeNodeType = -1;
                     removeEdgeNodeIndex = -1;
                     showTypeButtons = false;
-                    foundPath.clear();
+                    foundPaths.clear();
                 }
                 // Check if find path button was clicked
                 else if (findPathButton.getGlobalBounds().contains(sf::Vector2f(mousePos)))
@@ -437,7 +440,9 @@ int main()
                     findPathNode1 = -1;
                     findPathNode2 = -1;
                     showTypeButtons = false;
-                    foundPath.clear();
+                    foundPaths.clear();
+                    queryWorker.cancel();
+                    pendingQuery.reset();
                 }
                 // Manual edge adding mode
                 else if (currentMode == Mode::AddEdge && (hoveredNodeType != -1 && hoveredNodeIndex != -1))
@@ -448,7 +453,7 @@ int main()
                         selectedNodeIndex = hoveredNodeIndex;
                     } else {
                         // Second node selected, create edge
-                        sf::Vector2f from, to;
+                        Vec2 from, to;
                         if (selectedNodeType == 0)
                             from = destinationNodes[selectedNodeIndex].position;
                         else
@@ -457,7 +462,15 @@ int main()
                             to = destinationNodes[hoveredNodeIndex].position;
                         else
                             to = roadNodes[hoveredNodeIndex].position;
-                        edges.push_back({from, to});
+                        // Adding an edge again replaces it, which is how existing edges are restyled
+                        edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const Edge& e) {
+                            return (e.from == from && e.to == to) || (e.from == to && e.to == from);
+                        }), edges.end());
+                        Edge edge{from, to};
+                        edge.roadClass = newEdgeClass;
+                        edge.oneWay = newEdgeOneWay;
+                        edges.push_back(edge);
+                        publishGraph();
                         // Reset selection for next edge
                         selectedNodeType = -1;
                         selectedNodeIndex = -1;
@@ -473,7 +486,7 @@ int main()
                         removeEdgeNodeIndex = hoveredNodeIndex;
                     } else {
                         // Second node selected, try to remove edge
-                        sf::Vector2f from, to;
+                        Vec2 from, to;
                         if (removeEdgeNodeType == 0)
                             from = destinationNodes[removeEdgeNodeIndex].position;
                         else
@@ -486,6 +499,7 @@ int main()
                         for (auto it = edges.begin(); it != edges.end(); ++it) {
                             if ((it->from == from && it->to == to) || (it->from == to && it->to == from)) {
                                 edges.erase(it);
+                                publishGraph();
                                 break;
                             }
                         }
@@ -501,14 +515,15 @@ int main()
                     // Check destination nodes
                     for (auto it = destinationNodes.begin(); it != destinationNodes.end(); ++it) {
                         sf::CircleShape nodeShape(5);
-                        nodeShape.setPosition(it->position);
+                        nodeShape.setPosition(toSf(it->position));
                         if (nodeShape.getGlobalBounds().contains(window.mapPixelToCoords(mousePos))) {
-                            sf::Vector2f removedPos = it->position;
+                            Vec2 removedPos = it->position;
                             destinationNodes.erase(it);
                             // Remove all edges connected to this node
                             edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const Edge& e) {
                                 return e.from == removedPos || e.to == removedPos;
                             }), edges.end());
+                            publishGraph();
                             currentMode = Mode::Idle;
                             break;
                         }
@@ -517,14 +532,15 @@ int main()
                     if (currentMode != Mode::RemoveNode) continue;
                     for (auto it = roadNodes.begin(); it != roadNodes.end(); ++it) {
                         sf::CircleShape nodeShape(5);
-                        nodeShape.setPosition(it->position);
+                        nodeShape.setPosition(toSf(it->position));
                         if (nodeShape.getGlobalBounds().contains(window.mapPixelToCoords(mousePos))) {
-                            sf::Vector2f removedPos = it->position;
+                            Vec2 removedPos = it->position;
                             roadNodes.erase(it);
                             // Remove all edges connected to this node
                             edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const Edge& e) {
                                 return e.from == removedPos || e.to == removedPos;
                             }), edges.end());
+                            publishGraph();
                             currentMode = Mode::Idle;
                             break;
                         }
@@ -538,13 +554,14 @@ int main()
                     sf::Vector2f worldPos = window.mapPixelToCoords(mousePos);
                     // Create and add the node
                     Node newNode;
-                    newNode.position = worldPos;
+                    newNode.position = toVec2(worldPos);
                     newNode.isDestination = isDestinationNode;
                     if (isDestinationNode) {
                         destinationNodes.push_back(newNode);
                     } else {
                         roadNodes.push_back(newNode);
                     }
+                    publishGraph();
                     currentMode = Mode::Idle;
                 }
                 // Find path mode
@@ -554,36 +571,59 @@ int main()
                         findPathNode1 = hoveredNodeIndex;
                     } else if (findPathNode2 == -1 && hoveredNodeIndex != findPathNode1) {
                         findPathNode2 = hoveredNodeIndex;
-                        // Run pathfinding here!
-                        foundPath = findShortestPath(
-                            destinationNodes[findPathNode1].position,
-                            destinationNodes[findPathNode2].position,
-                            destinationNodes, roadNodes, edges
-                        );
-                        currentMode = Mode::Idle;
-                        findPathNode1 = -1;
-                        findPathNode2 = -1;
+                        // Destinations come first in the graph, so their ids are their indices
+                        pendingQuery = queryWorker.submit(findPathNode1, findPathNode2, true, findPathRoutes);
+                        foundPaths.clear();
                     }
                 }
             }
         }
 
+        // Pick up a finished query
+        if (pendingQuery && pendingQuery->ready()) {
+            const PathResult& result = pendingQuery->result();
+            if (!result.cancelled) {
+                if (!pendingQuery->pathPoints().empty()) {
+                    foundPaths.push_back(pendingQuery->pathPoints());
+                    for (const auto& points : pendingQuery->alternativePoints()) foundPaths.push_back(points);
+                }
+#ifdef PATHFINDER_FRAME_PROFILER
+                frameProfiler.recordQuery(pendingQuery->elapsed(), result.stats.settled);
+#endif
+            }
+            pendingQuery.reset();
+            currentMode = Mode::Idle;
+            findPathNode1 = -1;
+            findPathNode2 = -1;
+        }
+
+        PROFILE_SECTION(Map);
         window.clear();
         window.draw(mapSprite); // Draw the map
 
         // Draw edges (thick lines)
+        PROFILE_SECTION(Edges);
         for (const auto& edge : edges) {
-            sf::Vector2f diff = edge.to - edge.from;
+            sf::Vector2f diff = toSf(edge.to) - toSf(edge.from);
             float length = std::sqrt(diff.x * diff.x + diff.y * diff.y);
             float angle = std::atan2(diff.y, diff.x) * 180 / 3.14159265f;
-            sf::RectangleShape thickLine(sf::Vector2f(length, 5)); // 5 pixels thick
-            thickLine.setPosition(edge.from);
-            thickLine.setFillColor(sf::Color::Yellow);
+            float thickness = kRoadClassThickness[static_cast<int>(edge.roadClass)];
+            sf::RectangleShape thickLine(sf::Vector2f(length, thickness));
+            thickLine.setOrigin(sf::Vector2f(0, thickness / 2 - 2.5f)); // centred where 5 px lines were
+            thickLine.setPosition(toSf(edge.from));
+            thickLine.setFillColor(kRoadClassColors[static_cast<int>(edge.roadClass)]);
             thickLine.setRotation(sf::degrees(angle));
             window.draw(thickLine);
+            if (edge.oneWay) {
+                // Arrow head halfway along, pointing from -> to
+                oneWayArrow.setPosition(toSf(edge.from) + diff * 0.5f + sf::Vector2f(0, 2.5f).rotatedBy(sf::degrees(angle)));
+                oneWayArrow.setRotation(sf::degrees(angle + 90));
+                window.draw(oneWayArrow);
+            }
         }
         
         // --- HOVER LOGIC ---
+        PROFILE_SECTION(Hover);
         hoveredNodeType = -1;
         hoveredNodeIndex = -1;
         sf::Vector2i mousePos = sf::Mouse::getPosition(window);
@@ -591,7 +631,7 @@ int main()
         // Check destination nodes
         for (size_t i = 0; i < destinationNodes.size(); ++i) {
             sf::CircleShape nodeShape(5);
-            nodeShape.setPosition(destinationNodes[i].position);
+            nodeShape.setPosition(toSf(destinationNodes[i].position));
             if (nodeShape.getGlobalBounds().contains(mouseWorld)) {
                 hoveredNodeType = 0;
                 hoveredNodeIndex = i;
@@ -603,7 +643,7 @@ int main()
         if (hoveredNodeType == -1) {
             for (size_t i = 0; i < roadNodes.size(); ++i) {
                 sf::CircleShape nodeShape(5);
-                nodeShape.setPosition(roadNodes[i].position);
+                nodeShape.setPosition(toSf(roadNodes[i].position));
                 if (nodeShape.getGlobalBounds().contains(mouseWorld)) {
                     hoveredNodeType = 1;
                     hoveredNodeIndex = i;
@@ -613,16 +653,17 @@ int main()
         }
 
         // Draw nodes
+        PROFILE_SECTION(Nodes);
         for (const auto& node : destinationNodes) {
             sf::CircleShape nodeShape(5);
-            nodeShape.setPosition(node.position);
+            nodeShape.setPosition(toSf(node.position));
             nodeShape.setFillColor(sf::Color::Red);
             window.draw(nodeShape);
         }
         
         for (const auto& node : roadNodes) {
             sf::CircleShape nodeShape(5);
-            nodeShape.setPosition(node.position);
+            nodeShape.setPosition(toSf(node.position));
             nodeShape.setFillColor(sf::Color::Blue);
             window.draw(nodeShape);
         }
@@ -631,10 +672,10 @@ int main()
         if (hoveredNodeType != -1 && hoveredNodeIndex != -1) {
             sf::CircleShape hoverShape(8);
             if (hoveredNodeType == 0) {
-                hoverShape.setPosition(destinationNodes[hoveredNodeIndex].position - sf::Vector2f(3, 3));
+                hoverShape.setPosition(toSf(destinationNodes[hoveredNodeIndex].position) - sf::Vector2f(3, 3));
                 hoverShape.setOutlineColor(sf::Color::Red);
             } else {
-                hoverShape.setPosition(roadNodes[hoveredNodeIndex].position - sf::Vector2f(3, 3));
+                hoverShape.setPosition(toSf(roadNodes[hoveredNodeIndex].position) - sf::Vector2f(3, 3));
                 hoverShape.setOutlineColor(sf::Color::Blue);
             }
             hoverShape.setFillColor(sf::Color::Transparent);
@@ -644,7 +685,7 @@ int main()
 
         // Draw selection highlight for manual edge
         if (currentMode == Mode::AddEdge && selectedNodeType != -1 && selectedNodeIndex != -1) {
-            sf::Vector2f pos = (selectedNodeType == 0) ? destinationNodes[selectedNodeIndex].position : roadNodes[selectedNodeIndex].position;
+            sf::Vector2f pos = toSf((selectedNodeType == 0) ? destinationNodes[selectedNodeIndex].position : roadNodes[selectedNodeIndex].position);
             sf::CircleShape selShape(10);
             selShape.setPosition(pos - sf::Vector2f(5, 5));
             selShape.setFillColor(sf::Color::Transparent);
@@ -654,7 +695,7 @@ int main()
         }
         // Draw selection highlight for manual edge removal
         if (currentMode == Mode::RemoveEdge && removeEdgeNodeType != -1 && removeEdgeNodeIndex != -1) {
-            sf::Vector2f pos = (removeEdgeNodeType == 0) ? destinationNodes[removeEdgeNodeIndex].position : roadNodes[removeEdgeNodeIndex].position;
+            sf::Vector2f pos = toSf((removeEdgeNodeType == 0) ? destinationNodes[removeEdgeNodeIndex].position : roadNodes[removeEdgeNodeIndex].position);
             sf::CircleShape selShape(10);
             selShape.setPosition(pos - sf::Vector2f(5, 5));
             selShape.setFillColor(sf::Color::Transparent);
@@ -665,7 +706,7 @@ int main()
 
         // Draw selection highlight for find path
         if (currentMode == Mode::FindPath && findPathNode1 != -1) {
-            sf::Vector2f pos = destinationNodes[findPathNode1].position;
+            sf::Vector2f pos = toSf(destinationNodes[findPathNode1].position);
             sf::CircleShape selShape(10);
             selShape.setPosition(pos - sf::Vector2f(5, 5));
             selShape.setFillColor(sf::Color::Transparent);
@@ -675,6 +716,7 @@ int main()
         }
 
         // Draw button and text
+        PROFILE_SECTION(Ui);
         window.draw(button);
         window.draw(buttonText);
         if (showTypeButtons) {
@@ -699,26 +741,34 @@ int main()
                 else
                     modeText.setString("Select second node (remove edge)");
                 break;
-            case Mode::AddEdge:
+            case Mode::AddEdge: {
+                // e.g. "Select first node (add main one-way edge)"
+                std::string style = std::string(roadClassName(newEdgeClass)) + (newEdgeOneWay ? " one-way" : "");
                 if (selectedNodeType == -1)
-                    modeText.setString("Select first node (add edge)");
+                    modeText.setString("Select first node (add " + style + " edge)");
                 else
-                    modeText.setString("Select second node (add edge)");
+                    modeText.setString("Select second node (add " + style + " edge)");
                 break;
+            }
             case Mode::AddNode:
                 if (isDestinationNode)
                     modeText.setString("Add destination");
                 else
                     modeText.setString("Add road");
                 break;
-            case Mode::FindPath:
+            case Mode::FindPath: {
+                std::string what = findPathRoutes == QueryRoutes::Alternatives ? "find routes"
+                                   : findPathRoutes == QueryRoutes::KShortest
+                                       ? "find " + std::to_string(kEditorPaths) + " shortest paths"
+                                       : "find path";
                 if (findPathNode1 == -1)
-                    modeText.setString("Select first node (find path)");
+                    modeText.setString("Select first node (" + what + ")");
                 else if (findPathNode2 == -1)
-                    modeText.setString("Select second node (find path)");
+                    modeText.setString("Select second node (" + what + ")");
                 else
-                    modeText.setString("Shortest path");
+                    modeText.setString("Searching...");
                 break;
+            }
             case Mode::Idle:
             default:
                 if (showTypeButtons)
@@ -736,24 +786,46 @@ int main()
         window.draw(findPathButton);
         window.draw(findPathText);
         
-        if (!foundPath.empty()) {
+        PROFILE_SECTION(Path);
+        if (pendingQuery) {
+            // Nodes the running search is about to settle
+            for (const Vec2& point : pendingQuery->frontier()) {
+                frontierDot.setPosition(toSf(point) - sf::Vector2f(2, 2));
+                window.draw(frontierDot);
+            }
+        }
+        // Worst route first so the best one is drawn on top
+        for (size_t route = foundPaths.size(); route-- > 0;) {
+            const std::vector<Vec2>& foundPath = foundPaths[route];
+            const sf::Color color = kRouteColors[route % kRouteColorCount];
             for (size_t i = 1; i < foundPath.size(); ++i) {
-                sf::Vector2f from = foundPath[i-1], to = foundPath[i];
+                sf::Vector2f from = toSf(foundPath[i-1]), to = toSf(foundPath[i]);
                 sf::Vector2f diff = to - from;
                 float length = std::sqrt(diff.x * diff.x + diff.y * diff.y);
                 float angle = std::atan2(diff.y, diff.x) * 180 / 3.14159265f;
-                sf::RectangleShape thickLine(sf::Vector2f(length, 7)); // 7 pixels thick
+                sf::RectangleShape thickLine(sf::Vector2f(length, route == 0 ? 7 : 5)); // 7 pixels thick, 5 for alternatives
                 thickLine.setPosition(from);
-                thickLine.setFillColor(sf::Color::Green);
+                thickLine.setFillColor(color);
                 thickLine.setRotation(sf::degrees(angle));
                 window.draw(thickLine);
             }
         }
         
+#ifdef PATHFINDER_FRAME_PROFILER
+        if (showProfiler) {
+            PROFILE_SECTION(Ui);
+            profilerText.setString(frameProfiler.overlayText());
+            window.draw(profilerBackground);
+            window.draw(profilerText);
+        }
+#endif
+
+        PROFILE_SECTION(Display);
         window.display();
     }
 
     // Save before normal program end
-    saveToFile(destinationNodes, roadNodes, edges);
+    saveToFile(destinationNodes, roadNodes, edges, turns);
+    writeMetricsOnExit();
     return 0;
 }
@@ -0,0 +1,655 @@
+// Query daemon: loads the graph once and answers route queries from many
+// local processes over a Unix domain socket (and optionally localhost TCP)
+// using the protocol in pathfinder/protocol.hpp.
+//
+//   pathfinder_server [--graph nodes.json] [--socket /tmp/pathfinder.sock]
+//                     [--tcp PORT] [--threads N] [--trace PATH]
+//                     [--metrics-file PATH] [--metrics-interval SECONDS]
+//                     [--hub-labels PATH] [--overlay]
+//
+// A single epoll loop owns every socket. Complete request frames are handed
+// to the worker pool; workers post encoded responses back through an eventfd
+// so the loop can write them. Requests on one connection are pipelined and
+// may be answered out of order. Linux only.
+//
+// --trace (or PATHFINDER_TRACE) records a Chrome trace-event timeline that is
+// written on shutdown. Metrics are served to Metrics requests and, with
+// --metrics-file, rewritten periodically for a Prometheus textfile collector.
+//
+// SIGHUP reloads the graph file in the background and publishes it as a new
+// version; requests never wait for a reload.
+//
+// --hub-labels loads labels written by pathfinder_cli --save-hub-labels for
+// the same graph file (see pathfinder/hub_labels.hpp). Route requests without
+// kWantPath are then answered by one label merge instead of a search, and
+// path requests too when the labels kept parents. A reload re-reads the
+// labels; until labels matching the new graph are loaded, requests fall back
+// to Dijkstra.
+//
+// --overlay answers the remaining route requests over a multi-level overlay
+// graph (see pathfinder/overlay.hpp). After a reload that kept the graph's
+// topology only the cells whose edges changed length are customized again;
+// new or removed nodes and edges partition the graph anew. Requests use
+// Dijkstra until the overlay has caught up with the new version.
+
+#include "pathfinder/graph.hpp"
+#include "pathfinder/graph_store.hpp"
+#include "pathfinder/hub_labels.hpp"
+#include "pathfinder/metrics.hpp"
+#include "pathfinder/overlay.hpp"
+#include "pathfinder/protocol.hpp"
+#include "pathfinder/storage.hpp"
+#include "pathfinder/thread_pool.hpp"
+#include "pathfinder/trace.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// epoll tags below kFirstConnection identify the fixed descriptors
+constexpr uint64_t kUnixListener = 1;
+constexpr uint64_t kTcpListener = 2;
+constexpr uint64_t kWakeup = 3;
+constexpr uint64_t kSignals = 4;
+constexpr uint64_t kMetricsTimer = 5;
+constexpr uint64_t kFirstConnection = 16;
+
+// Stop reading from a client that has this much work queued
+constexpr size_t kMaxInFlight = 4096;
+constexpr size_t kMaxPendingOutput = 8u << 20;
+
+struct Connection {
+    int fd = -1;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+    size_t outOffset = 0;
+    size_t inFlight = 0;
+    uint32_t events = 0;
+};
+
+struct Completion {
+    uint64_t connection;
+    std::vector<uint8_t> bytes;
+};
+
+// Hub labels and the graph version they were checked against
+struct ServedLabels {
+    HubLabels labels;
+    uint64_t graphNumber;
+};
+
+// Overlay graph and the graph version it was customized for
+struct ServedOverlay {
+    OverlayGraph overlay;
+    uint64_t graphNumber;
+};
+
+class Server {
+public:
+    Server(GraphStore& store, const std::string& graphPath, unsigned threads)
+        : store(store), graphPath(graphPath), pool(threads) {}
+
+    bool listenUnix(const std::string& path);
+    bool listenTcp(int port);
+    void setMetricsFile(const std::string& path, int intervalSeconds);
+    // Serves hub labels from path while the graph version matches them; the
+    // file is read again on every reload
+    bool serveLabels(const std::string& path);
+    // Routes over an overlay graph, kept up to date on every reload
+    void serveOverlay();
+    int run();
+
+private:
+    bool addFd(int fd, uint64_t tag, uint32_t events);
+    void acceptAll(int listener, bool tcp);
+    void readFrom(uint64_t id, Connection& conn);
+    void dispatch(uint64_t id, Connection& conn, const uint8_t* payload, size_t size);
+    void flush(uint64_t id, Connection& conn);
+    void updateEvents(uint64_t id, Connection& conn);
+    void drainCompletions();
+    void closeConnection(uint64_t id);
+    void writeMetrics();
+    void startReload();
+    bool loadLabels();
+    void refreshOverlay();
+
+    GraphStore& store;
+    std::string graphPath;
+    std::thread reloader;
+    std::atomic<bool> reloading{false};
+    std::string labelsPath;
+    std::shared_ptr<const ServedLabels> labels; // read and replaced with std::atomic_load/store
+    bool overlayEnabled = false;
+    std::shared_ptr<const ServedOverlay> overlay; // likewise
+    ThreadPool pool;
+    int epollFd = -1;
+    int wakeFd = -1;
+    int unixFd = -1;
+    int tcpFd = -1;
+    std::string unixPath;
+    uint64_t nextConnection = kFirstConnection;
+    std::unordered_map<uint64_t, Connection> connections;
+    std::string metricsPath;
+    int metricsInterval = 15;
+
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+
+    Counter& okRequests = serverRequests("ok");
+    Counter& unreachableRequests = serverRequests("unreachable");
+    Counter& badRequests = serverRequests("bad_request");
+    LatencyHistogram& requestLatency = metrics().histogram(
+        "pathfinder_server_request_duration_seconds", "Time from receiving a route request to its encoded response.");
+    Gauge& openConnections = metrics().gauge("pathfinder_server_connections", "Open client connections.");
+    Gauge& requestsInFlight = metrics().gauge("pathfinder_server_requests_in_flight", "Route requests queued or running.");
+    Gauge& graphVersion = metrics().gauge("pathfinder_server_graph_version", "Graph version new requests are answered on.");
+
+    static Counter& serverRequests(const char* status) {
+        return metrics().counter("pathfinder_server_requests_total", "Requests answered, by status.",
+                                 std::string("status=\"") + status + "\"");
+    }
+};
+
+bool Server::addFd(int fd, uint64_t tag, uint32_t events) {
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.u64 = tag;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+bool Server::listenUnix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << path << "\n";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unixFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    ::unlink(path.c_str()); // stale socket from a previous run
+    if (unixFd < 0 || bind(unixFd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 ||
+        listen(unixFd, SOMAXCONN) != 0) {
+        std::cerr << "Cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    unixPath = path;
+    return true;
+}
+
+bool Server::listenTcp(int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // local clients only
+    tcpFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (tcpFd >= 0) setsockopt(tcpFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    if (tcpFd < 0 || bind(tcpFd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 ||
+        listen(tcpFd, SOMAXCONN) != 0) {
+        std::cerr << "Cannot listen on 127.0.0.1:" << port << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    return true;
+}
+
+void Server::setMetricsFile(const std::string& path, int intervalSeconds) {
+    metricsPath = path;
+    metricsInterval = intervalSeconds > 0 ? intervalSeconds : 1;
+}
+
+void Server::writeMetrics() {
+    if (!metricsPath.empty() && !metrics().writePrometheusFile(metricsPath))
+        std::cerr << "Cannot write metrics to " << metricsPath << "\n";
+}
+
+int Server::run() {
+    // SIGINT/SIGTERM/SIGHUP are blocked in main before the pool starts; take them here
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    int signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0 || signalFd < 0 || !addFd(wakeFd, kWakeup, EPOLLIN) ||
+        !addFd(signalFd, kSignals, EPOLLIN) ||
+        (unixFd >= 0 && !addFd(unixFd, kUnixListener, EPOLLIN)) ||
+        (tcpFd >= 0 && !addFd(tcpFd, kTcpListener, EPOLLIN))) {
+        std::cerr << "Cannot set up event loop: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    int timerFd = -1;
+    if (!metricsPath.empty()) {
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        itimerspec period{};
+        period.it_interval.tv_sec = metricsInterval;
+        period.it_value.tv_sec = metricsInterval;
+        if (timerFd < 0 || timerfd_settime(timerFd, 0, &period, nullptr) != 0 ||
+            !addFd(timerFd, kMetricsTimer, EPOLLIN)) {
+            std::cerr << "Cannot set up metrics timer: " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+
+    graphVersion.set(static_cast<int64_t>(store.currentNumber()));
+    std::vector<epoll_event> events(256);
+    bool running = true;
+    while (running) {
+        int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait: " << std::strerror(errno) << "\n";
+            break;
+        }
+        TRACE_SCOPE_CATEGORY("server", "dispatchEvents");
+        for (int i = 0; i < count; ++i) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == kUnixListener) acceptAll(unixFd, false);
+            else if (tag == kTcpListener) acceptAll(tcpFd, true);
+            else if (tag == kWakeup) {
+                uint64_t value;
+                while (read(wakeFd, &value, sizeof value) > 0) {}
+                drainCompletions();
+            } else if (tag == kSignals) {
+                signalfd_siginfo info;
+                while (read(signalFd, &info, sizeof info) == sizeof info) {
+                    if (info.ssi_signo == SIGHUP) startReload();
+                    else running = false;
+                }
+            } else if (tag == kMetricsTimer) {
+                uint64_t expirations;
+                while (read(timerFd, &expirations, sizeof expirations) > 0) {}
+                writeMetrics();
+            } else {
+                auto it = connections.find(tag);
+                if (it == connections.end()) continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    closeConnection(tag);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) flush(tag, it->second);
+                it = connections.find(tag);
+                if (it != connections.end() && (events[i].events & EPOLLIN)) readFrom(tag, it->second);
+            }
+        }
+    }
+
+    pool.wait();
+    if (reloader.joinable()) reloader.join();
+    while (!connections.empty()) closeConnection(connections.begin()->first);
+    if (!unixPath.empty()) ::unlink(unixPath.c_str());
+    writeMetrics();
+    return 0;
+}
+
+// Loads and builds the new graph off the event loop, then publishes it.
+// Requests already running finish on the version they started with.
+void Server::startReload() {
+    if (reloading.exchange(true)) {
+        std::cerr << "Reload already in progress\n";
+        return;
+    }
+    if (reloader.joinable()) reloader.join();
+    reloader = std::thread([this] {
+        setTraceThreadName("reloader");
+        std::vector<Node> destinationNodes, roadNodes;
+        std::vector<Edge> edges;
+        if (loadFromFile(destinationNodes, roadNodes, edges, graphPath)) {
+            Graph graph = buildGraph(destinationNodes, roadNodes, edges);
+            int nodes = graph.nodeCount();
+            uint64_t number = store.publish(std::move(graph));
+            graphVersion.set(static_cast<int64_t>(number));
+            std::cerr << "Reloaded " << graphPath << ": version " << number << ", " << nodes << " nodes\n";
+            if (!labelsPath.empty() && !loadLabels())
+                std::cerr << "Answering version " << number << " without hub labels\n";
+            if (overlayEnabled) refreshOverlay();
+        } else {
+            std::cerr << "Cannot reload " << graphPath << "; still serving version " << store.currentNumber() << "\n";
+        }
+        reloading = false;
+    });
+}
+
+bool Server::serveLabels(const std::string& path) {
+    labelsPath = path;
+    return loadLabels();
+}
+
+bool Server::loadLabels() {
+    GraphStore::Reader pinned = store.read();
+    auto served = std::make_shared<ServedLabels>();
+    served->graphNumber = pinned.number();
+    bool ok = loadHubLabels(served->labels, labelsPath);
+    if (ok && served->labels.fingerprint != graphFingerprint(pinned.graph())) {
+        std::cerr << "Hub labels in " << labelsPath << " were built for a different graph\n";
+        ok = false;
+    }
+    std::atomic_store(&labels, ok ? std::shared_ptr<const ServedLabels>(std::move(served)) : nullptr);
+    return ok;
+}
+
+void Server::serveOverlay() {
+    overlayEnabled = true;
+    refreshOverlay();
+}
+
+// Customizes a copy: requests still running on the old version keep reading
+// the published overlay
+void Server::refreshOverlay() {
+    GraphStore::Reader pinned = store.read();
+    const Graph& graph = pinned.graph();
+    auto current = std::atomic_load(&overlay);
+    auto served = std::make_shared<ServedOverlay>();
+    served->graphNumber = pinned.number();
+    // Not the request pool: its wait() would also wait for requests
+    ThreadPool customizer(pool.size());
+    auto started = std::chrono::steady_clock::now();
+    if (current && overlayFits(current->overlay, graph)) {
+        served->overlay = current->overlay;
+        int cells = updateOverlay(served->overlay, graph, customizer);
+        std::cerr << "Overlay: customized " << cells << " changed cells";
+    } else {
+        served->overlay = buildOverlay(graph, customizer);
+        std::cerr << "Overlay: partitioned into " << served->overlay.levels.size() << " levels";
+    }
+    std::cerr << " in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count()
+              << " s\n";
+    std::atomic_store(&overlay, std::shared_ptr<const ServedOverlay>(std::move(served)));
+}
+
+void Server::acceptAll(int listener, bool tcp) {
+    while (true) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN or transient error
+        if (tcp) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        }
+        uint64_t id = nextConnection++;
+        Connection& conn = connections[id];
+        conn.fd = fd;
+        conn.events = EPOLLIN;
+        openConnections.add(1);
+        if (!addFd(fd, id, conn.events)) closeConnection(id);
+    }
+}
+
+void Server::readFrom(uint64_t id, Connection& conn) {
+    uint8_t buffer[64 * 1024];
+    while (conn.inFlight < kMaxInFlight && conn.out.size() - conn.outOffset < kMaxPendingOutput) {
+        ssize_t n = recv(conn.fd, buffer, sizeof buffer, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            closeConnection(id);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        conn.in.insert(conn.in.end(), buffer, buffer + n);
+
+        size_t consumed = 0;
+        while (true) {
+            size_t frame = completeFrameSize(conn.in.data() + consumed, conn.in.size() - consumed);
+            if (frame == kInvalidFrame) {
+                closeConnection(id);
+                return;
+            }
+            if (frame == 0) break;
+            dispatch(id, conn, conn.in.data() + consumed + kFrameHeaderSize, frame - kFrameHeaderSize);
+            consumed += frame;
+        }
+        conn.in.erase(conn.in.begin(), conn.in.begin() + consumed);
+    }
+    flush(id, conn);
+}
+
+void Server::dispatch(uint64_t id, Connection& conn, const uint8_t* payload, size_t size) {
+    Request request;
+    if (!parseRequest(payload, size, request)) {
+        Response response;
+        response.id = request.id;
+        response.type = request.type;
+        response.status = Status::BadRequest;
+        appendResponse(conn.out, response);
+        badRequests.add();
+        return;
+    }
+    if (request.type == MessageType::Metrics) {
+        Response response;
+        response.id = request.id;
+        response.type = MessageType::Metrics;
+        response.text = metrics().prometheusText();
+        appendResponse(conn.out, response);
+        return;
+    }
+    if (request.type == MessageType::Info) {
+        Response response;
+        response.id = request.id;
+        response.type = MessageType::Info;
+        GraphStore::Reader pinned = store.read();
+        const Graph& graph = pinned.graph();
+        response.nodeCount = static_cast<uint32_t>(graph.nodeCount());
+        response.destinationCount = static_cast<uint32_t>(graph.destinationCount);
+        appendResponse(conn.out, response);
+        return;
+    }
+
+    ++conn.inFlight;
+    requestsInFlight.add(1);
+    auto received = MetricsClock::now();
+    pool.submit([this, id, request, received] {
+        thread_local SearchContext context;
+        Response response;
+        response.id = request.id;
+        response.type = MessageType::Route;
+        GraphStore::Reader pinned = store.read();
+        const Graph& graph = pinned.graph();
+        uint32_t n = static_cast<uint32_t>(graph.nodeCount());
+        auto served = std::atomic_load(&labels);
+        if (served && served->graphNumber != pinned.number()) served = nullptr;
+        auto routes = std::atomic_load(&overlay);
+        if (routes && routes->graphNumber != pinned.number()) routes = nullptr;
+        bool wantPath = request.flags & kWantPath;
+        if (request.source >= n || request.target >= n) {
+            response.status = Status::BadRequest;
+        } else if (served && !wantPath) {
+            response.distance = hubDistance(served->labels, request.source, request.target);
+            response.status = response.distance == kInfinity ? Status::Unreachable : Status::Ok;
+        } else {
+            PathResult result;
+            if (served && served->labels.hasParents())
+                result = hubShortestPath(served->labels, request.source, request.target);
+            else if (routes)
+                result = overlayShortestPath(graph, routes->overlay, request.source, request.target, context);
+            else
+                result = shortestPath(graph, request.source, request.target, context);
+            response.settled = static_cast<uint32_t>(result.stats.settled);
+            response.distance = result.distance;
+            response.status = result.distance == kInfinity ? Status::Unreachable : Status::Ok;
+            if (wantPath) response.path.assign(result.path.begin(), result.path.end());
+        }
+        Completion completion{id, {}};
+        appendResponse(completion.bytes, response);
+        requestLatency.record(MetricsClock::now() - received);
+        switch (response.status) {
+            case Status::Ok: okRequests.add(); break;
+            case Status::Unreachable: unreachableRequests.add(); break;
+            case Status::BadRequest: badRequests.add(); break;
+        }
+
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            wake = completions.empty(); // the loop drains everything per wakeup
+            completions.push_back(std::move(completion));
+        }
+        if (wake) {
+            uint64_t one = 1;
+            (void)!write(wakeFd, &one, sizeof one);
+        }
+    });
+}
+
+void Server::drainCompletions() {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        ready.swap(completions);
+    }
+    requestsInFlight.add(-static_cast<int64_t>(ready.size()));
+    std::vector<uint64_t> touched;
+    for (auto& completion : ready) {
+        auto it = connections.find(completion.connection);
+        if (it == connections.end()) continue; // client went away
+        Connection& conn = it->second;
+        if (conn.out.size() == conn.outOffset) touched.push_back(completion.connection);
+        conn.out.insert(conn.out.end(), completion.bytes.begin(), completion.bytes.end());
+        --conn.inFlight;
+    }
+    for (uint64_t id : touched) {
+        auto it = connections.find(id);
+        if (it != connections.end()) flush(id, it->second);
+    }
+}
+
+void Server::flush(uint64_t id, Connection& conn) {
+    while (conn.outOffset < conn.out.size()) {
+        ssize_t n = send(conn.fd, conn.out.data() + conn.outOffset, conn.out.size() - conn.outOffset,
+                         MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            closeConnection(id);
+            return;
+        }
+        conn.outOffset += static_cast<size_t>(n);
+    }
+    if (conn.outOffset == conn.out.size()) {
+        conn.out.clear();
+        conn.outOffset = 0;
+    }
+    updateEvents(id, conn);
+}
+
+void Server::updateEvents(uint64_t id, Connection& conn) {
+    uint32_t wanted = 0;
+    if (conn.inFlight < kMaxInFlight && conn.out.size() - conn.outOffset < kMaxPendingOutput)
+        wanted |= EPOLLIN;
+    if (conn.outOffset < conn.out.size()) wanted |= EPOLLOUT;
+    if (wanted == conn.events) return;
+    epoll_event ev{};
+    ev.events = wanted;
+    ev.data.u64 = id;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+    conn.events = wanted;
+}
+
+void Server::closeConnection(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end()) return;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    close(it->second.fd);
+    connections.erase(it);
+    openConnections.add(-1);
+}
+
+void printUsage() {
+    std::cerr << "usage: pathfinder_server [--graph nodes.json] [--socket PATH] [--tcp PORT] [--threads N]"
+                 " [--trace PATH]\n"
+                 "                         [--metrics-file PATH] [--metrics-interval SECONDS] [--hub-labels PATH]\n"
+                 "                         [--overlay]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string graphPath = "nodes.json";
+    std::string socketPath = "/tmp/pathfinder.sock";
+    int tcpPort = 0;
+    unsigned threads = 0;
+    std::string tracePath = traceOutputFromEnvironment();
+    std::string metricsPath = metricsOutputFromEnvironment();
+    int metricsInterval = 15;
+    std::string labelsPath;
+    bool useOverlay = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--graph" && i + 1 < argc) graphPath = argv[++i];
+        else if (arg == "--socket" && i + 1 < argc) socketPath = argv[++i];
+        else if (arg == "--tcp" && i + 1 < argc) tcpPort = std::atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg == "--metrics-file" && i + 1 < argc) metricsPath = argv[++i];
+        else if (arg == "--metrics-interval" && i + 1 < argc) metricsInterval = std::atoi(argv[++i]);
+        else if (arg == "--hub-labels" && i + 1 < argc) labelsPath = argv[++i];
+        else if (arg == "--overlay") useOverlay = true;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Outlives the server so the workers have stopped before the trace is written
+    TraceSession trace(tracePath);
+    setTraceThreadName("event loop");
+
+    std::vector<Node> destinationNodes, roadNodes;
+    std::vector<Edge> edges;
+    if (!loadFromFile(destinationNodes, roadNodes, edges, graphPath)) {
+        std::cerr << "Cannot load graph " << graphPath << "\n";
+        return 1;
+    }
+    GraphStore store(buildGraph(destinationNodes, roadNodes, edges));
+
+    // Block the handled signals before the pool starts so only the signalfd sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    Server server(store, graphPath, threads);
+    if (!metricsPath.empty()) server.setMetricsFile(metricsPath, metricsInterval);
+    if (!labelsPath.empty() && !server.serveLabels(labelsPath)) return 1;
+    if (useOverlay) server.serveOverlay();
+    if (!socketPath.empty() && !server.listenUnix(socketPath)) return 1;
+    if (tcpPort > 0 && !server.listenTcp(tcpPort)) return 1;
+    if (socketPath.empty() && tcpPort <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    std::cerr << "Serving " << store.read().graph().nodeCount() << " nodes";
+    if (!socketPath.empty()) std::cerr << " on " << socketPath;
+    if (tcpPort > 0) std::cerr << " on 127.0.0.1:" << tcpPort;
+    std::cerr << "\n";
+    return server.run();
+}
@@ -0,0 +1,91 @@
+#include "pathfinder/alt.hpp"
+#include "pathfinder/arc_flags.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(Alt, MatchesReference) {
+    ThreadPool pool(3);
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        for (LandmarkStrategy strategy : {LandmarkStrategy::Farthest, LandmarkStrategy::Avoid}) {
+            // Fewer landmarks than kActiveLandmarks, and more
+            for (int count : {1, 16}) {
+                LandmarkIndex index = buildLandmarkIndex(map.graph, count, strategy, pool);
+                // Up to count: selection stops once the landmarks reach nothing new
+                ASSERT_GE(index.count(), 1);
+                ASSERT_LE(index.count(), count);
+                forEachPair(map, [&](int source, int target, float expected) {
+                    PathResult result = altShortestPath(map.graph, index, source, target, context);
+                    EXPECT_TRUE(isShortestPath(map.graph, result, source, target, expected));
+                });
+            }
+        }
+    }
+}
+
+TEST(Alt, UpdatedDistancesFollowWeightChanges) {
+    ThreadPool pool(2);
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        LandmarkIndex index = buildLandmarkIndex(map.graph, 8, LandmarkStrategy::Avoid, pool);
+        // Some arcs cheaper, some dearer: the old bounds would overestimate
+        Graph edited = map.graph;
+        for (size_t e = 0; e < edited.weight.size(); ++e) edited.weight[e] *= e % 3 == 0 ? 0.25f : 2.0f;
+        const std::vector<int> landmarks = index.landmarks;
+        ASSERT_TRUE(updateLandmarkDistances(edited, index, pool));
+        EXPECT_EQ(index.landmarks, landmarks);
+        for (size_t i = 0; i < map.sources.size(); ++i) {
+            std::vector<float> reference = referenceDistances(edited, map.sources[i]);
+            for (int target : map.targets[i]) {
+                PathResult result = altShortestPath(edited, index, map.sources[i], target, context);
+                EXPECT_TRUE(isShortestPath(edited, result, map.sources[i], target, reference[target]));
+            }
+        }
+    }
+}
+
+TEST(Alt, CombinesWithArcFlags) {
+    ThreadPool pool(2);
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        LandmarkIndex index = buildLandmarkIndex(map.graph, 8, LandmarkStrategy::Avoid, pool);
+        ArcFlags flags = buildArcFlags(map.graph, 8, pool);
+        forEachPair(map, [&](int source, int target, float expected) {
+            PathResult result = altShortestPath(map.graph, index, source, target, context, nullptr, &flags);
+            EXPECT_TRUE(isShortestPath(map.graph, result, source, target, expected));
+        });
+    }
+}
+
+TEST(Alt, CancelledRebuildStops) {
+    ThreadPool pool(2);
+    Graph graph = buildGraph(makeGridMap(60, 60));
+    std::atomic<bool> cancel{true};
+    EXPECT_EQ(buildLandmarkIndex(graph, 8, LandmarkStrategy::Avoid, pool, 1, &cancel).count(), 0);
+
+    cancel = false;
+    LandmarkIndex index = buildLandmarkIndex(graph, 8, LandmarkStrategy::Avoid, pool, 1, &cancel);
+    ASSERT_EQ(index.count(), 8);
+    const std::vector<float> distances = index.fromLandmark;
+    Graph edited = graph;
+    for (float& weight : edited.weight) weight *= 2;
+    cancel = true;
+    EXPECT_FALSE(updateLandmarkDistances(edited, index, pool, &cancel));
+    EXPECT_EQ(index.fromLandmark, distances);
+    cancel = false;
+    EXPECT_TRUE(updateLandmarkDistances(edited, index, pool, &cancel));
+    EXPECT_FLOAT_EQ(index.fromLandmark[1], 2 * distances[1]);
+}
+
+TEST(Alt, ParsesStrategyNames) {
+    LandmarkStrategy strategy = LandmarkStrategy::Avoid;
+    EXPECT_TRUE(parseLandmarkStrategy("farthest", strategy));
+    EXPECT_EQ(strategy, LandmarkStrategy::Farthest);
+    EXPECT_TRUE(parseLandmarkStrategy("avoid", strategy));
+    EXPECT_EQ(strategy, LandmarkStrategy::Avoid);
+    EXPECT_FALSE(parseLandmarkStrategy("random", strategy));
+}
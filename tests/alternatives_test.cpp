@@ -0,0 +1,122 @@
+#include "pathfinder/alternatives.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <set>
+
+namespace {
+
+// Cost of the steps of path that are also steps of one of routes
+float sharedCost(const Graph& graph, const std::vector<int>& path, const std::vector<PathResult>& routes) {
+    std::set<std::pair<int, int>> taken;
+    for (const PathResult& route : routes) {
+        for (size_t i = 1; i < route.path.size(); ++i) taken.emplace(route.path[i - 1], route.path[i]);
+    }
+    float shared = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        if (taken.count({path[i - 1], path[i]})) shared += pathCost(graph, {path[i - 1], path[i]});
+    }
+    return shared;
+}
+
+} // namespace
+
+TEST(Alternatives, RoutesAreAdmissible) {
+    AlternativeSearch search;
+    const AlternativeOptions options;
+    int alternatives = 0;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        Graph reversed = reverseGraph(map.graph);
+        forEachPair(map, [&](int source, int target, float expected) {
+            std::vector<PathResult> routes = alternativeRoutes(map.graph, reversed, source, target, search);
+            if (expected == kInfinity) {
+                EXPECT_TRUE(routes.empty());
+                return;
+            }
+            ASSERT_FALSE(routes.empty());
+            ASSERT_LE(static_cast<int>(routes.size()), options.maxRoutes);
+            EXPECT_TRUE(isShortestPath(map.graph, routes[0], source, target, expected));
+            for (size_t i = 1; i < routes.size(); ++i) {
+                const PathResult& route = routes[i];
+                ++alternatives;
+                ASSERT_GE(route.path.size(), 2u);
+                EXPECT_EQ(route.path.front(), source);
+                EXPECT_EQ(route.path.back(), target);
+                EXPECT_TRUE(sameDistance(route.distance, pathCost(map.graph, route.path)));
+                EXPECT_LE(route.distance, options.maxStretch * expected * (1 + 1e-5f));
+                std::vector<int> nodes = route.path;
+                std::sort(nodes.begin(), nodes.end());
+                EXPECT_EQ(std::adjacent_find(nodes.begin(), nodes.end()), nodes.end()) << "route visits a node twice";
+                std::vector<PathResult> above(routes.begin(), routes.begin() + static_cast<std::ptrdiff_t>(i));
+                EXPECT_LE(sharedCost(map.graph, route.path, above), options.maxSharing * expected * (1 + 1e-5f));
+            }
+        });
+    }
+    // The maps have room for detours, so some must be found
+    EXPECT_GT(alternatives, 0);
+}
+
+TEST(Alternatives, HonoursRouteLimit) {
+    AlternativeSearch search;
+    AlternativeOptions options;
+    options.maxRoutes = 1;
+    const TestMap& map = testMaps().front();
+    Graph reversed = reverseGraph(map.graph);
+    forEachPair(map, [&](int source, int target, float expected) {
+        std::vector<PathResult> routes = alternativeRoutes(map.graph, reversed, source, target, search, options);
+        ASSERT_EQ(routes.size(), expected == kInfinity ? 0u : 1u);
+        if (!routes.empty()) {
+            EXPECT_TRUE(isShortestPath(map.graph, routes[0], source, target, expected));
+        }
+    });
+}
+
+TEST(Alternatives, FindsBothSidesOfARing) {
+    // A 4 x 4 grid with its inner 2 x 2 removed: two equal ways round
+    RandomMap ring;
+    auto at = [](int x, int y) { return Vec2{x * 10.0f, y * 10.0f}; };
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            if (x > 0 && x < 3 && y > 0 && y < 3) continue;
+            ring.roadNodes.push_back(Node{at(x, y), false});
+            if (x < 3 && (y == 0 || y == 3)) ring.edges.push_back(Edge{at(x, y), at(x + 1, y)});
+            if (y < 3 && (x == 0 || x == 3)) ring.edges.push_back(Edge{at(x, y), at(x, y + 1)});
+        }
+    }
+    Graph graph = buildGraph(ring);
+    Graph reversed = reverseGraph(graph);
+    AlternativeSearch search;
+    // Opposite corners
+    std::vector<PathResult> routes = alternativeRoutes(graph, reversed, 0, graph.nodeCount() - 1, search);
+    ASSERT_EQ(routes.size(), 2u);
+    EXPECT_FLOAT_EQ(routes[0].distance, 60);
+    EXPECT_FLOAT_EQ(routes[1].distance, 60);
+    EXPECT_NE(routes[0].path[1], routes[1].path[1]);
+}
+
+TEST(Alternatives, CancelledSearchStopsEarly) {
+    Graph graph = buildGraph(makeGridMap(100, 100));
+    Graph reversed = reverseGraph(graph);
+    const int corner = graph.nodeCount() - 1;
+    AlternativeSearch search;
+    std::atomic<bool> cancel{false};
+    int progressCalls = 0;
+    SearchControl control;
+    control.cancel = &cancel;
+    control.progress = [&](const SearchContext&) { ++progressCalls; };
+
+    std::vector<PathResult> finished = alternativeRoutes(graph, reversed, 0, corner, search, {}, &control);
+    ASSERT_FALSE(finished.empty());
+    EXPECT_FALSE(finished[0].cancelled);
+    EXPECT_FLOAT_EQ(finished[0].distance, 99 * 10.0f * 2);
+    EXPECT_GT(progressCalls, 0);
+
+    cancel = true;
+    std::vector<PathResult> cancelled = alternativeRoutes(graph, reversed, 0, corner, search, {}, &control);
+    ASSERT_EQ(cancelled.size(), 1u);
+    EXPECT_TRUE(cancelled[0].cancelled);
+    EXPECT_TRUE(cancelled[0].path.empty());
+    EXPECT_LE(cancelled[0].stats.settled, kProgressInterval);
+}
@@ -0,0 +1,36 @@
+#include "pathfinder/arc_flags.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+TEST(ArcFlags, MatchesReference) {
+    ThreadPool pool(3);
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        for (int regionCount : {1, 8, kMaxRegions}) {
+            ArcFlags flags = buildArcFlags(map.graph, regionCount, pool);
+            ASSERT_EQ(flags.regionCount, regionCount);
+            ASSERT_EQ(flags.flags.size(), map.graph.target.size());
+            forEachPair(map, [&](int source, int target, float expected) {
+                PathResult result = arcFlagsShortestPath(map.graph, flags, source, target, context);
+                EXPECT_TRUE(isShortestPath(map.graph, result, source, target, expected));
+            });
+        }
+    }
+}
+
+TEST(ArcFlags, RegionsAreBalanced) {
+    const TestMap& map = testMaps().front();
+    const int n = map.graph.nodeCount();
+    std::vector<int> region = kdRegions(map.graph, 8);
+    ASSERT_EQ(static_cast<int>(region.size()), n);
+    std::vector<int> size(8, 0);
+    for (int r : region) {
+        ASSERT_GE(r, 0);
+        ASSERT_LT(r, 8);
+        ++size[r];
+    }
+    EXPECT_LE(*std::max_element(size.begin(), size.end()) - *std::min_element(size.begin(), size.end()), 1);
+}
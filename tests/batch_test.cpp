@@ -0,0 +1,51 @@
+#include "pathfinder/batch.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::vector<std::pair<int, int>> samplePairs(const TestMap& map, std::vector<float>& expected) {
+    std::vector<std::pair<int, int>> pairs;
+    forEachPair(map, [&](int source, int target, float distance) {
+        pairs.emplace_back(source, target);
+        expected.push_back(distance);
+    });
+    return pairs;
+}
+
+} // namespace
+
+TEST(Batch, MatchesReferenceInInputOrder) {
+    ThreadPool pool(4);
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        std::vector<float> expected;
+        auto pairs = samplePairs(map, expected);
+        BatchQueryRunner runner(map.graph, pool);
+        std::vector<PathResult> results = runner.run(pairs);
+        ASSERT_EQ(results.size(), pairs.size());
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            EXPECT_TRUE(isShortestPath(map.graph, results[i], pairs[i].first, pairs[i].second, expected[i]));
+        }
+        // Reused, and without paths
+        results = runner.run(pairs, false);
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            EXPECT_TRUE(sameDistance(expected[i], results[i].distance));
+            EXPECT_TRUE(results[i].path.empty());
+        }
+    }
+}
+
+TEST(Batch, RunsTheGivenEngine) {
+    ThreadPool pool(2);
+    const TestMap& map = testMaps().front();
+    std::vector<float> expected;
+    auto pairs = samplePairs(map, expected);
+    Graph reversed = reverseGraph(map.graph);
+    BatchQueryRunner runner(map.graph, pool, [&](int source, int target, SearchContext& context) {
+        return shortestPath(reversed, target, source, context);
+    });
+    std::vector<PathResult> results = runner.run(pairs, false);
+    for (size_t i = 0; i < pairs.size(); ++i) EXPECT_TRUE(sameDistance(expected[i], results[i].distance));
+}
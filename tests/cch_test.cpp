@@ -0,0 +1,54 @@
+#include "pathfinder/cch.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+TEST(Cch, MatchesReference) {
+    ThreadPool pool(3);
+    CchQueryContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        CchTopology topology = buildCchTopology(map.graph);
+        ASSERT_EQ(topology.nodeCount(), map.graph.nodeCount());
+        std::vector<int> sorted = topology.order;
+        std::sort(sorted.begin(), sorted.end());
+        for (int v = 0; v < map.graph.nodeCount(); ++v) {
+            ASSERT_EQ(sorted[v], v);
+            EXPECT_EQ(topology.rank[topology.order[v]], v);
+        }
+        CchMetric metric = customizeCch(topology, map.graph, pool);
+        forEachPair(map, [&](int source, int target, float expected) {
+            PathResult result = cchShortestPath(topology, metric, source, target, context);
+            EXPECT_TRUE(isShortestPath(map.graph, result, source, target, expected));
+        });
+    }
+}
+
+TEST(Cch, RecustomizesAfterWeightChanges) {
+    ThreadPool pool(2);
+    CchQueryContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        CchTopology topology = buildCchTopology(map.graph);
+        Graph edited = map.graph;
+        for (size_t e = 0; e < edited.weight.size(); ++e) edited.weight[e] *= e % 3 == 0 ? 0.25f : 2.0f;
+        ASSERT_TRUE(sameTopology(topology, edited));
+        CchMetric metric = customizeCch(topology, edited, pool);
+        for (size_t i = 0; i < map.sources.size(); ++i) {
+            std::vector<float> reference = referenceDistances(edited, map.sources[i]);
+            for (int target : map.targets[i]) {
+                PathResult result = cchShortestPath(topology, metric, map.sources[i], target, context);
+                EXPECT_TRUE(isShortestPath(edited, result, map.sources[i], target, reference[target]));
+            }
+        }
+    }
+}
+
+TEST(Cch, NoticesTopologyChanges) {
+    const TestMap& map = testMaps().front();
+    CchTopology topology = buildCchTopology(map.graph);
+    Graph edited = map.graph;
+    edited.target[0] = edited.target[0] == 0 ? 1 : 0;
+    EXPECT_FALSE(sameTopology(topology, edited));
+}
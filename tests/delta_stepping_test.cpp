@@ -0,0 +1,31 @@
+#include "pathfinder/delta_stepping.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(DeltaStepping, MatchesReference) {
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        // Widths from close to Dijkstra to close to Bellman-Ford
+        for (float scale : {0.25f, 2.0f, 50.0f}) {
+            DeltaSteppingIndex index = buildDeltaSteppingIndex(map.graph, suggestDelta(map.graph, scale));
+            for (unsigned threads : {1u, 4u}) {
+                ThreadPool pool(threads);
+                DeltaSteppingResult result;
+                for (size_t i = 0; i < map.sources.size(); ++i) {
+                    deltaSteppingTree(map.graph, index, map.sources[i], pool, result);
+                    for (int v = 0; v < map.graph.nodeCount(); ++v) {
+                        const float expected = map.reference[i][v];
+                        ASSERT_TRUE(sameDistance(expected, result.dist[v]))
+                            << "scale " << scale << ", " << threads << " threads, node " << v;
+                        // The tree leads back to the source over arcs that add up
+                        if (expected == kInfinity || v == map.sources[i]) continue;
+                        const int parent = result.prev[v];
+                        ASSERT_GE(parent, 0);
+                        EXPECT_TRUE(sameDistance(expected, result.dist[parent] + pathCost(map.graph, {parent, v})));
+                    }
+                }
+            }
+        }
+    }
+}
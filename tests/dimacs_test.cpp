@@ -0,0 +1,146 @@
+#include "pathfinder/dimacs.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <fstream>
+
+namespace {
+
+void writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream out(path);
+    out << contents;
+}
+
+Graph loadGraph(const std::string& gr, const std::string& co) {
+    TempFile grFile("graph.gr"), coFile("graph.co");
+    writeFile(grFile.path(), gr);
+    writeFile(coFile.path(), co);
+    std::vector<Node> destinationNodes;
+    std::vector<IdArc> arcs;
+    EXPECT_TRUE(loadDimacsGraph(grFile.path(), coFile.path(), destinationNodes, arcs));
+    return buildGraph(destinationNodes, {}, arcs);
+}
+
+} // namespace
+
+TEST(Dimacs, LoadsArcsByVertexId) {
+    Graph graph = loadGraph("c arcs\n"
+                            "p sp 4 7\n"
+                            "a 1 2 5\n"
+                            "a 2 1 5\n"
+                            "a 2 3 4\n"
+                            "a 2 3 9\n"  // parallel, the shorter one is kept
+                            "a 3 4 1\n"
+                            "a 4 4 2\n"  // self loop, dropped
+                            "a 4 1 30\n",
+                            "p aux sp co 4\n"
+                            "v 1 -73000000 41000000\n"
+                            "v 2 -73000010 41000000\n"
+                            "v 3 -73000010 41000020\n"
+                            "v 4 -73000000 41000020\n");
+    ASSERT_EQ(graph.nodeCount(), 4);
+    EXPECT_EQ(graph.destinationCount, 4);
+    EXPECT_EQ(graph.target.size(), 5u);
+    SearchContext context;
+    EXPECT_FLOAT_EQ(shortestPath(graph, 0, 3, context).distance, 10);
+    EXPECT_FLOAT_EQ(shortestPath(graph, 3, 2, context).distance, 39);
+    EXPECT_FLOAT_EQ(shortestPath(graph, 2, 1, context).distance, 36);
+    // North is up: larger latitudes get smaller y
+    EXPECT_EQ(graph.positions[0].x, 10);
+    EXPECT_EQ(graph.positions[1].x, 0);
+    EXPECT_EQ(graph.positions[0].y, 20);
+    EXPECT_EQ(graph.positions[2].y, 0);
+}
+
+TEST(Dimacs, VerticesSharingCoordinatesStayDistinct) {
+    Graph graph = loadGraph("p sp 3 2\n"
+                            "a 1 2 10\n"
+                            "a 1 3 7\n",
+                            "p aux sp co 3\n"
+                            "v 1 0 0\n"
+                            "v 2 5 5\n"
+                            "v 3 5 5\n");
+    ASSERT_EQ(graph.nodeCount(), 3);
+    SearchContext context;
+    EXPECT_FLOAT_EQ(shortestPath(graph, 0, 1, context).distance, 10);
+    EXPECT_FLOAT_EQ(shortestPath(graph, 0, 2, context).distance, 7);
+}
+
+TEST(Dimacs, VerticesCloserThanFloatPrecisionStayDistinct) {
+    // 5.7e7 micro-degrees apart, beyond float's 2^24: the two eastern
+    // vertices round to the same position
+    Graph graph = loadGraph("p sp 3 2\n"
+                            "a 1 2 10\n"
+                            "a 1 3 7\n",
+                            "p aux sp co 3\n"
+                            "v 1 -124000000 40000000\n"
+                            "v 2 -67000000 40000000\n"
+                            "v 3 -66999999 40000000\n");
+    ASSERT_EQ(graph.nodeCount(), 3);
+    EXPECT_EQ(graph.positions[1], graph.positions[2]);
+    SearchContext context;
+    EXPECT_FLOAT_EQ(shortestPath(graph, 0, 1, context).distance, 10);
+    EXPECT_FLOAT_EQ(shortestPath(graph, 0, 2, context).distance, 7);
+}
+
+TEST(Dimacs, RandomMapMatchesReference) {
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        // Integer lengths keep the .gr file exact
+        if (map.name.find("integer") == std::string::npos) continue;
+        std::string gr = "p sp " + std::to_string(map.graph.nodeCount()) + " " +
+                         std::to_string(map.graph.target.size()) + "\n";
+        std::string co = "p aux sp co " + std::to_string(map.graph.nodeCount()) + "\n";
+        for (int u = 0; u < map.graph.nodeCount(); ++u) {
+            co += "v " + std::to_string(u + 1) + " " + std::to_string(static_cast<int>(map.graph.positions[u].x)) +
+                  " " + std::to_string(static_cast<int>(map.graph.positions[u].y)) + "\n";
+            for (int e = map.graph.firstEdge[u]; e < map.graph.firstEdge[u + 1]; ++e) {
+                gr += "a " + std::to_string(u + 1) + " " + std::to_string(map.graph.target[e] + 1) + " " +
+                      std::to_string(static_cast<int>(map.graph.weight[e])) + "\n";
+            }
+        }
+        Graph graph = loadGraph(gr, co);
+        SearchContext context;
+        forEachPair(map, [&](int source, int target, float expected) {
+            EXPECT_TRUE(isShortestPath(graph, shortestPath(graph, source, target, context), source, target,
+                                       expected));
+        });
+    }
+}
+
+TEST(Dimacs, RejectsMalformedGraphs) {
+    TempFile grFile("bad.gr"), coFile("bad.co");
+    std::vector<Node> destinationNodes;
+    std::vector<IdArc> arcs;
+    writeFile(coFile.path(), "p aux sp co 2\nv 1 0 0\n");
+    writeFile(grFile.path(), "p sp 2 1\na 1 2 3\n");
+    EXPECT_FALSE(loadDimacsGraph(grFile.path(), coFile.path(), destinationNodes, arcs)); // vertex 2 not placed
+    writeFile(coFile.path(), "p aux sp co 2\nv 1 0 0\nv 2 1 1\n");
+    writeFile(grFile.path(), "p sp 2 1\na 1 3 3\n");
+    EXPECT_FALSE(loadDimacsGraph(grFile.path(), coFile.path(), destinationNodes, arcs)); // unknown vertex
+    writeFile(grFile.path(), "p sp 2 1\na 1 2 3\n");
+    for (const char* count : {"-1", "4294967296", "99999999999999999"}) {
+        SCOPED_TRACE(count);
+        writeFile(coFile.path(), std::string("p aux sp co ") + count + "\nv 1 0 0\nv 2 1 1\n");
+        EXPECT_FALSE(loadDimacsGraph(grFile.path(), coFile.path(), destinationNodes, arcs)); // count out of range
+    }
+}
+
+TEST(Dimacs, LoadsQueryFiles) {
+    TempFile file("queries");
+    writeFile(file.path(), "c pairs\np aux sp p2p 2\nq 1 3\nq 4 2\n");
+    DimacsQueries pairs;
+    ASSERT_TRUE(loadDimacsQueries(file.path(), pairs));
+    EXPECT_FALSE(pairs.singleSource);
+    EXPECT_EQ(pairs.pairs, (std::vector<std::pair<int, int>>{{0, 2}, {3, 1}}));
+
+    writeFile(file.path(), "p aux sp ss 2\ns 5\ns 1\n");
+    DimacsQueries sources;
+    ASSERT_TRUE(loadDimacsQueries(file.path(), sources));
+    EXPECT_TRUE(sources.singleSource);
+    EXPECT_EQ(sources.sources, (std::vector<int>{4, 0}));
+
+    writeFile(file.path(), "p aux sp p2p 1\ns 5\n");
+    DimacsQueries mixed;
+    EXPECT_FALSE(loadDimacsQueries(file.path(), mixed));
+}
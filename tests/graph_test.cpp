@@ -0,0 +1,129 @@
+#include "pathfinder/graph.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <atomic>
+
+TEST(Graph, BuildKeepsEditorOrderAndEdgeAttributes) {
+    std::vector<Node> destinations = {{Vec2{0, 0}, true}, {Vec2{30, 40}, true}};
+    std::vector<Node> roads = {{Vec2{0, 40}, false}};
+    std::vector<Edge> edges(3);
+    edges[0] = Edge{Vec2{0, 0}, Vec2{30, 40}};      // length 50 at street speed
+    edges[1] = Edge{Vec2{0, 0}, Vec2{0, 40}};
+    edges[1].roadClass = RoadClass::Motorway;       // 40 / 2.5
+    edges[1].oneWay = true;
+    edges[2] = Edge{Vec2{0, 40}, Vec2{30, 40}};
+    edges[2].weight = 7;
+    edges.push_back(Edge{Vec2{0, 0}, Vec2{99, 99}}); // dangling, dropped
+
+    Graph graph = buildGraph(destinations, roads, edges);
+    ASSERT_EQ(graph.nodeCount(), 3);
+    EXPECT_EQ(graph.destinationCount, 2);
+    EXPECT_EQ(graph.target.size(), 5u);
+    EXPECT_FLOAT_EQ(pathCost(graph, {0, 1}), 50);
+    EXPECT_FLOAT_EQ(pathCost(graph, {0, 2}), 16);
+    EXPECT_EQ(pathCost(graph, {2, 0}), kInfinity);
+    EXPECT_FLOAT_EQ(pathCost(graph, {1, 2}), 7);
+
+    SearchContext context;
+    PathResult result = shortestPath(graph, 0, 1, context);
+    EXPECT_FLOAT_EQ(result.distance, 23);
+    EXPECT_EQ(result.path, (std::vector<int>{0, 2, 1}));
+    EXPECT_FLOAT_EQ(shortestPath(graph, 1, 0, context).distance, 50);
+}
+
+TEST(Graph, ShortestPathMatchesReference) {
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        forEachPair(map, [&](int source, int target, float expected) {
+            EXPECT_TRUE(isShortestPath(map.graph, shortestPath(map.graph, source, target, context), source, target,
+                                       expected));
+        });
+    }
+}
+
+TEST(Graph, ShortestPathTreeMatchesReference) {
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        for (size_t i = 0; i < map.sources.size(); ++i) {
+            shortestPathTree(map.graph, map.sources[i], context);
+            for (int v = 0; v < map.graph.nodeCount(); ++v) {
+                EXPECT_TRUE(sameDistance(map.reference[i][v], context.dist[v])) << "node " << v;
+            }
+        }
+    }
+}
+
+TEST(Graph, ShortestPathsToTargetsSettlesEveryTarget) {
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        std::vector<char> isTarget(map.graph.nodeCount(), 0);
+        for (size_t i = 0; i < map.sources.size(); ++i) {
+            int count = 0;
+            for (int target : map.targets[i]) {
+                if (!isTarget[target]) ++count;
+                isTarget[target] = 1;
+            }
+            shortestPathsToTargets(map.graph, map.sources[i], isTarget, count, context);
+            for (int target : map.targets[i]) {
+                EXPECT_TRUE(sameDistance(map.reference[i][target], context.dist[target]));
+                isTarget[target] = 0;
+            }
+        }
+    }
+}
+
+TEST(Graph, ReverseGraphTurnsArcsAround) {
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        Graph reversed = reverseGraph(map.graph);
+        EXPECT_EQ(reversed.target.size(), map.graph.target.size());
+        forEachPair(map, [&](int source, int target, float expected) {
+            EXPECT_TRUE(sameDistance(expected, shortestPath(reversed, target, source, context).distance));
+        });
+    }
+}
+
+TEST(Graph, FindShortestPathMatchesReference) {
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        const std::vector<Vec2>& positions = map.graph.positions;
+        forEachPair(map, [&](int source, int target, float expected) {
+            float distance = kInfinity;
+            std::vector<Vec2> path = findShortestPath(positions[source], positions[target], map.map.destinationNodes,
+                                                      map.map.roadNodes, map.map.edges, nullptr, &distance);
+            EXPECT_TRUE(sameDistance(expected, distance)) << source << " -> " << target;
+            if (expected != kInfinity && source != target) {
+                ASSERT_FALSE(path.empty());
+                EXPECT_EQ(path.front(), positions[source]);
+                EXPECT_EQ(path.back(), positions[target]);
+            }
+        });
+    }
+}
+
+TEST(Graph, CancelledSearchStopsEarly) {
+    Graph graph = buildGraph(makeGridMap(100, 100));
+    const int corner = graph.nodeCount() - 1;
+    SearchContext context;
+    std::atomic<bool> cancel{false};
+    int progressCalls = 0;
+    SearchControl control;
+    control.cancel = &cancel;
+    control.progress = [&](const SearchContext&) { ++progressCalls; };
+
+    PathResult finished = shortestPath(graph, 0, corner, context, control);
+    EXPECT_FALSE(finished.cancelled);
+    EXPECT_FLOAT_EQ(finished.distance, 99 * 10.0f * 2);
+    EXPECT_GT(progressCalls, 0);
+
+    cancel = true;
+    PathResult cancelled = shortestPath(graph, 0, corner, context, control);
+    EXPECT_TRUE(cancelled.cancelled);
+    EXPECT_TRUE(cancelled.path.empty());
+    EXPECT_LE(cancelled.stats.settled, kProgressInterval);
+}
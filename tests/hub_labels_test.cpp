@@ -0,0 +1,90 @@
+#include "pathfinder/hub_labels.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+
+TEST(HubLabels, MatchesReference) {
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        HubLabels labels = buildHubLabels(map.graph);
+        ASSERT_EQ(labels.nodeCount(), map.graph.nodeCount());
+        ASSERT_TRUE(labels.hasParents());
+        EXPECT_EQ(labels.fingerprint, graphFingerprint(map.graph));
+        forEachPair(map, [&](int source, int target, float expected) {
+            EXPECT_TRUE(sameDistance(expected, hubDistance(labels, source, target)));
+            EXPECT_TRUE(isShortestPath(map.graph, hubShortestPath(labels, source, target), source, target,
+                                       expected));
+        });
+    }
+}
+
+TEST(HubLabels, AnyOrderGivesCorrectLabels) {
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        // Input order is a poor one: bigger labels, same distances
+        std::vector<int> order(map.graph.nodeCount());
+        std::iota(order.begin(), order.end(), 0);
+        HubLabels labels = buildHubLabels(map.graph, order, false);
+        EXPECT_FALSE(labels.hasParents());
+        forEachPair(map, [&](int source, int target, float expected) {
+            PathResult result = hubShortestPath(labels, source, target);
+            EXPECT_TRUE(sameDistance(expected, result.distance));
+            EXPECT_TRUE(result.path.empty());
+        });
+    }
+}
+
+TEST(HubLabels, FileRoundTrip) {
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        for (bool withParents : {true, false}) {
+            HubLabels labels = buildHubLabels(map.graph, withParents);
+            TempFile file("labels.pfhl");
+            ASSERT_TRUE(saveHubLabels(labels, file.path()));
+            HubLabels loaded;
+            ASSERT_TRUE(loadHubLabels(loaded, file.path()));
+            EXPECT_EQ(loaded.order, labels.order);
+            EXPECT_EQ(loaded.fingerprint, labels.fingerprint);
+            EXPECT_EQ(loaded.outStart, labels.outStart);
+            EXPECT_EQ(loaded.inStart, labels.inStart);
+            EXPECT_EQ(loaded.outParent, labels.outParent);
+            EXPECT_EQ(loaded.inParent, labels.inParent);
+            ASSERT_EQ(loaded.outLabels.size(), labels.outLabels.size());
+            for (size_t i = 0; i < labels.outLabels.size(); ++i) {
+                EXPECT_EQ(loaded.outLabels[i].hub, labels.outLabels[i].hub);
+                EXPECT_EQ(loaded.outLabels[i].distance, labels.outLabels[i].distance);
+            }
+            forEachPair(map, [&](int source, int target, float expected) {
+                EXPECT_TRUE(isShortestPath(map.graph, hubShortestPath(loaded, source, target), source, target,
+                                           expected, withParents));
+            });
+        }
+    }
+}
+
+TEST(HubLabels, RejectsOtherFiles) {
+    TempFile file("labels.pfhl");
+    HubLabels labels;
+    EXPECT_FALSE(loadHubLabels(labels, file.path())); // missing
+    std::ofstream(file.path(), std::ios::binary) << "PFGR";
+    EXPECT_FALSE(loadHubLabels(labels, file.path()));
+
+    // Cut short
+    const TestMap& map = testMaps().front();
+    ASSERT_TRUE(saveHubLabels(buildHubLabels(map.graph), file.path()));
+    std::ifstream in(file.path(), std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream(file.path(), std::ios::binary) << bytes.substr(0, bytes.size() / 2);
+    EXPECT_FALSE(loadHubLabels(labels, file.path()));
+}
+
+TEST(HubLabels, FingerprintTracksWeights) {
+    const TestMap& map = testMaps().front();
+    Graph edited = map.graph;
+    edited.weight[0] += 1;
+    EXPECT_NE(graphFingerprint(edited), graphFingerprint(map.graph));
+}
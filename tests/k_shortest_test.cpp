@@ -0,0 +1,172 @@
+#include "pathfinder/k_shortest.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <thread>
+
+namespace {
+
+struct ReferencePath {
+    float cost = kInfinity;
+    std::vector<int> path;
+};
+
+// Dijkstra from source to target with a linear scan for the next node,
+// avoiding blocked nodes and the blocked (from, to) steps
+ReferencePath plainSearch(const Graph& graph, int source, int target, const std::vector<char>& blockedNode,
+                          const std::set<std::pair<int, int>>& blockedStep) {
+    const int n = graph.nodeCount();
+    std::vector<float> dist(n, kInfinity);
+    std::vector<int> prev(n, -1);
+    std::vector<char> done(n, 0);
+    dist[source] = 0;
+    while (true) {
+        int u = -1;
+        for (int v = 0; v < n; ++v) {
+            if (!done[v] && dist[v] != kInfinity && (u < 0 || dist[v] < dist[u])) u = v;
+        }
+        if (u < 0 || u == target) break;
+        done[u] = 1;
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+            const int v = graph.target[e];
+            if (blockedNode[v] || blockedStep.count({u, v})) continue;
+            if (dist[u] + graph.weight[e] < dist[v]) {
+                dist[v] = dist[u] + graph.weight[e];
+                prev[v] = u;
+            }
+        }
+    }
+    ReferencePath found;
+    if (dist[target] == kInfinity) return found;
+    found.cost = dist[target];
+    for (int v = target; v != -1; v = prev[v]) found.path.push_back(v);
+    std::reverse(found.path.begin(), found.path.end());
+    return found;
+}
+
+// Yen's algorithm as published: every spur of the last accepted path is
+// searched from scratch. Returns the costs of up to k paths.
+std::vector<float> referenceCosts(const Graph& graph, int source, int target, int k) {
+    std::vector<char> blockedNode(graph.nodeCount(), 0);
+    std::vector<ReferencePath> accepted;
+    std::set<std::pair<float, std::vector<int>>> candidates;
+    ReferencePath first = plainSearch(graph, source, target, blockedNode, {});
+    if (first.cost == kInfinity) return {};
+    accepted.push_back(first);
+    while (static_cast<int>(accepted.size()) < k) {
+        const std::vector<int>& last = accepted.back().path;
+        for (size_t i = 0; i + 1 < last.size(); ++i) {
+            const std::vector<int> root(last.begin(), last.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            std::set<std::pair<int, int>> blockedStep;
+            for (const ReferencePath& p : accepted) {
+                if (p.path.size() > i + 1 && std::equal(root.begin(), root.end(), p.path.begin()))
+                    blockedStep.emplace(p.path[i], p.path[i + 1]);
+            }
+            for (size_t r = 0; r < i; ++r) blockedNode[root[r]] = 1;
+            ReferencePath spur = plainSearch(graph, last[i], target, blockedNode, blockedStep);
+            for (size_t r = 0; r < i; ++r) blockedNode[root[r]] = 0;
+            if (spur.cost == kInfinity) continue;
+            std::vector<int> path = root;
+            path.insert(path.end(), spur.path.begin() + 1, spur.path.end());
+            candidates.emplace(pathCost(graph, root) + spur.cost, path);
+        }
+        if (candidates.empty()) break;
+        auto best = candidates.begin();
+        accepted.push_back(ReferencePath{best->first, best->second});
+        candidates.erase(best);
+    }
+    std::vector<float> costs;
+    for (const ReferencePath& p : accepted) costs.push_back(p.cost);
+    return costs;
+}
+
+} // namespace
+
+TEST(KShortest, MatchesYen) {
+    constexpr int k = 8;
+    KShortestSearch search;
+    for (unsigned threads : {1u, 4u}) {
+        ThreadPool pool(threads);
+        for (const TestMap& map : testMaps()) {
+            SCOPED_TRACE(map.name);
+            Graph reversed = reverseGraph(map.graph);
+            for (size_t i = 0; i < map.sources.size(); ++i) {
+                const int source = map.sources[i];
+                // Itself, the isolated node and a few others
+                for (size_t t = 0; t < 6; ++t) {
+                    const int target = map.targets[i][t];
+                    std::vector<float> expected = referenceCosts(map.graph, source, target, k);
+                    std::vector<PathResult> paths =
+                        kShortestPaths(map.graph, reversed, source, target, k, search, pool);
+                    // Equal-cost paths may come in any order, but the costs are the same
+                    ASSERT_EQ(paths.size(), expected.size()) << source << " -> " << target;
+                    std::set<std::vector<int>> distinct;
+                    for (size_t j = 0; j < paths.size(); ++j) {
+                        const PathResult& found = paths[j];
+                        EXPECT_TRUE(sameDistance(expected[j], found.distance)) << "path " << j;
+                        EXPECT_TRUE(sameDistance(found.distance, pathCost(map.graph, found.path)));
+                        ASSERT_FALSE(found.path.empty());
+                        EXPECT_EQ(found.path.front(), source);
+                        EXPECT_EQ(found.path.back(), target);
+                        std::vector<int> nodes = found.path;
+                        std::sort(nodes.begin(), nodes.end());
+                        EXPECT_EQ(std::adjacent_find(nodes.begin(), nodes.end()), nodes.end());
+                        distinct.insert(found.path);
+                    }
+                    EXPECT_EQ(distinct.size(), paths.size());
+                }
+            }
+        }
+    }
+}
+
+TEST(KShortest, FirstPathIsShortest) {
+    ThreadPool pool(2);
+    KShortestSearch search;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        Graph reversed = reverseGraph(map.graph);
+        forEachPair(map, [&](int source, int target, float expected) {
+            std::vector<PathResult> paths = kShortestPaths(map.graph, reversed, source, target, 1, search, pool);
+            ASSERT_EQ(paths.size(), expected == kInfinity ? 0u : 1u);
+            if (!paths.empty()) {
+                EXPECT_TRUE(isShortestPath(map.graph, paths[0], source, target, expected));
+            }
+        });
+    }
+}
+
+TEST(KShortest, CancelStopsBetweenSpurBatches) {
+    ThreadPool pool(2);
+    KShortestSearch search;
+    Graph graph = buildGraph(makeGridMap(40, 40));
+    Graph reversed = reverseGraph(graph);
+    const int corner = graph.nodeCount() - 1;
+    std::atomic<bool> cancel{false};
+    SearchControl control;
+    control.cancel = &cancel;
+
+    std::vector<PathResult> finished = kShortestPaths(graph, reversed, 0, corner, 5, search, pool, &control);
+    ASSERT_EQ(finished.size(), 5u);
+    for (const PathResult& path : finished) EXPECT_FALSE(path.cancelled);
+
+    cancel = true;
+    std::vector<PathResult> cancelled = kShortestPaths(graph, reversed, 0, corner, 5, search, pool, &control);
+    ASSERT_EQ(cancelled.size(), 1u);
+    EXPECT_TRUE(cancelled[0].cancelled);
+    EXPECT_TRUE(cancelled[0].path.empty());
+
+    // Far more paths than could be found before the flag is raised
+    cancel = false;
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cancel = true;
+    });
+    cancelled = kShortestPaths(graph, reversed, 0, corner, 1 << 30, search, pool, &control);
+    canceller.join();
+    ASSERT_EQ(cancelled.size(), 1u);
+    EXPECT_TRUE(cancelled[0].cancelled);
+}
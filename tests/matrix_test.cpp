@@ -0,0 +1,50 @@
+#include "pathfinder/matrix.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+TEST(Matrix, MatchesReference) {
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        // Repeated and unreachable targets included
+        for (unsigned threads : {1u, 3u}) {
+            DistanceMatrix matrix = computeDistanceMatrix(map.graph, map.sources, map.targets[0], threads);
+            ASSERT_EQ(matrix.values.size(), map.sources.size() * map.targets[0].size());
+            for (size_t row = 0; row < map.sources.size(); ++row) {
+                for (size_t column = 0; column < map.targets[0].size(); ++column) {
+                    EXPECT_TRUE(sameDistance(map.reference[row][map.targets[0][column]], matrix.at(row, column)));
+                }
+            }
+        }
+    }
+}
+
+TEST(Matrix, WritesTheBinaryLayout) {
+    DistanceMatrix matrix;
+    matrix.sources = {4, 7};
+    matrix.targets = {1, 2, 3};
+    matrix.values = {0, 1.5f, kInfinity, 2, 0, 3.25f};
+    TempFile file("matrix.bin");
+    ASSERT_TRUE(writeMatrixBinary(matrix, file.path()));
+
+    std::ifstream in(file.path(), std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(bytes.size(), 16 + 4 * (2 + 3 + 6u));
+    EXPECT_EQ(std::string(bytes.begin(), bytes.begin() + 4), "PFDM");
+    auto u32 = [&](size_t at) {
+        uint32_t value;
+        std::memcpy(&value, &bytes[at], 4);
+        return value;
+    };
+    EXPECT_EQ(u32(4), 1u);
+    EXPECT_EQ(u32(8), 2u);
+    EXPECT_EQ(u32(12), 3u);
+    EXPECT_EQ(u32(16), 4u);
+    EXPECT_EQ(u32(24), 1u);
+    float values[6];
+    std::memcpy(values, &bytes[36], sizeof(values));
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(values[i], matrix.values[i]);
+}
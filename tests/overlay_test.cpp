@@ -0,0 +1,55 @@
+#include "pathfinder/overlay.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// The test maps fit in one default cell; these give three real levels
+const std::vector<int> kSmallCells = {8, 32, 128};
+
+} // namespace
+
+TEST(Overlay, MatchesReference) {
+    ThreadPool pool(3);
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        for (const std::vector<int>& cellSizes : {kSmallCells, kDefaultCellSizes}) {
+            OverlayGraph overlay = buildOverlay(map.graph, pool, cellSizes);
+            ASSERT_TRUE(overlayFits(overlay, map.graph));
+            forEachPair(map, [&](int source, int target, float expected) {
+                PathResult result = overlayShortestPath(map.graph, overlay, source, target, context);
+                EXPECT_TRUE(isShortestPath(map.graph, result, source, target, expected));
+            });
+        }
+    }
+}
+
+TEST(Overlay, UpdatesAfterWeightChanges) {
+    ThreadPool pool(2);
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        OverlayGraph overlay = buildOverlay(map.graph, pool, kSmallCells);
+        EXPECT_EQ(updateOverlay(overlay, map.graph, pool), 0);
+
+        // One arc: only the cells containing it, one per level at most
+        Graph edited = map.graph;
+        edited.weight[0] *= 3;
+        int recomputed = updateOverlay(overlay, edited, pool);
+        EXPECT_GE(recomputed, 1);
+        EXPECT_LE(recomputed, static_cast<int>(overlay.levels.size()));
+
+        for (size_t e = 0; e < edited.weight.size(); ++e) edited.weight[e] *= e % 3 == 0 ? 0.25f : 2.0f;
+        ASSERT_TRUE(overlayFits(overlay, edited));
+        updateOverlay(overlay, edited, pool);
+        for (size_t i = 0; i < map.sources.size(); ++i) {
+            std::vector<float> reference = referenceDistances(edited, map.sources[i]);
+            for (int target : map.targets[i]) {
+                PathResult result = overlayShortestPath(edited, overlay, map.sources[i], target, context);
+                EXPECT_TRUE(isShortestPath(edited, result, map.sources[i], target, reference[target]));
+            }
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include "pathfinder/query_worker.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace {
+
+void waitFor(const QueryTicket& ticket) {
+    while (!ticket.ready()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+} // namespace
+
+TEST(QueryWorker, AnswersMatchReference) {
+    const TestMap& map = testMaps().front();
+    GraphStore store(map.graph);
+    QueryWorker worker(store);
+    for (size_t i = 0; i < map.sources.size(); ++i) {
+        std::vector<float> reference = referenceDistances(map.graph, map.sources[i]);
+        for (int target : map.targets[i]) {
+            for (QueryRoutes routes : {QueryRoutes::Shortest, QueryRoutes::Alternatives, QueryRoutes::KShortest}) {
+                std::shared_ptr<QueryTicket> ticket = worker.submit(map.sources[i], target, false, routes);
+                waitFor(*ticket);
+                EXPECT_FALSE(ticket->result().cancelled);
+                EXPECT_TRUE(isShortestPath(map.graph, ticket->result(), map.sources[i], target, reference[target]));
+                EXPECT_EQ(ticket->pathPoints().size(), ticket->result().path.size());
+            }
+        }
+    }
+}
+
+TEST(QueryWorker, FollowsNewGraphVersions) {
+    const TestMap& map = testMaps().front();
+    GraphStore store(map.graph);
+    QueryWorker worker(store);
+    const int source = map.sources[0];
+    Graph edited = map.graph;
+    for (float& weight : edited.weight) weight *= 3;
+    std::vector<float> reference = referenceDistances(edited, source);
+    for (int target : map.targets[0]) {
+        std::shared_ptr<QueryTicket> before = worker.submit(source, target);
+        waitFor(*before);
+        EXPECT_EQ(before->graphNumber(), store.currentNumber());
+        store.publish(edited);
+        // The landmarks must be recomputed, or the stale bounds would overestimate
+        std::shared_ptr<QueryTicket> after = worker.submit(source, target);
+        waitFor(*after);
+        EXPECT_EQ(after->graphNumber(), store.currentNumber());
+        EXPECT_TRUE(isShortestPath(edited, after->result(), source, target, reference[target]));
+        store.publish(map.graph);
+    }
+}
+
+TEST(QueryWorker, CancelStopsEveryKind) {
+    GraphStore store(buildGraph(makeGridMap(200, 200)));
+    QueryWorker worker(store);
+    const int corner = store.read().graph().nodeCount() - 1;
+    for (QueryRoutes routes : {QueryRoutes::Shortest, QueryRoutes::Alternatives, QueryRoutes::KShortest}) {
+        // Cancelled before the worker can finish the landmarks for a fresh version
+        store.publish(buildGraph(makeGridMap(200, 200)));
+        std::shared_ptr<QueryTicket> ticket = worker.submit(0, corner, false, routes);
+        ticket->cancel();
+        waitFor(*ticket);
+        EXPECT_TRUE(ticket->cancelled());
+        EXPECT_TRUE(ticket->result().path.empty());
+    }
+    // A later query on the same version still gets a full answer
+    std::shared_ptr<QueryTicket> ticket = worker.submit(0, corner);
+    waitFor(*ticket);
+    EXPECT_FALSE(ticket->result().cancelled);
+    EXPECT_FLOAT_EQ(ticket->result().distance, 199 * 10.0f * 2);
+}
+
+TEST(QueryWorker, NewSubmissionCancelsTheOld) {
+    GraphStore store(buildGraph(makeGridMap(200, 200)));
+    QueryWorker worker(store);
+    const int corner = store.read().graph().nodeCount() - 1;
+    std::shared_ptr<QueryTicket> first = worker.submit(0, corner, false, QueryRoutes::KShortest);
+    std::shared_ptr<QueryTicket> second = worker.submit(0, 1);
+    waitFor(*second);
+    waitFor(*first);
+    EXPECT_TRUE(first->cancelled());
+    EXPECT_FALSE(second->result().cancelled);
+    EXPECT_TRUE(sameDistance(second->result().distance, referenceDistances(store.read().graph(), 0)[1]));
+}
+
+TEST(QueryWorker, OutOfRangeIdsFindNoPath) {
+    const TestMap& map = testMaps().front();
+    GraphStore store(map.graph);
+    QueryWorker worker(store);
+    std::shared_ptr<QueryTicket> ticket = worker.submit(-1, map.graph.nodeCount());
+    waitFor(*ticket);
+    EXPECT_TRUE(ticket->result().path.empty());
+    EXPECT_EQ(ticket->result().distance, kInfinity);
+}
@@ -0,0 +1,43 @@
+#include "pathfinder/reorder.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+TEST(Reorder, RenumberedGraphKeepsDistances) {
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        for (NodeOrder order : {NodeOrder::Input, NodeOrder::Hilbert, NodeOrder::Bfs, NodeOrder::Rcm}) {
+            SCOPED_TRACE(nodeOrderName(order));
+            ReorderedGraph reordered = reorderGraph(map.graph, order);
+            const int n = map.graph.nodeCount();
+            ASSERT_EQ(reordered.graph.nodeCount(), n);
+            EXPECT_EQ(reordered.graph.target.size(), map.graph.target.size());
+            EXPECT_EQ(reordered.graph.destinationCount, map.graph.destinationCount);
+            std::vector<int> sorted = reordered.toInternal;
+            std::sort(sorted.begin(), sorted.end());
+            for (int v = 0; v < n; ++v) {
+                ASSERT_EQ(sorted[v], v);
+                EXPECT_EQ(reordered.toEditor[reordered.toInternal[v]], v);
+                EXPECT_EQ(reordered.graph.positions[reordered.toInternal[v]], map.graph.positions[v]);
+            }
+            forEachPair(map, [&](int source, int target, float expected) {
+                PathResult result = shortestPath(reordered.graph, reordered.toInternal[source],
+                                                 reordered.toInternal[target], context);
+                EXPECT_TRUE(isShortestPath(reordered.graph, result, reordered.toInternal[source],
+                                           reordered.toInternal[target], expected));
+            });
+        }
+    }
+}
+
+TEST(Reorder, ParsesOrderNames) {
+    for (NodeOrder order : {NodeOrder::Input, NodeOrder::Hilbert, NodeOrder::Bfs, NodeOrder::Rcm}) {
+        NodeOrder parsed = NodeOrder::Input;
+        EXPECT_TRUE(parseNodeOrder(nodeOrderName(order), parsed));
+        EXPECT_EQ(parsed, order);
+    }
+    NodeOrder parsed;
+    EXPECT_FALSE(parseNodeOrder("random", parsed));
+}
@@ -0,0 +1,83 @@
+#include "pathfinder/storage.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <fstream>
+
+namespace {
+
+void expectSameEdges(const std::vector<Edge>& expected, const std::vector<Edge>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].from, actual[i].from);
+        EXPECT_EQ(expected[i].to, actual[i].to);
+        EXPECT_EQ(expected[i].weight, actual[i].weight);
+        EXPECT_EQ(expected[i].speed, actual[i].speed);
+        EXPECT_EQ(expected[i].roadClass, actual[i].roadClass);
+        EXPECT_EQ(expected[i].oneWay, actual[i].oneWay);
+    }
+}
+
+void expectSameNodes(const std::vector<Node>& expected, const std::vector<Node>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].position, actual[i].position);
+        EXPECT_EQ(expected[i].isDestination, actual[i].isDestination);
+    }
+}
+
+} // namespace
+
+TEST(Storage, RoundTripKeepsNodesEdgesAndTurns) {
+    RandomMap map = makeRandomMap(120, 0.3f, true, 7);
+    map.edges[0].speed = 2.5f;
+    map.edges[0].weight = -1.0f;
+    map.edges[1].roadClass = RoadClass::Motorway;
+    map.edges[2].roadClass = RoadClass::Track;
+    std::vector<Turn> turns = {
+        Turn{map.edges[0].from, map.edges[0].to, map.edges[1].to},
+        Turn{map.edges[1].from, map.edges[1].to, map.edges[2].to, 3.5f},
+    };
+
+    TempFile file("storage.json");
+    saveToFile(map.destinationNodes, map.roadNodes, map.edges, turns, file.path());
+    RandomMap loaded;
+    std::vector<Turn> loadedTurns;
+    ASSERT_TRUE(loadFromFile(loaded.destinationNodes, loaded.roadNodes, loaded.edges, loadedTurns, file.path()));
+    expectSameNodes(map.destinationNodes, loaded.destinationNodes);
+    expectSameNodes(map.roadNodes, loaded.roadNodes);
+    expectSameEdges(map.edges, loaded.edges);
+    ASSERT_EQ(loadedTurns.size(), turns.size());
+    for (size_t i = 0; i < turns.size(); ++i) {
+        EXPECT_EQ(loadedTurns[i].from, turns[i].from);
+        EXPECT_EQ(loadedTurns[i].via, turns[i].via);
+        EXPECT_EQ(loadedTurns[i].to, turns[i].to);
+        EXPECT_EQ(loadedTurns[i].cost, turns[i].cost);
+    }
+    EXPECT_EQ(topologyFingerprint(buildGraph(loaded)), topologyFingerprint(buildGraph(map)));
+}
+
+TEST(Storage, PlainEdgesKeepTheOldLayout) {
+    TempFile file("plain.json");
+    {
+        std::ofstream out(file.path());
+        out << R"({"destinations": [[0, 0], [3, 4]], "roads": [], "edges": [[[0, 0], [3, 4]]]})";
+    }
+    RandomMap loaded;
+    ASSERT_TRUE(loadFromFile(loaded.destinationNodes, loaded.roadNodes, loaded.edges, file.path()));
+    ASSERT_EQ(loaded.edges.size(), 1u);
+    EXPECT_FLOAT_EQ(edgeWeight(loaded.edges[0]), 5);
+    EXPECT_FALSE(loaded.edges[0].oneWay);
+}
+
+TEST(Storage, RejectsMissingAndMalformedFiles) {
+    RandomMap loaded;
+    EXPECT_FALSE(loadFromFile(loaded.destinationNodes, loaded.roadNodes, loaded.edges,
+                              "/nonexistent/pathfinder/nodes.json"));
+    TempFile file("bad.json");
+    {
+        std::ofstream out(file.path());
+        out << R"({"edges": [[[0, 0], [1, 1], {"class": "runway"}]]})";
+    }
+    EXPECT_FALSE(loadFromFile(loaded.destinationNodes, loaded.roadNodes, loaded.edges, file.path()));
+}
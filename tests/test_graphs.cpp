@@ -0,0 +1,190 @@
+#include "test_graphs.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <random>
+
+namespace {
+
+constexpr float kSpacing = 10.0f;
+
+} // namespace
+
+RandomMap makeRandomMap(int nodeCount, float oneWayShare, bool integerWeights, unsigned seed) {
+    std::mt19937 rng(seed);
+    const int side = static_cast<int>(std::ceil(std::sqrt(2.0 * nodeCount)));
+    std::vector<int> cells(side * side);
+    std::iota(cells.begin(), cells.end(), 0);
+    std::shuffle(cells.begin(), cells.end(), rng);
+    std::uniform_real_distribution<float> jitter(0.0f, 0.8f * kSpacing);
+    std::vector<Vec2> positions(nodeCount);
+    for (int i = 0; i < nodeCount; ++i) {
+        positions[i] = Vec2{(cells[i] % side) * kSpacing + jitter(rng), (cells[i] / side) * kSpacing + jitter(rng)};
+    }
+
+    RandomMap map;
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> weight(1, 20);
+    auto join = [&](int a, int b) {
+        Edge edge{positions[a], positions[b]};
+        if (integerWeights) edge.weight = static_cast<float>(weight(rng));
+        edge.oneWay = unit(rng) < oneWayShare;
+        map.edges.push_back(edge);
+    };
+    // The last node stays isolated
+    const int joined = nodeCount - 1;
+    std::vector<int> nearest(joined);
+    for (int a = 0; a < joined; ++a) {
+        std::iota(nearest.begin(), nearest.end(), 0);
+        std::partial_sort(nearest.begin(), nearest.begin() + 4, nearest.end(), [&](int u, int v) {
+            return euclidean(positions[a], positions[u]) < euclidean(positions[a], positions[v]);
+        });
+        // nearest[0] is a itself
+        std::uniform_int_distribution<int> pick(1, 3);
+        int first = pick(rng), second = pick(rng);
+        join(a, nearest[first]);
+        if (second != first) join(a, nearest[second]);
+    }
+    std::uniform_int_distribution<int> anyNode(0, joined - 1);
+    for (int i = 0; i < nodeCount / 20; ++i) {
+        int a = anyNode(rng), b = anyNode(rng);
+        if (a != b) join(a, b);
+    }
+
+    // A quarter destinations, ending with the isolated node
+    for (int i = 0; i < joined; ++i) {
+        if (i % 4 == 0) map.destinationNodes.push_back(Node{positions[i], true});
+        else map.roadNodes.push_back(Node{positions[i], false});
+    }
+    map.destinationNodes.push_back(Node{positions[joined], true});
+    return map;
+}
+
+RandomMap makeGridMap(int width, int height) {
+    RandomMap map;
+    auto at = [](int x, int y) { return Vec2{x * kSpacing, y * kSpacing}; };
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            map.roadNodes.push_back(Node{at(x, y), false});
+            if (x + 1 < width) map.edges.push_back(Edge{at(x, y), at(x + 1, y)});
+            if (y + 1 < height) map.edges.push_back(Edge{at(x, y), at(x, y + 1)});
+        }
+    }
+    return map;
+}
+
+Graph buildGraph(const RandomMap& map) {
+    return buildGraph(map.destinationNodes, map.roadNodes, map.edges);
+}
+
+const std::vector<TestMap>& testMaps() {
+    static const std::vector<TestMap> maps = [] {
+        struct Kind {
+            const char* name;
+            float oneWayShare;
+            bool integerWeights;
+        };
+        const Kind kinds[] = {
+            {"two-way, lengths", 0.0f, false},
+            {"two-way, integer weights", 0.0f, true},
+            {"partly one-way, lengths", 0.3f, false},
+            {"partly one-way, integer weights", 0.3f, true},
+            {"all one-way, lengths", 1.0f, false},
+        };
+        std::vector<TestMap> result;
+        unsigned seed = 1;
+        for (const Kind& kind : kinds) {
+            TestMap test;
+            test.name = kind.name;
+            test.map = makeRandomMap(240, kind.oneWayShare, kind.integerWeights, seed);
+            test.graph = buildGraph(test.map);
+            std::mt19937 rng(seed++);
+            const int n = test.graph.nodeCount();
+            const int isolated = test.graph.destinationCount - 1;
+            std::uniform_int_distribution<int> anyNode(0, n - 1);
+            for (int i = 0; i < 8; ++i) {
+                int source = anyNode(rng);
+                test.sources.push_back(source);
+                test.reference.push_back(referenceDistances(test.graph, source));
+                std::vector<int> targets = {source, isolated};
+                for (int j = 0; j < 24; ++j) targets.push_back(anyNode(rng));
+                test.targets.push_back(targets);
+            }
+            result.push_back(std::move(test));
+        }
+        return result;
+    }();
+    return maps;
+}
+
+std::vector<float> referenceDistances(const Graph& graph, int source) {
+    std::vector<float> dist(graph.nodeCount(), kInfinity);
+    dist[source] = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int u = 0; u < graph.nodeCount(); ++u) {
+            if (dist[u] == kInfinity) continue;
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                if (dist[u] + graph.weight[e] < dist[graph.target[e]]) {
+                    dist[graph.target[e]] = dist[u] + graph.weight[e];
+                    changed = true;
+                }
+            }
+        }
+    }
+    return dist;
+}
+
+float pathCost(const Graph& graph, const std::vector<int>& path) {
+    float cost = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        float step = kInfinity;
+        for (int e = graph.firstEdge[path[i - 1]]; e < graph.firstEdge[path[i - 1] + 1]; ++e) {
+            if (graph.target[e] == path[i]) step = std::min(step, graph.weight[e]);
+        }
+        if (step == kInfinity) return kInfinity;
+        cost += step;
+    }
+    return cost;
+}
+
+::testing::AssertionResult sameDistance(float expected, float actual) {
+    if (expected == actual) return ::testing::AssertionSuccess();
+    if (expected != kInfinity && actual != kInfinity &&
+        std::abs(expected - actual) <= 1e-4f * std::max(1.0f, std::abs(expected))) {
+        return ::testing::AssertionSuccess();
+    }
+    return ::testing::AssertionFailure() << "distance " << actual << ", expected " << expected;
+}
+
+::testing::AssertionResult isShortestPath(const Graph& graph, const PathResult& result, int source, int target,
+                                          float expected, bool checkPath) {
+    auto failure = [&]() {
+        return ::testing::AssertionFailure() << source << " -> " << target << ": ";
+    };
+    auto distance = sameDistance(expected, result.distance);
+    if (!distance) return failure() << distance.message();
+    if (expected == kInfinity) {
+        if (!result.path.empty()) return failure() << "path given for an unreachable target";
+        return ::testing::AssertionSuccess();
+    }
+    if (!checkPath) return ::testing::AssertionSuccess();
+    if (result.path.empty() || result.path.front() != source || result.path.back() != target) {
+        return failure() << "path does not run from source to target";
+    }
+    auto cost = sameDistance(expected, pathCost(graph, result.path));
+    if (!cost) return failure() << "path " << cost.message();
+    return ::testing::AssertionSuccess();
+}
+
+TempFile::TempFile(const std::string& name) {
+    path_ = (std::filesystem::temp_directory_path() /
+             ("pathfinder_test_" + std::to_string(std::random_device()()) + "_" + name)).string();
+}
+
+TempFile::~TempFile() {
+    std::remove(path_.c_str());
+}
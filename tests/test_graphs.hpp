@@ -0,0 +1,82 @@
+#pragma once
+
+#include "pathfinder/graph.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+// Small random maps in the editor model for cross-checking the engines
+// against a reference. Nodes sit on distinct lattice cells (edges name their
+// ends by position), about a quarter of them destinations, and the last
+// destination is always isolated so unreachable targets come up.
+struct RandomMap {
+    std::vector<Node> destinationNodes;
+    std::vector<Node> roadNodes;
+    std::vector<Edge> edges;
+};
+
+// Every node is joined to one or two of its three nearest nodes, plus a few
+// long edges.
+// oneWayShare of the edges are one-way. With integerWeights edges cost 1 to
+// 20 regardless of length, so equal-cost paths are common; otherwise they
+// cost their length.
+RandomMap makeRandomMap(int nodeCount, float oneWayShare, bool integerWeights, unsigned seed);
+
+// width x height lattice with 4-neighbour two-way edges, for searches long
+// enough to be cancelled
+RandomMap makeGridMap(int width, int height);
+
+Graph buildGraph(const RandomMap& map);
+
+// A random map with reference distances from a sample of sources
+struct TestMap {
+    std::string name;
+    RandomMap map;
+    Graph graph;
+    std::vector<int> sources;
+    std::vector<std::vector<float>> reference; // reference[i][v] = d(sources[i], v)
+    std::vector<std::vector<int>> targets;     // per source: itself, the isolated node and random nodes
+};
+
+// Two-way, partly one-way and all one-way maps, with length and integer
+// weights; built once per test run
+const std::vector<TestMap>& testMaps();
+
+// Bellman-Ford over graph's arcs, independent of every engine under test
+std::vector<float> referenceDistances(const Graph& graph, int source);
+
+// Cost of following path over the cheapest arc between consecutive nodes;
+// kInfinity if some step has no arc
+float pathCost(const Graph& graph, const std::vector<int>& path);
+
+// Distances summed in a different order can differ in the last bits
+::testing::AssertionResult sameDistance(float expected, float actual);
+
+// result has the expected distance and, when reachable and checkPath is set,
+// a path from source to target that costs as much. Engines may break ties
+// between equal paths differently, so the path itself is not compared.
+::testing::AssertionResult isShortestPath(const Graph& graph, const PathResult& result, int source, int target,
+                                          float expected, bool checkPath = true);
+
+// Calls check(source, target, expected) for every sampled pair of map
+template <typename Check>
+void forEachPair(const TestMap& map, Check check) {
+    for (size_t i = 0; i < map.sources.size(); ++i) {
+        for (int target : map.targets[i]) check(map.sources[i], target, map.reference[i][target]);
+    }
+}
+
+// Path of a file in the system temp directory, removed when it goes out of scope
+class TempFile {
+public:
+    explicit TempFile(const std::string& name);
+    ~TempFile();
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
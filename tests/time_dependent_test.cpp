@@ -0,0 +1,252 @@
+#include "pathfinder/time_dependent.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <fstream>
+
+namespace {
+
+constexpr float kHour = 3600.0f;
+
+// The test map with its arcs dealt out over the road classes
+Graph withRoadClasses(const Graph& graph) {
+    Graph classed = graph;
+    classed.arcClass.resize(classed.target.size());
+    for (size_t e = 0; e < classed.arcClass.size(); ++e)
+        classed.arcClass[e] = static_cast<uint8_t>(e % kRoadClassCount);
+    return classed;
+}
+
+// Earliest arrivals by relaxing every arc until nothing improves, exact for
+// FIFO profiles
+std::vector<float> referenceTravelTimes(const Graph& graph, const TravelTimeProfiles& profiles, int source,
+                                        float departure) {
+    std::vector<float> travel(graph.nodeCount(), kInfinity);
+    travel[source] = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int u = 0; u < graph.nodeCount(); ++u) {
+            if (travel[u] == kInfinity) continue;
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                float arrival =
+                    travel[u] + graph.weight[e] * profiles.factor(profiles.profileOf(graph, e), departure + travel[u]);
+                if (arrival < travel[graph.target[e]]) {
+                    travel[graph.target[e]] = arrival;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return travel;
+}
+
+// Travel time along path leaving at departure, over the quickest arc of each step
+float travelTime(const Graph& graph, const TravelTimeProfiles& profiles, const std::vector<int>& path,
+                 float departure) {
+    float time = 0;
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        float best = kInfinity;
+        for (int e = graph.firstEdge[path[i]]; e < graph.firstEdge[path[i] + 1]; ++e) {
+            if (graph.target[e] != path[i + 1]) continue;
+            best = std::min(best, graph.weight[e] * profiles.factor(profiles.profileOf(graph, e), departure + time));
+        }
+        if (best == kInfinity) return kInfinity;
+        time += best;
+    }
+    return time;
+}
+
+void writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream out(path);
+    out << contents;
+}
+
+} // namespace
+
+TEST(TimeDependent, ConstantProfilesGiveStaticDistances) {
+    TravelTimeProfiles flat;
+    flat.times = {0, 12 * kHour};
+    flat.factors.assign(kRoadClassCount * flat.times.size(), 1.0f);
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        Graph graph = withRoadClasses(map.graph);
+        forEachPair(map, [&](int source, int target, float expected) {
+            PathResult result = timeDependentShortestPath(graph, flat, source, target, 8 * kHour, context);
+            EXPECT_TRUE(isShortestPath(graph, result, source, target, expected));
+        });
+    }
+}
+
+namespace {
+
+// Earliest arrivals and their routes from Dijkstra and from A* on lower
+// bound landmarks, before, in and after the morning peak and across midnight
+void expectEarliestArrivals(const TestMap& map, const Graph& graph, const TravelTimeProfiles& profiles) {
+    ThreadPool pool(2);
+    SearchContext context;
+    ASSERT_TRUE(checkFifo(graph, profiles));
+    const LandmarkIndex landmarks =
+        buildLandmarkIndex(lowerBoundGraph(graph, profiles), 8, LandmarkStrategy::Avoid, pool);
+    for (float departure : {5 * kHour, 7.5f * kHour, 12 * kHour, 23.99f * kHour}) {
+        for (size_t i = 0; i < map.sources.size(); ++i) {
+            std::vector<float> reference = referenceTravelTimes(graph, profiles, map.sources[i], departure);
+            for (int target : map.targets[i]) {
+                for (const LandmarkIndex* index : {static_cast<const LandmarkIndex*>(nullptr), &landmarks}) {
+                    PathResult result = timeDependentShortestPath(graph, profiles, map.sources[i], target,
+                                                                  departure, context, index);
+                    ASSERT_TRUE(sameDistance(reference[target], result.distance))
+                        << "departing " << departure << (index ? " with landmarks" : "");
+                    if (reference[target] == kInfinity) continue;
+                    ASSERT_FALSE(result.path.empty());
+                    EXPECT_EQ(result.path.front(), map.sources[i]);
+                    EXPECT_EQ(result.path.back(), target);
+                    EXPECT_TRUE(sameDistance(reference[target], travelTime(graph, profiles, result.path, departure)));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(TimeDependent, MatchesReference) {
+    const TravelTimeProfiles profiles = defaultTravelTimeProfiles();
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        expectEarliestArrivals(map, withRoadClasses(map.graph), profiles);
+    }
+}
+
+TEST(TimeDependent, ArcProfilesMatchReference) {
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        Graph graph = withRoadClasses(map.graph);
+        TravelTimeProfiles profiles = defaultTravelTimeProfiles();
+        // Every fifth arc gets its class's profile scaled by one of three
+        // amounts; scaling by 1 matches the class and adds no profile
+        std::vector<ArcProfile> arcs;
+        for (int u = 0; u < graph.nodeCount(); ++u) {
+            for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) {
+                if (e % 5 != 0) continue;
+                const float scale = 1.0f + 0.25f * (e / 5 % 3);
+                ArcProfile arc{u, graph.target[e], {}};
+                for (int i = 0; i < profiles.breakpointCount(); ++i)
+                    arc.factors.push_back(scale * profiles.factors[graph.arcClass[e] * profiles.breakpointCount() + i]);
+                arcs.push_back(arc);
+            }
+        }
+        ASSERT_TRUE(setArcProfiles(profiles, graph, arcs));
+        EXPECT_EQ(profiles.profileCount(), kRoadClassCount + 2 * kRoadClassCount);
+        ASSERT_EQ(profiles.arcProfile.size(), graph.target.size());
+        expectEarliestArrivals(map, graph, profiles);
+    }
+}
+
+TEST(TimeDependent, FactorsInterpolateAndWrap) {
+    const TravelTimeProfiles profiles = defaultTravelTimeProfiles();
+    EXPECT_FLOAT_EQ(profiles.factor(RoadClass::Main, 7.5f * kHour), 1.6f);
+    EXPECT_FLOAT_EQ(profiles.factor(RoadClass::Main, 8 * kHour), 1.8f);
+    EXPECT_FLOAT_EQ(profiles.factor(RoadClass::Main, 32 * kHour), 1.8f);
+    EXPECT_FLOAT_EQ(profiles.factor(RoadClass::Main, -16 * kHour), 1.8f);
+    EXPECT_FLOAT_EQ(profiles.factor(RoadClass::Track, 8 * kHour), 1.0f);
+    EXPECT_FLOAT_EQ(profiles.minimumFactor(RoadClass::Motorway), 1.0f);
+
+    // Lower bounds never exceed a travel time
+    Graph graph = withRoadClasses(testMaps().front().graph);
+    Graph bounded = lowerBoundGraph(graph, profiles);
+    for (size_t e = 0; e < graph.weight.size(); ++e) {
+        const int profile = profiles.profileOf(graph, static_cast<int>(e));
+        for (float time = 0; time < 24 * kHour; time += 900) {
+            ASSERT_LE(bounded.weight[e], graph.weight[e] * profiles.factor(profile, time));
+        }
+    }
+}
+
+TEST(TimeDependent, ChecksFifo) {
+    TravelTimeProfiles steep;
+    steep.times = {0, 60};
+    steep.factors.assign(kRoadClassCount * 2, 1.0f);
+    steep.factors[static_cast<int>(RoadClass::Street) * 2] = 3.0f; // drops by 2 over 60 s
+    Graph graph = withRoadClasses(testMaps().front().graph);
+    EXPECT_FALSE(checkFifo(graph, steep));
+    steep.factors[static_cast<int>(RoadClass::Street) * 2] = 1.1f;
+    EXPECT_TRUE(checkFifo(graph, steep));
+}
+
+TEST(TimeDependent, ParsesTimesOfDay) {
+    float seconds = -1;
+    EXPECT_TRUE(parseTimeOfDay("8:30", seconds));
+    EXPECT_FLOAT_EQ(seconds, 8.5f * kHour);
+    EXPECT_TRUE(parseTimeOfDay("08:30:15", seconds));
+    EXPECT_FLOAT_EQ(seconds, 8.5f * kHour + 15);
+    EXPECT_TRUE(parseTimeOfDay("45", seconds));
+    EXPECT_FLOAT_EQ(seconds, 45);
+    EXPECT_TRUE(parseTimeOfDay("23:59:59", seconds));
+    EXPECT_FLOAT_EQ(seconds, 86399);
+    EXPECT_TRUE(parseTimeOfDay("0:00", seconds));
+    EXPECT_FLOAT_EQ(seconds, 0);
+    for (const char* bad : {"", ":", "8:", "8:30:", "1:2:3:4", "-1", "8h30", "7:75", "7:30:99", "99:00", "24:00",
+                            "7:5", "7:300", "7.5", "7:30.5", "7:30:15.5", "1e3", " 7:30", "86400", "123456"}) {
+        EXPECT_FALSE(parseTimeOfDay(bad, seconds)) << bad;
+    }
+}
+
+TEST(TimeDependent, LoadsProfiles) {
+    TempFile file("profiles.json");
+    writeFile(file.path(), R"({"times": [0, 3600], "period": 7200, "main": [1, 2]})");
+    TravelTimeProfiles profiles;
+    ASSERT_TRUE(loadTravelTimeProfiles(file.path(), profiles));
+    EXPECT_EQ(profiles.period, 7200);
+    EXPECT_FLOAT_EQ(profiles.factor(RoadClass::Main, 1800), 1.5f);
+    EXPECT_FLOAT_EQ(profiles.factor(RoadClass::Main, 5400), 1.5f);
+    EXPECT_FLOAT_EQ(profiles.factor(RoadClass::Street, 1800), 1.0f);
+
+    for (const char* bad : {R"({"times": [0, 3600], "main": [1]})",         // too few factors
+                            R"({"times": [3600, 0], "main": [1, 2]})",      // decreasing
+                            R"({"times": [0, 3600], "lane": [1, 2]})",      // unknown class
+                            R"({"times": [0, 3600], "main": [1, 0]})",      // not positive
+                            R"({"times": [0, 90000]})", "{"}) {
+        writeFile(file.path(), bad);
+        EXPECT_FALSE(loadTravelTimeProfiles(file.path(), profiles)) << bad;
+    }
+}
+
+TEST(TimeDependent, LoadsArcProfiles) {
+    TempFile file("profiles.json");
+    writeFile(file.path(), R"({"times": [0, 3600], "main": [1, 2],
+                               "arcs": [{"from": 0, "to": 1, "factors": [3, 1]},
+                                        {"from": 1, "to": 0, "factors": [1, 2]}]})");
+    TravelTimeProfiles profiles;
+    EXPECT_FALSE(loadTravelTimeProfiles(file.path(), profiles)); // nowhere to put the arcs
+    std::vector<ArcProfile> arcs;
+    ASSERT_TRUE(loadTravelTimeProfiles(file.path(), profiles, &arcs));
+    ASSERT_EQ(arcs.size(), 2u);
+    EXPECT_EQ(arcs[0].from, 0);
+    EXPECT_EQ(arcs[0].to, 1);
+    EXPECT_EQ(arcs[0].factors, (std::vector<float>{3, 1}));
+
+    // Two nodes joined both ways, a street
+    RandomMap pair;
+    pair.destinationNodes = {Node{{0, 0}, true}, Node{{10, 0}, true}};
+    pair.edges = {Edge{{0, 0}, {10, 0}}};
+    Graph graph = buildGraph(pair);
+    ASSERT_TRUE(setArcProfiles(profiles, graph, arcs));
+    // The second profile equals main's
+    EXPECT_EQ(profiles.profileCount(), kRoadClassCount + 1);
+    SearchContext context;
+    EXPECT_FLOAT_EQ(timeDependentShortestPath(graph, profiles, 0, 1, 1800, context).distance, 20);
+    EXPECT_FLOAT_EQ(timeDependentShortestPath(graph, profiles, 1, 0, 1800, context).distance, 15);
+
+    TravelTimeProfiles unchanged = profiles;
+    EXPECT_FALSE(setArcProfiles(profiles, graph, {ArcProfile{0, 0, {1, 1}}}));     // no such arc
+    EXPECT_FALSE(setArcProfiles(profiles, graph, {ArcProfile{0, 7, {1, 1}}}));     // no such node
+    EXPECT_FALSE(setArcProfiles(profiles, graph, {ArcProfile{0, 1, {1, 1, 1}}})); // wrong length
+    EXPECT_EQ(profiles.factors, unchanged.factors);
+    EXPECT_EQ(profiles.arcProfile, unchanged.arcProfile);
+
+    writeFile(file.path(), R"({"times": [0, 3600], "arcs": [{"from": 0, "to": 1, "factors": [1]}]})");
+    EXPECT_FALSE(loadTravelTimeProfiles(file.path(), profiles, &arcs));
+    writeFile(file.path(), R"({"times": [0, 3600], "arcs": [{"from": 0, "to": 1, "factors": [1, 0]}]})");
+    EXPECT_FALSE(loadTravelTimeProfiles(file.path(), profiles, &arcs));
+}
@@ -0,0 +1,182 @@
+#include "pathfinder/turns.hpp"
+#include "test_graphs.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// Costed and forbidden turns at random, some named twice with different costs
+std::vector<Turn> randomTurns(const Graph& graph, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> cost(1, 30);
+    std::vector<Turn> turns;
+    for (int u = 0; u < graph.nodeCount(); ++u) {
+        for (int in = graph.firstEdge[u]; in < graph.firstEdge[u + 1]; ++in) {
+            const int v = graph.target[in];
+            for (int out = graph.firstEdge[v]; out < graph.firstEdge[v + 1]; ++out) {
+                const float roll = unit(rng);
+                if (roll > 0.4f) continue;
+                Turn turn{graph.positions[u], graph.positions[v], graph.positions[graph.target[out]]};
+                if (roll > 0.1f) turn.cost = static_cast<float>(cost(rng));
+                turns.push_back(turn);
+                if (roll > 0.35f) {
+                    turn.cost = static_cast<float>(cost(rng));
+                    turns.push_back(turn);
+                }
+            }
+        }
+    }
+    return turns;
+}
+
+// Line graph of graph with explicit turn costs: arcs are states and turns
+// transitions. Taken straight from the turn list by position.
+struct LineGraph {
+    std::vector<int> tail;                      // arc -> its first node
+    std::vector<std::vector<float>> transition; // per arc, cost of turning onto each out arc of its head
+
+    float turnCost(const Graph& graph, int in, int out) const {
+        return transition[in][out - graph.firstEdge[graph.target[in]]];
+    }
+};
+
+LineGraph lineGraph(const Graph& graph, const std::vector<Turn>& turns, float uTurnCost) {
+    LineGraph line;
+    line.tail.resize(graph.target.size());
+    for (int u = 0; u < graph.nodeCount(); ++u) {
+        for (int e = graph.firstEdge[u]; e < graph.firstEdge[u + 1]; ++e) line.tail[e] = u;
+    }
+    line.transition.resize(graph.target.size());
+    for (size_t in = 0; in < graph.target.size(); ++in) {
+        const int u = line.tail[in], v = graph.target[in];
+        for (int out = graph.firstEdge[v]; out < graph.firstEdge[v + 1]; ++out) {
+            const int w = graph.target[out];
+            float listed = 0;
+            bool found = false;
+            for (const Turn& turn : turns) {
+                if (turn.from == graph.positions[u] && turn.via == graph.positions[v] &&
+                    turn.to == graph.positions[w]) {
+                    listed = found ? std::max(listed, turn.cost) : turn.cost;
+                    found = true;
+                }
+            }
+            line.transition[in].push_back((w == u ? uTurnCost : 0.0f) + listed);
+        }
+    }
+    return line;
+}
+
+// Cheapest cost from source to every node over the line graph, by relaxing
+// every turn until nothing improves
+std::vector<float> referenceTurnDistances(const Graph& graph, const LineGraph& line, int source) {
+    std::vector<float> arc(graph.target.size(), kInfinity);
+    for (int e = graph.firstEdge[source]; e < graph.firstEdge[source + 1]; ++e) arc[e] = graph.weight[e];
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t in = 0; in < graph.target.size(); ++in) {
+            if (arc[in] == kInfinity) continue;
+            const int v = graph.target[in];
+            for (int out = graph.firstEdge[v]; out < graph.firstEdge[v + 1]; ++out) {
+                float cost = arc[in] + line.turnCost(graph, static_cast<int>(in), out) + graph.weight[out];
+                if (cost < arc[out]) {
+                    arc[out] = cost;
+                    changed = true;
+                }
+            }
+        }
+    }
+    std::vector<float> node(graph.nodeCount(), kInfinity);
+    node[source] = 0;
+    for (size_t e = 0; e < graph.target.size(); ++e) {
+        if (graph.target[e] != source) node[graph.target[e]] = std::min(node[graph.target[e]], arc[e]);
+    }
+    return node;
+}
+
+// Cheapest cost of following path, turns included, over any of its parallel arcs
+float turnPathCost(const Graph& graph, const LineGraph& line, const std::vector<int>& path) {
+    if (path.size() == 1) return 0;
+    std::vector<std::pair<int, float>> reached; // (arc, cost so far)
+    for (int e = graph.firstEdge[path[0]]; e < graph.firstEdge[path[0] + 1]; ++e) {
+        if (graph.target[e] == path[1]) reached.emplace_back(e, graph.weight[e]);
+    }
+    for (size_t i = 1; i + 1 < path.size(); ++i) {
+        std::vector<std::pair<int, float>> next;
+        for (int out = graph.firstEdge[path[i]]; out < graph.firstEdge[path[i] + 1]; ++out) {
+            if (graph.target[out] != path[i + 1]) continue;
+            float best = kInfinity;
+            for (const auto& [in, cost] : reached) best = std::min(best, cost + line.turnCost(graph, in, out));
+            next.emplace_back(out, best + graph.weight[out]);
+        }
+        reached.swap(next);
+    }
+    float best = kInfinity;
+    for (const auto& entry : reached) best = std::min(best, entry.second);
+    return best;
+}
+
+} // namespace
+
+TEST(Turns, MatchesLineGraphReference) {
+    SearchContext context;
+    unsigned seed = 1;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        const std::vector<Turn> turns = randomTurns(map.graph, seed++);
+        for (float uTurnCost : {0.0f, 15.0f, kInfinity}) {
+            SCOPED_TRACE(uTurnCost);
+            const TurnCosts costs = buildTurnCosts(map.graph, turns, uTurnCost);
+            const LineGraph line = lineGraph(map.graph, turns, uTurnCost);
+            for (size_t i = 0; i < map.sources.size(); ++i) {
+                std::vector<float> reference = referenceTurnDistances(map.graph, line, map.sources[i]);
+                for (int target : map.targets[i]) {
+                    PathResult result = turnAwareShortestPath(map.graph, costs, map.sources[i], target, context);
+                    ASSERT_TRUE(sameDistance(reference[target], result.distance)) << "target " << target;
+                    if (reference[target] == kInfinity) continue;
+                    ASSERT_FALSE(result.path.empty());
+                    EXPECT_EQ(result.path.front(), map.sources[i]);
+                    EXPECT_EQ(result.path.back(), target);
+                    EXPECT_TRUE(sameDistance(reference[target], turnPathCost(map.graph, line, result.path)));
+                }
+            }
+        }
+    }
+}
+
+TEST(Turns, WithoutTurnsMatchesNodeSearch) {
+    SearchContext context;
+    for (const TestMap& map : testMaps()) {
+        SCOPED_TRACE(map.name);
+        const TurnCosts costs = buildTurnCosts(map.graph, {});
+        forEachPair(map, [&](int source, int target, float expected) {
+            EXPECT_TRUE(isShortestPath(map.graph, turnAwareShortestPath(map.graph, costs, source, target, context),
+                                       source, target, expected));
+        });
+    }
+}
+
+TEST(Turns, CostsAndRestrictionsOnAJunction) {
+    // a - b - c along the x axis, with d above b; all two-way, 10 apart
+    const Vec2 a{0, 0}, b{10, 0}, c{20, 0}, d{10, 10};
+    RandomMap junction;
+    junction.roadNodes = {Node{a, false}, Node{b, false}, Node{c, false}, Node{d, false}};
+    junction.edges = {Edge{a, b}, Edge{b, c}, Edge{b, d}};
+    Graph graph = buildGraph(junction);
+    SearchContext context;
+    auto distance = [&](const std::vector<Turn>& turns, float uTurnCost) {
+        return turnAwareShortestPath(graph, buildTurnCosts(graph, turns, uTurnCost), 0, 3, context).distance;
+    };
+    EXPECT_FLOAT_EQ(distance({}, 0), 20);
+    EXPECT_FLOAT_EQ(distance({Turn{a, b, d, 5}}, 0), 25);
+    // The higher of two costs for the same turn applies
+    EXPECT_FLOAT_EQ(distance({Turn{a, b, d, 5}, Turn{a, b, d, 8}, Turn{a, b, d, 2}}, 0), 28);
+    // Forbidden: on to c, turn back there and turn right at b
+    EXPECT_FLOAT_EQ(distance({Turn{a, b, d}}, 0), 40);
+    EXPECT_FLOAT_EQ(distance({Turn{a, b, d}}, 7), 47);
+    EXPECT_EQ(distance({Turn{a, b, d}}, kInfinity), kInfinity);
+    // Turns naming missing edges are ignored
+    EXPECT_FLOAT_EQ(distance({Turn{a, c, d}, Turn{Vec2{5, 5}, b, d}}, 0), 20);
+}